@@ -0,0 +1,322 @@
+#ifndef EASIO_BENCHMARKS_BENCH_COMMON_HPP
+#define EASIO_BENCHMARKS_BENCH_COMMON_HPP
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "awaitable.hpp"
+#include "io_context.hpp"
+#include "tcp.hpp"
+#include "udp.hpp"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include <psapi.h>
+#endif
+
+namespace bench {
+  using clock = std::chrono::steady_clock;
+
+  // The I/O backend the library was built with. Windows has only IOCP.
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+  inline const char* backend_name() { return "iocp"; }
+#else
+  inline const char* backend_name() { return "none"; }
+#endif
+
+  // Command line settings shared by every benchmark. Each one reads the
+  // fields that make sense for it.
+  struct options {
+    int threads = 1;
+    int connections = 1;
+    std::size_t size = 64;
+    std::size_t response_size = 0;
+    int pipeline = 1;
+    double duration = 5.0;
+    std::string host = "127.0.0.1";
+    unsigned short port = 5555;
+    // Connect to host:port instead of starting a server in process.
+    bool external = false;
+    bool json = false;
+
+    static void usage(const char* program) {
+      std::fprintf(stderr,
+                   "usage: %s [--threads N] [--connections N] [--size BYTES]\n"
+                   "          [--response-size BYTES] [--pipeline N] [--duration SECONDS]\n"
+                   "          [--host ADDR] [--port N] [--external] [--json]\n",
+                   program);
+    }
+
+    static options parse(int argc, char** argv) {
+      options o;
+      for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        auto value = [&]() -> const char* {
+          if (i + 1 >= argc) {
+            usage(argv[0]);
+            std::exit(2);
+          }
+          return argv[++i];
+        };
+        if (arg == "--threads")
+          o.threads = std::max(1, std::atoi(value()));
+        else if (arg == "--connections")
+          o.connections = std::max(1, std::atoi(value()));
+        else if (arg == "--size")
+          o.size = std::max<std::size_t>(1, std::strtoull(value(), nullptr, 10));
+        else if (arg == "--response-size")
+          o.response_size = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--pipeline")
+          o.pipeline = std::max(1, std::atoi(value()));
+        else if (arg == "--duration")
+          o.duration = std::atof(value());
+        else if (arg == "--host")
+          o.host = value();
+        else if (arg == "--port")
+          o.port = static_cast<unsigned short>(std::atoi(value()));
+        else if (arg == "--external")
+          o.external = true;
+        else if (arg == "--json")
+          o.json = true;
+        else {
+          usage(argv[0]);
+          std::exit(2);
+        }
+      }
+      if (o.response_size == 0)
+        o.response_size = o.size;
+      return o;
+    }
+
+    clock::duration run_time() const {
+      return std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(duration));
+    }
+  };
+
+  // An IPv4 endpoint for a dotted address; the library's endpoint has no
+  // address parsing of its own yet.
+  template <typename Protocol>
+  easio::base::endpoint<Protocol> make_endpoint(const Protocol& protocol, const std::string& host,
+                                                unsigned short port) {
+    easio::base::endpoint<Protocol> ep(protocol, port);
+    sockaddr_in* v4 = reinterpret_cast<sockaddr_in*>(ep.data());
+    if (::inet_pton(AF_INET, host.c_str(), &v4->sin_addr) != 1) {
+      std::fprintf(stderr, "not an IPv4 address: %s\n", host.c_str());
+      std::exit(2);
+    }
+    return ep;
+  }
+
+  // Round trip times, in nanoseconds. Each coroutine or connection fills a
+  // vector of its own and merges it once at the end, so recording never
+  // takes a lock.
+  class latency_recorder {
+  public:
+    void merge(std::vector<std::uint64_t>& samples) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      samples_.insert(samples_.end(), samples.begin(), samples.end());
+      samples.clear();
+    }
+
+    std::size_t count() const { return samples_.size(); }
+
+    // The q-quantile, for q in [0, 1]. Reorders the samples.
+    std::uint64_t quantile(double q) {
+      if (samples_.empty())
+        return 0;
+      std::size_t i = static_cast<std::size_t>(q * static_cast<double>(samples_.size() - 1) + 0.5);
+      std::nth_element(samples_.begin(), samples_.begin() + i, samples_.end());
+      return samples_[i];
+    }
+
+    std::uint64_t max() const {
+      return samples_.empty() ? 0 : *std::max_element(samples_.begin(), samples_.end());
+    }
+
+  private:
+    std::mutex mutex_;
+    std::vector<std::uint64_t> samples_;
+  };
+
+  inline std::uint64_t elapsed_ns(clock::time_point since) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - since).count());
+  }
+
+  // Bytes committed to the process, or 0 where there is no way to ask.
+  inline std::size_t private_bytes() {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    PROCESS_MEMORY_COUNTERS_EX pmc;
+    if (::GetProcessMemoryInfo(::GetCurrentProcess(),
+                               reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc)))
+      return pmc.PrivateUsage;
+#endif
+    return 0;
+  }
+
+  // Setup that throws, e.g. binding a port in use, ends the run with the
+  // error rather than with std::terminate.
+  template <typename F>
+  auto or_exit(const char* what, F&& f) -> decltype(f()) {
+    try {
+      return f();
+    } catch (const std::error_code& ec) {
+      std::fprintf(stderr, "%s: %s\n", what, ec.message().c_str());
+      std::exit(1);
+    }
+  }
+
+  // Runs ctx on n threads until stop() is called or it runs out of work.
+  class runner {
+  public:
+    runner(easio::io_context& ctx, int n) : ctx_(ctx) {
+      for (int i = 0; i < n; ++i)
+        threads_.emplace_back([this] {
+          std::error_code ec;
+          ctx_.run(ec);
+          if (ec)
+            std::fprintf(stderr, "run: %s\n", ec.message().c_str());
+        });
+    }
+
+    ~runner() { join(); }
+
+    void stop() { ctx_.stop(); }
+
+    void join() {
+      for (std::thread& t : threads_)
+        if (t.joinable())
+          t.join();
+    }
+
+  private:
+    easio::io_context& ctx_;
+    std::vector<std::thread> threads_;
+  };
+
+  // Counts finished coroutines so main can wait for all the clients.
+  class latch {
+  public:
+    explicit latch(int n) : n_(n) {}
+
+    void count_down() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--n_ == 0)
+        cv_.notify_all();
+    }
+
+    void wait() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return n_ == 0; });
+    }
+
+    // False if some are still running at the deadline.
+    bool wait_until(clock::time_point deadline) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      return cv_.wait_until(lock, deadline, [this] { return n_ == 0; });
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int n_;
+  };
+
+  // A co_spawn handler that reports anything other than a peer going away.
+  struct report_errors {
+    const char* what;
+
+    void operator()(std::exception_ptr e) const {
+      if (!e)
+        return;
+      try {
+        std::rethrow_exception(e);
+      } catch (const std::error_code& ec) {
+        if (ec != std::errc::operation_canceled && ec != std::errc::connection_reset &&
+            ec != std::errc::connection_aborted && ec != std::errc::broken_pipe)
+          std::fprintf(stderr, "%s: %s\n", what, ec.message().c_str());
+      } catch (const std::exception& ex) {
+        std::fprintf(stderr, "%s: %s\n", what, ex.what());
+      }
+    }
+  };
+
+  // Reads exactly buffer.size() bytes; a peer that closes early is an
+  // error.
+  inline easio::awaitable<void> read_exactly(easio::tcp::socket& s, easio::mutable_buffer buffer) {
+    char* p = static_cast<char*>(buffer.data());
+    std::size_t left = buffer.size();
+    while (left > 0) {
+      std::size_t n = co_await s.async_read_some(easio::mutable_buffer(p, left));
+      if (n == 0)
+        throw std::make_error_code(std::errc::connection_reset);
+      p += n;
+      left -= n;
+    }
+  }
+
+  // One line of results. With --json it is a single JSON object, so runs
+  // across backends and thread counts can be collected and compared.
+  struct result {
+    const char* benchmark;
+    const options* opts;
+    double seconds = 0;
+    std::uint64_t operations = 0;
+    std::uint64_t bytes = 0;
+    latency_recorder* latency = nullptr;
+    // Extra metric for benchmarks that are not about throughput.
+    const char* extra_name = nullptr;
+    double extra_value = 0;
+
+    void print() const {
+      double ops = seconds > 0 ? static_cast<double>(operations) / seconds : 0;
+      double mbps = seconds > 0 ? static_cast<double>(bytes) / seconds / (1024 * 1024) : 0;
+      double p50 = 0, p99 = 0, p999 = 0, max = 0;
+      if (latency && latency->count() > 0) {
+        p50 = static_cast<double>(latency->quantile(0.50)) / 1000;
+        p99 = static_cast<double>(latency->quantile(0.99)) / 1000;
+        p999 = static_cast<double>(latency->quantile(0.999)) / 1000;
+        max = static_cast<double>(latency->max()) / 1000;
+      }
+
+      if (opts->json) {
+        std::printf("{\"benchmark\":\"%s\",\"backend\":\"%s\",\"threads\":%d,\"connections\":%d,"
+                    "\"size\":%zu,\"pipeline\":%d,\"seconds\":%.3f,\"operations\":%llu,"
+                    "\"ops_per_second\":%.1f,\"mib_per_second\":%.2f,"
+                    "\"p50_us\":%.2f,\"p99_us\":%.2f,\"p999_us\":%.2f,\"max_us\":%.2f",
+                    benchmark, backend_name(), opts->threads, opts->connections, opts->size,
+                    opts->pipeline, seconds, static_cast<unsigned long long>(operations), ops, mbps,
+                    p50, p99, p999, max);
+        if (extra_name)
+          std::printf(",\"%s\":%.1f", extra_name, extra_value);
+        std::printf("}\n");
+        return;
+      }
+
+      std::printf("%s [%s, %d thread(s), %d connection(s), %zu bytes]\n", benchmark,
+                  backend_name(), opts->threads, opts->connections, opts->size);
+      if (operations > 0)
+        std::printf("  %.0f ops/s, %.2f MiB/s over %.2fs\n", ops, mbps, seconds);
+      if (latency && latency->count() > 0)
+        std::printf("  latency us: p50 %.2f  p99 %.2f  p999 %.2f  max %.2f\n", p50, p99, p999, max);
+      if (extra_name)
+        std::printf("  %s: %.1f\n", extra_name, extra_value);
+    }
+  };
+}  // namespace bench
+
+#endif
@@ -0,0 +1,80 @@
+// Memory held by idle connections. Opens --connections loopback TCP
+// connections, leaves a read pending on both ends of each, and reports the
+// growth in the process's committed memory per connection.
+
+#include "bench_common.hpp"
+
+namespace {
+  using easio::awaitable;
+  using easio::tcp;
+
+  // Waits for a byte that never comes, as an idle connection's reader does.
+  awaitable<void> idle(tcp::socket s) {
+    char byte;
+    while (co_await s.async_read_some(easio::buffer(&byte, 1)) > 0) {
+    }
+  }
+
+  awaitable<void> accept_n(tcp::acceptor& acceptor, easio::io_context& ctx, int n,
+                           bench::latch& accepted) {
+    for (int i = 0; i < n; ++i) {
+      tcp::socket peer(ctx);
+      co_await acceptor.async_accept(peer);
+      easio::co_spawn(ctx.get_executor(), idle(std::move(peer)), bench::report_errors{"server"});
+      accepted.count_down();
+    }
+  }
+
+  awaitable<void> connect_and_idle(easio::io_context& ctx, tcp::endpoint server,
+                                   bench::latch& connected) {
+    tcp::socket s(ctx);
+    std::exception_ptr failed;
+    try {
+      co_await s.async_connect(server);
+    } catch (...) {
+      failed = std::current_exception();
+    }
+    connected.count_down();
+    if (failed)
+      std::rethrow_exception(failed);
+    co_await idle(std::move(s));
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::options opts = bench::options::parse(argc, argv);
+  easio::io_context ctx(opts.threads);
+  std::unique_ptr<tcp::acceptor> acceptor = bench::or_exit("listen", [&] {
+    return std::make_unique<tcp::acceptor>(ctx, tcp::endpoint(tcp::v4(), opts.port));
+  });
+
+  std::size_t before = bench::private_bytes();
+  bench::clock::time_point start = bench::clock::now();
+  bench::latch accepted(opts.connections), connected(opts.connections);
+  easio::co_spawn(ctx.get_executor(), accept_n(*acceptor, ctx, opts.connections, accepted),
+                  bench::report_errors{"accept"});
+  tcp::endpoint server = bench::make_endpoint(tcp::v4(), opts.host, opts.port);
+  for (int i = 0; i < opts.connections; ++i)
+    easio::co_spawn(ctx.get_executor(), connect_and_idle(ctx, server, connected),
+                    bench::report_errors{"client"});
+
+  bench::runner threads(ctx, opts.threads);
+  connected.wait();
+  // Connects that failed have no server side to wait for.
+  if (!accepted.wait_until(bench::clock::now() + std::chrono::seconds(5)))
+    std::fprintf(stderr, "not every connection was accepted\n");
+  double seconds = std::chrono::duration<double>(bench::clock::now() - start).count();
+  std::size_t after = bench::private_bytes();
+
+  threads.stop();
+  threads.join();
+
+  bench::result r{"idle_connections", &opts};
+  r.seconds = seconds;
+  r.operations = static_cast<std::uint64_t>(opts.connections);
+  r.extra_name = "bytes_per_connection";
+  r.extra_value = after > before
+                      ? static_cast<double>(after - before) / opts.connections
+                      : 0;
+  r.print();
+}
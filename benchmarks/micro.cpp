@@ -0,0 +1,293 @@
+// Microbenchmarks for the library's core primitives, on Google Benchmark.
+// Run with --benchmark_format=json (or --benchmark_out=FILE) for results
+// that can be tracked over time. The context benchmarks need a backend and
+// are only built on Windows; the rest run anywhere.
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "base/call_stack.hpp"
+#include "base/execution_context.hpp"
+#include "base/thread_context.hpp"
+#include "execution.hpp"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include "awaitable.hpp"
+#include "io_context.hpp"
+#include "memory.hpp"
+#include "shm.hpp"
+#include "steady_timer.hpp"
+#endif
+
+namespace {
+  namespace ex = easio::base::execution;
+  using easio::base::thread_info;
+
+  // thread_info::allocate/deallocate with the block coming back from the
+  // thread's cache every time.
+  void thread_info_allocate_hit(benchmark::State& state) {
+    thread_info this_thread;
+    std::size_t size = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+      void* p = thread_info::allocate(&this_thread, size);
+      benchmark::DoNotOptimize(p);
+      thread_info::deallocate(&this_thread, p, size);
+    }
+  }
+  BENCHMARK(thread_info_allocate_hit)->Arg(64)->Arg(256)->Arg(1000);
+
+  // As above, with blocks never returned to the cache, so each allocation
+  // scans it, finds nothing and goes to the heap.
+  void thread_info_allocate_miss(benchmark::State& state) {
+    thread_info this_thread;
+    std::size_t size = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+      void* p = thread_info::allocate(&this_thread, size);
+      benchmark::DoNotOptimize(p);
+      thread_info::deallocate(nullptr, p, size);
+    }
+  }
+  BENCHMARK(thread_info_allocate_miss)->Arg(64)->Arg(256)->Arg(1000);
+
+  class empty_service : public easio::base::execution_context_service<empty_service> {
+  public:
+    explicit empty_service(easio::base::execution_context& ctx)
+      : easio::base::execution_context_service<empty_service>(ctx) {}
+
+  private:
+    void shutdown() override {}
+  };
+
+  // The lookup every I/O object does on construction, once the service
+  // exists.
+  void use_service_existing(benchmark::State& state) {
+    easio::base::execution_context ctx;
+    easio::base::use_service<empty_service>(ctx);
+    for (auto _ : state)
+      benchmark::DoNotOptimize(&easio::base::use_service<empty_service>(ctx));
+  }
+  BENCHMARK(use_service_existing);
+
+  // The first lookup in a context, which creates the service.
+  void use_service_first(benchmark::State& state) {
+    for (auto _ : state) {
+      easio::base::execution_context ctx;
+      benchmark::DoNotOptimize(&easio::base::use_service<empty_service>(ctx));
+    }
+  }
+  BENCHMARK(use_service_first);
+
+  struct stack_key {};
+  using key_stack = easio::base::call_stack<stack_key>;
+
+  // Pushes depth contexts, each with its own key, then runs f with the
+  // outermost key, which contains() has to walk the whole stack to find.
+  template <typename F>
+  void with_stack_depth(int depth, stack_key* keys, stack_key* outermost, F&& f) {
+    if (depth == 0) {
+      f(outermost);
+      return;
+    }
+    key_stack::context ctx(keys);
+    with_stack_depth(depth - 1, keys + 1, outermost, f);
+  }
+
+  void call_stack_contains(benchmark::State& state) {
+    int depth = static_cast<int>(state.range(0));
+    std::vector<stack_key> keys(static_cast<std::size_t>(depth));
+    with_stack_depth(depth, keys.data(), keys.data(), [&](stack_key* outermost) {
+      for (auto _ : state)
+        benchmark::DoNotOptimize(key_stack::contains(outermost));
+    });
+    state.SetComplexityN(depth);
+  }
+  BENCHMARK(call_stack_contains)->RangeMultiplier(2)->Range(1, 64)->Complexity(benchmark::oN);
+
+  void call_stack_top_if(benchmark::State& state) {
+    int depth = static_cast<int>(state.range(0));
+    std::vector<stack_key> keys(static_cast<std::size_t>(depth));
+    with_stack_depth(depth, keys.data(), keys.data(), [&](stack_key* outermost) {
+      for (auto _ : state)
+        benchmark::DoNotOptimize(key_stack::top_if(outermost));
+    });
+  }
+  BENCHMARK(call_stack_top_if)->RangeMultiplier(8)->Range(1, 64);
+
+  struct sink_receiver {
+    int* out;
+
+    friend void tag_invoke(ex::set_value_t, sink_receiver&& r, int v) noexcept { *r.out = v; }
+    friend void tag_invoke(ex::set_error_t, sink_receiver&&, std::exception_ptr) noexcept {}
+    friend void tag_invoke(ex::set_done_t, sink_receiver&&) noexcept {}
+  };
+
+  auto make_pipeline(int v) {
+    return ex::just(v)
+        | ex::then([](int x) { return x + 1; })
+        | ex::let_value([](int& x) { return ex::just(x * 2); })
+        | ex::then([](int x) { return x - 1; });
+  }
+
+  // Building a just | then | let_value | then pipeline, without running it.
+  void sender_pipeline_construct(benchmark::State& state) {
+    int v = 0;
+    for (auto _ : state) {
+      auto s = make_pipeline(v);
+      benchmark::DoNotOptimize(&s);
+    }
+  }
+  BENCHMARK(sender_pipeline_construct);
+
+  // Building, connecting and starting the same pipeline.
+  void sender_pipeline_run(benchmark::State& state) {
+    int out = 0;
+    for (auto _ : state) {
+      auto op = ex::connect(make_pipeline(out), sink_receiver{&out});
+      ex::start(op);
+      benchmark::DoNotOptimize(out);
+    }
+  }
+  BENCHMARK(sender_pipeline_run);
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+  const int handlers_per_iteration = 1000;
+
+  // A handler that posts the next one until count reaches zero, so every
+  // post is made from a thread running the context.
+  struct repost {
+    easio::io_context::executor_type ex;
+    int* count;
+
+    void operator()() const {
+      if (--*count > 0)
+        ex.post(repost{ex, count});
+    }
+  };
+
+  void post_same_thread(benchmark::State& state) {
+    easio::io_context ctx(1);
+    for (auto _ : state) {
+      int count = handlers_per_iteration;
+      ctx.get_executor().post(repost{ctx.get_executor(), &count});
+      ctx.run();
+      ctx.restart();
+    }
+    state.SetItemsProcessed(state.iterations() * handlers_per_iteration);
+  }
+  BENCHMARK(post_same_thread);
+
+  // Posts from the benchmark thread to a context run by another, waiting
+  // each iteration until that thread has run them all.
+  void post_cross_thread(benchmark::State& state) {
+    easio::io_context ctx(1);
+    // Keeps run() from returning between iterations.
+    easio::steady_timer keep_running(ctx, std::chrono::hours(24));
+    easio::co_spawn(ctx.get_executor(),
+                    [](easio::steady_timer& t) -> easio::awaitable<void> {
+                      co_await t.async_wait();
+                    }(keep_running),
+                    [](std::exception_ptr) {});
+    std::thread runner([&] { ctx.run(); });
+
+    std::atomic<int> done{0};
+    auto ex = ctx.get_executor();
+    for (auto _ : state) {
+      done.store(0, std::memory_order_relaxed);
+      for (int i = 0; i < handlers_per_iteration; ++i)
+        ex.post([&done] { done.fetch_add(1, std::memory_order_release); });
+      while (done.load(std::memory_order_acquire) != handlers_per_iteration)
+        std::this_thread::yield();
+    }
+    state.SetItemsProcessed(state.iterations() * handlers_per_iteration);
+
+    ex.post([&keep_running] { keep_running.cancel(); });
+    runner.join();
+  }
+  BENCHMARK(post_cross_thread)->UseRealTime();
+
+  // From inside a handler, dispatch() runs each function inline while
+  // post() queues it to run after the handler returns.
+  void dispatch_inline(benchmark::State& state) {
+    easio::io_context ctx(1);
+    for (auto _ : state) {
+      int count = 0;
+      auto ex = ctx.get_executor();
+      ex.post([&] {
+        for (int i = 0; i < handlers_per_iteration; ++i)
+          ex.dispatch([&count] { ++count; });
+      });
+      ctx.run();
+      ctx.restart();
+      benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * handlers_per_iteration);
+  }
+  BENCHMARK(dispatch_inline);
+
+  void dispatch_posted(benchmark::State& state) {
+    easio::io_context ctx(1);
+    for (auto _ : state) {
+      int count = 0;
+      auto ex = ctx.get_executor();
+      ex.post([&] {
+        for (int i = 0; i < handlers_per_iteration; ++i)
+          ex.post([&count] { ++count; });
+      });
+      ctx.run();
+      ctx.restart();
+      benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * handlers_per_iteration);
+  }
+  BENCHMARK(dispatch_posted);
+
+  // A 64 byte round trip over a memory socket pair on one thread: the
+  // library's whole op and queue path with no kernel underneath.
+  void memory_socket_round_trip(benchmark::State& state) {
+    easio::io_context ctx(1);
+    easio::memory::socket a(ctx), b(ctx);
+    easio::memory::connect_pair(a, b);
+    char ping[64] = {}, pong[64];
+    for (auto _ : state) {
+      a.async_write(easio::const_buffer(ping, sizeof(ping)), [](std::error_code, std::size_t) {});
+      b.async_read_some(easio::buffer(pong, sizeof(pong)), [&](std::error_code, std::size_t n) {
+        b.async_write(easio::const_buffer(pong, n), [](std::error_code, std::size_t) {});
+        a.async_read_some(easio::buffer(ping, sizeof(ping)), [](std::error_code, std::size_t) {});
+      });
+      ctx.run();
+      ctx.restart();
+    }
+    state.SetBytesProcessed(state.iterations() * 2 * static_cast<std::int64_t>(sizeof(ping)));
+  }
+  BENCHMARK(memory_socket_round_trip);
+
+  // The same round trip over a shared memory channel, with both ends in
+  // this process and on one context, so neither side ever sleeps.
+  void shm_channel_round_trip(benchmark::State& state) {
+    easio::io_context ctx(1);
+    easio::shm_channel a(ctx), b(ctx);
+    std::string name = "easio-micro-" + std::to_string(::GetCurrentProcessId());
+    a.create(name);
+    b.open(name);
+    char ping[64] = {}, pong[64];
+    for (auto _ : state) {
+      a.async_write(easio::const_buffer(ping, sizeof(ping)), [](std::error_code, std::size_t) {});
+      b.async_read_some(easio::buffer(pong, sizeof(pong)), [&](std::error_code, std::size_t n) {
+        b.async_write(easio::const_buffer(pong, n), [](std::error_code, std::size_t) {});
+        a.async_read_some(easio::buffer(ping, sizeof(ping)), [](std::error_code, std::size_t) {});
+      });
+      ctx.run();
+      ctx.restart();
+    }
+    state.SetBytesProcessed(state.iterations() * 2 * static_cast<std::int64_t>(sizeof(ping)));
+  }
+  BENCHMARK(shm_channel_round_trip);
+#endif
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+// Request/response load generator. Each of --connections connections
+// sends --pipeline requests of --size bytes at a time and waits for as
+// many --response-size byte responses, timing each request from when its
+// batch was written to when its response arrived. Without --external the
+// server runs in process; with it, any server that answers each request
+// with a fixed size response can be measured.
+
+#include "bench_common.hpp"
+
+namespace {
+  using easio::awaitable;
+  using easio::tcp;
+
+  awaitable<void> serve(tcp::socket s, std::size_t request_size, std::size_t response_size) {
+    std::vector<char> request(request_size), response(response_size, 'r');
+    for (;;) {
+      try {
+        co_await bench::read_exactly(s, easio::buffer(request));
+      } catch (const std::error_code&) {
+        // The client has gone.
+        co_return;
+      }
+      co_await s.async_write(easio::buffer(response));
+    }
+  }
+
+  awaitable<void> accept_loop(tcp::acceptor& acceptor, easio::io_context& ctx,
+                              const bench::options& opts) {
+    for (;;) {
+      tcp::socket peer(ctx);
+      co_await acceptor.async_accept(peer);
+      easio::co_spawn(ctx.get_executor(), serve(std::move(peer), opts.size, opts.response_size),
+                      bench::report_errors{"server"});
+    }
+  }
+
+  struct load_state {
+    const bench::options& opts;
+    tcp::endpoint server;
+    bench::clock::time_point deadline;
+    bench::latency_recorder& latency;
+    std::atomic<std::uint64_t> requests{0};
+  };
+
+  awaitable<void> load(easio::io_context& ctx, load_state& state) {
+    const bench::options& opts = state.opts;
+    tcp::socket s(ctx);
+    co_await s.async_connect(state.server);
+
+    std::vector<char> requests(opts.size * static_cast<std::size_t>(opts.pipeline), 'q');
+    std::vector<char> response(opts.response_size);
+    std::vector<std::uint64_t> samples;
+    while (bench::clock::now() < state.deadline) {
+      bench::clock::time_point sent = bench::clock::now();
+      co_await s.async_write(easio::buffer(requests));
+      for (int i = 0; i < opts.pipeline; ++i) {
+        co_await bench::read_exactly(s, easio::buffer(response));
+        samples.push_back(bench::elapsed_ns(sent));
+      }
+    }
+
+    state.requests.fetch_add(samples.size(), std::memory_order_relaxed);
+    state.latency.merge(samples);
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::options opts = bench::options::parse(argc, argv);
+  easio::io_context ctx(opts.threads);
+
+  std::unique_ptr<tcp::acceptor> acceptor;
+  if (!opts.external) {
+    acceptor = bench::or_exit("listen", [&] {
+      return std::make_unique<tcp::acceptor>(ctx, tcp::endpoint(tcp::v4(), opts.port));
+    });
+    easio::co_spawn(ctx.get_executor(), accept_loop(*acceptor, ctx, opts),
+                    bench::report_errors{"accept"});
+  }
+
+  bench::latency_recorder latency;
+  load_state state{opts, bench::make_endpoint(tcp::v4(), opts.host, opts.port),
+                   bench::clock::now() + opts.run_time(), latency};
+  bench::latch clients(opts.connections);
+  bench::clock::time_point start = bench::clock::now();
+  for (int i = 0; i < opts.connections; ++i)
+    easio::co_spawn(ctx.get_executor(), load(ctx, state),
+                    [&](std::exception_ptr e) {
+                      bench::report_errors{"client"}(e);
+                      clients.count_down();
+                    });
+
+  bench::runner threads(ctx, opts.threads);
+  clients.wait();
+  double seconds = std::chrono::duration<double>(bench::clock::now() - start).count();
+  threads.stop();
+  threads.join();
+
+  std::uint64_t requests = state.requests.load();
+  bench::result r{"rps", &opts};
+  r.seconds = seconds;
+  r.operations = requests;
+  r.bytes = requests * (opts.size + opts.response_size);
+  r.latency = &latency;
+  r.print();
+}
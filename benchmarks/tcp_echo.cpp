@@ -0,0 +1,99 @@
+// TCP echo over loopback. Each client connection writes --pipeline
+// messages of --size bytes, reads them all back and times the round trip,
+// until --duration has passed. Reports messages per second, bandwidth and
+// round trip percentiles.
+
+#include "bench_common.hpp"
+
+namespace {
+  using easio::awaitable;
+  using easio::tcp;
+
+  awaitable<void> echo_session(tcp::socket s, std::size_t size) {
+    std::vector<char> buf(size);
+    for (;;) {
+      std::size_t n = co_await s.async_read_some(easio::buffer(buf));
+      if (n == 0)
+        co_return;
+      co_await s.async_write(easio::const_buffer(buf.data(), n));
+    }
+  }
+
+  awaitable<void> accept_loop(tcp::acceptor& acceptor, easio::io_context& ctx, std::size_t size) {
+    for (;;) {
+      tcp::socket peer(ctx);
+      co_await acceptor.async_accept(peer);
+      easio::co_spawn(ctx.get_executor(), echo_session(std::move(peer), size),
+                      bench::report_errors{"echo session"});
+    }
+  }
+
+  struct client_state {
+    const bench::options& opts;
+    tcp::endpoint server;
+    bench::clock::time_point deadline;
+    bench::latency_recorder& latency;
+    std::atomic<std::uint64_t> messages{0};
+  };
+
+  awaitable<void> client(easio::io_context& ctx, client_state& state) {
+    tcp::socket s(ctx);
+    co_await s.async_connect(state.server);
+
+    std::size_t batch = state.opts.size * static_cast<std::size_t>(state.opts.pipeline);
+    std::vector<char> out(batch, 'x'), in(batch);
+    std::vector<std::uint64_t> samples;
+    std::uint64_t messages = 0;
+    while (bench::clock::now() < state.deadline) {
+      bench::clock::time_point start = bench::clock::now();
+      co_await s.async_write(easio::buffer(out));
+      co_await bench::read_exactly(s, easio::buffer(in));
+      samples.push_back(bench::elapsed_ns(start));
+      messages += static_cast<std::uint64_t>(state.opts.pipeline);
+    }
+
+    state.latency.merge(samples);
+    state.messages.fetch_add(messages, std::memory_order_relaxed);
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::options opts = bench::options::parse(argc, argv);
+  easio::io_context ctx(opts.threads);
+
+  std::unique_ptr<tcp::acceptor> acceptor;
+  if (!opts.external) {
+    acceptor = bench::or_exit("listen", [&] {
+      return std::make_unique<tcp::acceptor>(ctx, tcp::endpoint(tcp::v4(), opts.port));
+    });
+    easio::co_spawn(ctx.get_executor(), accept_loop(*acceptor, ctx, opts.size * opts.pipeline),
+                    bench::report_errors{"accept"});
+  }
+
+  bench::latency_recorder latency;
+  client_state state{opts, bench::make_endpoint(tcp::v4(), opts.host, opts.port),
+                     bench::clock::now() + opts.run_time(), latency};
+  bench::latch clients(opts.connections);
+  bench::clock::time_point start = bench::clock::now();
+  for (int i = 0; i < opts.connections; ++i)
+    easio::co_spawn(ctx.get_executor(), client(ctx, state),
+                    [&](std::exception_ptr e) {
+                      bench::report_errors{"client"}(e);
+                      clients.count_down();
+                    });
+
+  bench::runner threads(ctx, opts.threads);
+  clients.wait();
+  double seconds = std::chrono::duration<double>(bench::clock::now() - start).count();
+  // The server's sessions never end on their own.
+  threads.stop();
+  threads.join();
+
+  std::uint64_t messages = state.messages.load();
+  bench::result r{"tcp_echo", &opts};
+  r.seconds = seconds;
+  r.operations = messages;
+  r.bytes = messages * opts.size * 2;
+  r.latency = &latency;
+  r.print();
+}
@@ -0,0 +1,122 @@
+// UDP ping-pong over loopback. Each of --connections pairs of sockets
+// bounces one --size byte datagram back and forth until --duration has
+// passed. Reports round trips per second and round trip percentiles. A
+// datagram lost on the way ends its pair early.
+
+#include "bench_common.hpp"
+
+namespace {
+  using easio::udp;
+
+  class pingpong_pair {
+  public:
+    pingpong_pair(easio::io_context& ctx, const bench::options& opts, unsigned short server_port,
+                  bench::clock::time_point deadline, bench::latch& done)
+      : server_(ctx, udp::endpoint(udp::v4(), server_port)),
+        client_(ctx, udp::endpoint(udp::v4(), 0)),
+        server_address_(bench::make_endpoint(udp::v4(), opts.host, server_port)),
+        server_buf_(opts.size), client_buf_(opts.size, 'x'),
+        deadline_(deadline), done_(done) {}
+
+    void start() {
+      server_receive();
+      ping();
+    }
+
+    // Hands over the round trip times and returns how many there were.
+    std::uint64_t merge(bench::latency_recorder& latency) {
+      std::uint64_t n = samples_.size();
+      latency.merge(samples_);
+      return n;
+    }
+
+  private:
+    void server_receive() {
+      server_.async_receive_from(easio::buffer(server_buf_), server_peer_,
+                                 [this](const std::error_code& ec, std::size_t n) {
+                                   if (ec)
+                                     return;
+                                   server_.async_send_to(easio::const_buffer(server_buf_.data(), n),
+                                                         server_peer_,
+                                                         [this](const std::error_code& ec, std::size_t) {
+                                                           if (!ec)
+                                                             server_receive();
+                                                         });
+                                 });
+    }
+
+    void ping() {
+      if (bench::clock::now() >= deadline_) {
+        done_.count_down();
+        return;
+      }
+      start_ = bench::clock::now();
+      client_.async_send_to(easio::buffer(client_buf_), server_address_,
+                            [this](const std::error_code& ec, std::size_t) {
+                              if (ec)
+                                return fail("send", ec);
+                              client_.async_receive_from(easio::buffer(client_buf_), client_peer_,
+                                                         [this](const std::error_code& ec, std::size_t) {
+                                                           if (ec)
+                                                             return fail("receive", ec);
+                                                           samples_.push_back(bench::elapsed_ns(start_));
+                                                           ping();
+                                                         });
+                            });
+    }
+
+    void fail(const char* what, const std::error_code& ec) {
+      std::fprintf(stderr, "client %s: %s\n", what, ec.message().c_str());
+      done_.count_down();
+    }
+
+    udp::socket server_;
+    udp::socket client_;
+    udp::endpoint server_address_;
+    udp::endpoint server_peer_;
+    udp::endpoint client_peer_;
+    std::vector<char> server_buf_;
+    std::vector<char> client_buf_;
+    bench::clock::time_point deadline_;
+    bench::clock::time_point start_;
+    bench::latch& done_;
+    std::vector<std::uint64_t> samples_;
+  };
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::options opts = bench::options::parse(argc, argv);
+  easio::io_context ctx(opts.threads);
+
+  bench::latch done(opts.connections);
+  bench::clock::time_point start = bench::clock::now();
+  bench::clock::time_point deadline = start + opts.run_time();
+  std::vector<std::unique_ptr<pingpong_pair>> pairs;
+  for (int i = 0; i < opts.connections; ++i)
+    pairs.push_back(bench::or_exit("bind", [&] {
+      return std::make_unique<pingpong_pair>(
+          ctx, opts, static_cast<unsigned short>(opts.port + i), deadline, done);
+    }));
+  for (auto& p : pairs)
+    p->start();
+
+  bench::runner threads(ctx, opts.threads);
+  // Give a pair whose datagram was lost a second before giving up on it.
+  if (!done.wait_until(deadline + std::chrono::seconds(1)))
+    std::fprintf(stderr, "some pairs lost a datagram and stopped early\n");
+  double seconds = std::chrono::duration<double>(bench::clock::now() - start).count();
+  threads.stop();
+  threads.join();
+
+  bench::latency_recorder latency;
+  std::uint64_t round_trips = 0;
+  for (auto& p : pairs)
+    round_trips += p->merge(latency);
+
+  bench::result r{"udp_pingpong", &opts};
+  r.seconds = std::min(seconds, opts.duration);
+  r.operations = round_trips;
+  r.bytes = round_trips * opts.size * 2;
+  r.latency = &latency;
+  r.print();
+}
@@ -0,0 +1,420 @@
+#ifndef EASIO_AWAITABLE_HPP
+#define EASIO_AWAITABLE_HPP
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "base/execution/execution.hpp"
+#include "base/thread_context.hpp"
+
+namespace easio {
+
+  template <typename T = void>
+  class awaitable;
+
+  namespace base {
+
+    template <typename... Ts>
+    struct awaitable_value {
+      using type = std::tuple<Ts...>;
+    };
+
+    template <typename T>
+    struct awaitable_value<T> {
+      using type = T;
+    };
+
+    template <>
+    struct awaitable_value<> {
+      using type = void;
+    };
+
+    template <typename... Ts>
+    using awaitable_value_t = typename awaitable_value<std::decay_t<Ts>...>::type;
+
+    // co_await needs a sender with exactly one set of values.
+    template <typename... Ts>
+    struct awaitable_single;
+
+    template <typename T>
+    struct awaitable_single<T> {
+      using type = T;
+    };
+
+    // Never completes with values, e.g. just_error.
+    template <>
+    struct awaitable_single<> {
+      using type = void;
+    };
+
+    template <typename... Ts>
+    using awaitable_single_t = typename awaitable_single<Ts...>::type;
+
+    template <typename S>
+    using sender_await_result_t =
+        execution::value_types_of_t<S, awaitable_value_t, awaitable_single_t>;
+
+    // Awaiter for a sender. The sender's operation state lives inside the
+    // awaiter, which lives in the coroutine frame, so awaiting an I/O sender
+    // allocates nothing. The completion resumes the coroutine inline on the
+    // thread that delivered it. ready_ settles the race with a completion
+    // that arrives before await_suspend has returned.
+    template <typename S>
+    class sender_awaiter {
+    public:
+      using value_type = sender_await_result_t<S>;
+
+      struct receiver {
+        sender_awaiter* a_;
+
+        template <typename... As>
+        friend void tag_invoke(execution::set_value_t, receiver&& self, As&&... as) noexcept {
+          try {
+            self.a_->result_.template emplace<1>(std::forward<As>(as)...);
+          } catch (...) {
+            self.a_->result_.template emplace<2>(std::current_exception());
+          }
+          self.a_->resume();
+        }
+
+        template <typename E>
+        friend void tag_invoke(execution::set_error_t, receiver&& self, E&& e) noexcept {
+          if constexpr (std::is_same_v<std::decay_t<E>, std::exception_ptr>)
+            self.a_->result_.template emplace<2>(std::forward<E>(e));
+          else
+            self.a_->result_.template emplace<2>(std::make_exception_ptr(std::forward<E>(e)));
+          self.a_->resume();
+        }
+
+        friend void tag_invoke(execution::set_done_t, receiver&& self) noexcept {
+          self.a_->result_.template emplace<2>(std::make_exception_ptr(
+              std::make_error_code(std::errc::operation_canceled)));
+          self.a_->resume();
+        }
+      };
+
+      explicit sender_awaiter(S&& s)
+        : ready_(false), op_(execution::connect(std::move(s), receiver{this})) {}
+
+      sender_awaiter(sender_awaiter&&) = delete;
+
+      bool await_ready() const noexcept {
+        return false;
+      }
+
+      bool await_suspend(std::coroutine_handle<> h) noexcept {
+        continuation_ = h;
+        execution::start(op_);
+        // False means the op already completed; resume without suspending.
+        return !ready_.exchange(true, std::memory_order_acq_rel);
+      }
+
+      value_type await_resume() {
+        if (result_.index() == 2)
+          std::rethrow_exception(std::get<2>(result_));
+        if constexpr (!std::is_void_v<value_type>)
+          return std::move(std::get<1>(result_));
+      }
+
+      // Public so the receiver's hidden friends can reach them.
+      using stored_type = std::conditional_t<std::is_void_v<value_type>, std::monostate, value_type>;
+
+      void resume() noexcept {
+        if (ready_.exchange(true, std::memory_order_acq_rel))
+          continuation_.resume();
+      }
+
+      std::variant<std::monostate, stored_type, std::exception_ptr> result_;
+
+    private:
+      std::atomic<bool> ready_;
+      std::coroutine_handle<> continuation_;
+      execution::connect_result_t<S, receiver> op_;
+    };
+
+    class awaitable_frame_base {
+    public:
+      // Frames come from the recycling cache of the thread running the
+      // context, so a loop that keeps spawning coroutines of similar size
+      // reuses the same memory.
+      static void* operator new(std::size_t size) {
+        return thread_info::allocate(thread_info::awaitable_frame_tag(),
+                                     thread_context::top_of_thread_call_stack(), size);
+      }
+
+      static void operator delete(void* pointer, std::size_t size) {
+        thread_info::deallocate(thread_info::awaitable_frame_tag(),
+                                thread_context::top_of_thread_call_stack(), pointer, size);
+      }
+
+      std::suspend_always initial_suspend() noexcept {
+        return {};
+      }
+
+      // Transfers straight to the awaiting coroutine, or reports to the
+      // operation state when the awaitable was started as a sender.
+      auto final_suspend() noexcept {
+        struct final_awaiter {
+          bool await_ready() const noexcept { return false; }
+
+          std::coroutine_handle<> await_suspend(std::coroutine_handle<>) noexcept {
+            awaitable_frame_base* frame = frame_;
+            if (frame->continuation_)
+              return frame->continuation_;
+            // The callback may destroy this frame, so touch nothing after it.
+            frame->on_complete_(frame->on_complete_arg_);
+            return std::noop_coroutine();
+          }
+
+          void await_resume() const noexcept {}
+
+          awaitable_frame_base* frame_;
+        };
+        return final_awaiter{this};
+      }
+
+      void unhandled_exception() {
+        exception_ = std::current_exception();
+      }
+
+      template <typename U>
+      awaitable<U>&& await_transform(awaitable<U>&& a) noexcept {
+        return std::move(a);
+      }
+
+      template <execution::typed_sender S>
+      sender_awaiter<std::remove_cvref_t<S>> await_transform(S&& s) {
+        return sender_awaiter<std::remove_cvref_t<S>>(std::remove_cvref_t<S>(std::forward<S>(s)));
+      }
+
+    protected:
+      template <typename>
+      friend class easio::awaitable;
+
+      std::coroutine_handle<> continuation_;
+      void (*on_complete_)(void*) = nullptr;
+      void* on_complete_arg_ = nullptr;
+      std::exception_ptr exception_;
+    };
+
+    template <typename T>
+    class awaitable_frame : public awaitable_frame_base {
+    public:
+      awaitable<T> get_return_object() noexcept;
+
+      template <typename U>
+      void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+      }
+
+      T get() {
+        if (exception_)
+          std::rethrow_exception(exception_);
+        return std::move(*value_);
+      }
+
+    private:
+      std::optional<T> value_;
+    };
+
+    template <>
+    class awaitable_frame<void> : public awaitable_frame_base {
+    public:
+      awaitable<void> get_return_object() noexcept;
+
+      void return_void() {}
+
+      void get() {
+        if (exception_)
+          std::rethrow_exception(exception_);
+      }
+    };
+  }  // namespace base
+
+  // Lazily started coroutine task. co_await on another awaitable transfers
+  // control symmetrically, and co_await on a typed sender (socket I/O,
+  // timers, schedule()) resumes from its completion without an extra post.
+  // Errors are rethrown from co_await; set_done becomes operation_canceled.
+  //
+  // awaitable is itself a typed sender, so it can be connected or passed to
+  // co_spawn to run on a context.
+  template <typename T>
+  class awaitable {
+  public:
+    using promise_type = base::awaitable_frame<T>;
+    using value_type = T;
+
+    template <template <typename...> typename Tuple, template <typename...> typename Variant>
+    using value_types = Variant<typename base::execution::_adaptors::_result_tuple<Tuple, T>::type>;
+
+    template <template <typename...> typename Variant>
+    using error_types = Variant<std::exception_ptr>;
+
+    static constexpr bool sends_done = false;
+
+    awaitable(awaitable&& other) noexcept
+      : frame_(std::exchange(other.frame_, nullptr)) {}
+
+    ~awaitable() {
+      if (frame_)
+        frame_.destroy();
+    }
+
+    bool await_ready() const noexcept {
+      return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> h) noexcept {
+      frame_.promise().continuation_ = h;
+      return frame_;
+    }
+
+    T await_resume() {
+      return frame_.promise().get();
+    }
+
+    template <typename R>
+    class operation_state {
+    public:
+      operation_state(std::coroutine_handle<promise_type> frame, R&& r)
+        : frame_(frame), r_(std::move(r)) {
+        frame_.promise().on_complete_ = &operation_state::on_complete;
+        frame_.promise().on_complete_arg_ = this;
+      }
+
+      operation_state(operation_state&&) = delete;
+
+      ~operation_state() {
+        frame_.destroy();
+      }
+
+      friend void tag_invoke(base::execution::start_t, operation_state& op) noexcept {
+        op.frame_.resume();
+      }
+
+    private:
+      static void on_complete(void* arg) {
+        operation_state* op = static_cast<operation_state*>(arg);
+        try {
+          if constexpr (std::is_void_v<T>) {
+            op->frame_.promise().get();
+            base::execution::set_value(std::move(op->r_));
+          } else {
+            base::execution::set_value(std::move(op->r_), op->frame_.promise().get());
+          }
+        } catch (...) {
+          base::execution::set_error(std::move(op->r_), std::current_exception());
+        }
+      }
+
+      std::coroutine_handle<promise_type> frame_;
+      R r_;
+    };
+
+    template <base::execution::receiver R>
+    friend operation_state<std::remove_cvref_t<R>> tag_invoke(
+        base::execution::connect_t, awaitable&& a, R&& r) {
+      return operation_state<std::remove_cvref_t<R>>(
+          std::exchange(a.frame_, nullptr), std::remove_cvref_t<R>(std::forward<R>(r)));
+    }
+
+  private:
+    friend class base::awaitable_frame<T>;
+
+    explicit awaitable(std::coroutine_handle<promise_type> frame) noexcept
+      : frame_(frame) {}
+
+    std::coroutine_handle<promise_type> frame_;
+  };
+
+  namespace base {
+    template <typename T>
+    awaitable<T> awaitable_frame<T>::get_return_object() noexcept {
+      return awaitable<T>(std::coroutine_handle<awaitable_frame>::from_promise(*this));
+    }
+
+    inline awaitable<void> awaitable_frame<void>::get_return_object() noexcept {
+      return awaitable<void>(std::coroutine_handle<awaitable_frame>::from_promise(*this));
+    }
+
+    template <typename Scheduler, typename T, typename Handler>
+    struct co_spawn_state;
+
+    // Owns the spawned coroutine's operation state and frees it, together
+    // with the frame, before calling the handler.
+    template <typename Scheduler, typename T, typename Handler>
+    struct co_spawn_receiver {
+      co_spawn_state<Scheduler, T, Handler>* state_;
+
+      template <typename... As>
+      friend void tag_invoke(execution::set_value_t, co_spawn_receiver&& self, As&&... as) noexcept {
+        Handler handler(self.take_handler());
+        handler(std::exception_ptr(), std::forward<As>(as)...);
+      }
+
+      friend void tag_invoke(execution::set_error_t, co_spawn_receiver&& self, std::exception_ptr e) noexcept {
+        Handler handler(self.take_handler());
+        if constexpr (std::is_void_v<T>)
+          handler(std::move(e));
+        else
+          handler(std::move(e), T());
+      }
+
+      friend void tag_invoke(execution::set_done_t, co_spawn_receiver&& self) noexcept {
+        Handler handler(self.take_handler());
+        std::exception_ptr e = std::make_exception_ptr(
+            std::make_error_code(std::errc::operation_canceled));
+        if constexpr (std::is_void_v<T>)
+          handler(std::move(e));
+        else
+          handler(std::move(e), T());
+      }
+
+      Handler take_handler() {
+        std::unique_ptr<co_spawn_state<Scheduler, T, Handler>> state(state_);
+        return std::move(state->handler_);
+      }
+    };
+
+    template <typename Scheduler, typename T>
+    auto co_spawn_sender(Scheduler sch, awaitable<T>&& a) {
+      return execution::let_value(execution::schedule(sch),
+          [a = std::move(a)]() mutable { return std::move(a); });
+    }
+
+    template <typename Scheduler, typename T, typename Handler>
+    struct co_spawn_state {
+      co_spawn_state(Scheduler sch, awaitable<T>&& a, Handler handler)
+        : handler_(std::move(handler)),
+          op_(execution::connect(co_spawn_sender(sch, std::move(a)),
+                                 co_spawn_receiver<Scheduler, T, Handler>{this})) {}
+
+      Handler handler_;
+      execution::connect_result_t<
+          decltype(co_spawn_sender(std::declval<Scheduler>(), std::declval<awaitable<T>>())),
+          co_spawn_receiver<Scheduler, T, Handler>> op_;
+    };
+  }  // namespace base
+
+  // Starts the coroutine on a thread running sch's context. The handler is
+  // called with (std::exception_ptr) or (std::exception_ptr, T) when it
+  // finishes; the coroutine frame is already gone by then.
+  template <base::execution::scheduler Scheduler, typename T, typename Handler>
+  void co_spawn(Scheduler sch, awaitable<T> a, Handler&& handler) {
+    using state_type = base::co_spawn_state<Scheduler, T, std::decay_t<Handler>>;
+    state_type* state = new state_type(std::move(sch), std::move(a), std::forward<Handler>(handler));
+    base::execution::start(state->op_);
+  }
+}  // namespace easio
+
+#endif
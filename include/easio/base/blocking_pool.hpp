@@ -0,0 +1,110 @@
+#ifndef EASIO_BASE_BLOCKING_POOL_HPP
+#define EASIO_BASE_BLOCKING_POOL_HPP
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/noncopyable.hpp"
+#include "base/thread_pool_impl.hpp"
+
+namespace easio {
+  namespace base {
+
+    // A few threads for blocking calls that have no overlapped form. They
+    // start on demand, up to max_threads, and more tasks queue. Unlike
+    // thread_pool_impl it is not a service, so an I/O service can own one
+    // and stop it from its own shutdown(). Tasks are pool_tasks, run once
+    // with abandoned set if the pool stopped before they got a thread.
+    class blocking_pool : private noncopyable {
+    public:
+      explicit blocking_pool(std::size_t max_threads)
+        : max_threads_(max_threads == 0 ? 1 : max_threads) {}
+
+      ~blocking_pool() {
+        shutdown();
+      }
+
+      // Queues t, starting a thread if none is idle and the pool has room
+      // for another. After shutdown() it is abandoned at once, on this
+      // thread.
+      inline void post(pool_task* t) {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!stopped_) {
+            t->next_ = nullptr;
+            if (tail_)
+              tail_->next_ = t;
+            else
+              head_ = t;
+            tail_ = t;
+            if (idle_threads_ == 0 && threads_.size() < max_threads_)
+              threads_.emplace_back([this] { run(); });
+            else
+              cv_.notify_one();
+            return;
+          }
+        }
+        t->run_(t, true);
+      }
+
+      // Threads finish the task they are running and leave; tasks still
+      // queued are abandoned on this thread. Must not be called from a
+      // pool thread.
+      inline void shutdown() {
+        std::vector<std::thread> threads;
+        pool_task* t;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stopped_ = true;
+          threads.swap(threads_);
+          t = head_;
+          head_ = tail_ = nullptr;
+        }
+        cv_.notify_all();
+        for (std::thread& thread : threads)
+          thread.join();
+
+        while (t) {
+          pool_task* next = t->next_;
+          t->run_(t, true);
+          t = next;
+        }
+      }
+
+    private:
+      inline void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+          ++idle_threads_;
+          cv_.wait(lock, [this] { return stopped_ || head_; });
+          --idle_threads_;
+          if (stopped_)
+            return;
+
+          pool_task* t = head_;
+          head_ = t->next_;
+          if (!head_)
+            tail_ = nullptr;
+          lock.unlock();
+          t->run_(t, false);
+          lock.lock();
+        }
+      }
+
+      const std::size_t max_threads_;
+      std::mutex mutex_;
+      std::condition_variable cv_;
+      pool_task* head_ = nullptr;
+      pool_task* tail_ = nullptr;
+      std::vector<std::thread> threads_;
+      std::size_t idle_threads_ = 0;
+      bool stopped_ = false;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
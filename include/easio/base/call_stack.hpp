@@ -61,6 +61,11 @@ namespace easio {
         return top_ ? top_->value_ : nullptr;
       }
 
+      // O(1), unlike contains(): only the innermost context is checked.
+      static Value* top_if(Key* k) {
+        return top_ && top_->key_ == k ? top_->value_ : nullptr;
+      }
+
     private:
       thread_local static context* top_;
     };
@@ -0,0 +1,139 @@
+#ifndef EASIO_BASE_CANCELLATION_SIGNAL_HPP
+#define EASIO_BASE_CANCELLATION_SIGNAL_HPP
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "base/noncopyable.hpp"
+#include "base/thread_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    class cancellation_handler_base {
+    public:
+      virtual void call() = 0;
+      // Destroys the handler and returns its memory block for deallocation.
+      virtual std::pair<void*, std::size_t> destroy() noexcept = 0;
+
+    protected:
+      ~cancellation_handler_base() = default;
+    };
+
+    template <typename Handler>
+    class cancellation_handler : public cancellation_handler_base {
+    public:
+      template <typename... Args>
+      cancellation_handler(std::size_t size, Args&&... args)
+        : handler_(std::forward<Args>(args)...), size_(size) {}
+
+      void call() override {
+        handler_();
+      }
+
+      std::pair<void*, std::size_t> destroy() noexcept override {
+        std::pair<void*, std::size_t> mem(this, size_);
+        this->~cancellation_handler();
+        return mem;
+      }
+
+      Handler& handler() noexcept {
+        return handler_;
+      }
+
+    private:
+      ~cancellation_handler() = default;
+
+      Handler handler_;
+      std::size_t size_;
+    };
+
+    class cancellation_slot;
+
+    // Lets a handler-based operation be cancelled. The operation installs a
+    // handler in the slot when it starts and clears it when it completes;
+    // emit() runs it. Handler memory comes from the cancellation_signal_tag
+    // cache of the current thread, so re-arming a slot for each operation
+    // does not hit the heap. Not thread safe: emit() must run on the thread
+    // or strand that starts and completes the operations.
+    class cancellation_signal : private noncopyable {
+    public:
+      cancellation_signal() noexcept : handler_(nullptr) {}
+
+      inline ~cancellation_signal();
+
+      void emit() {
+        if (handler_)
+          handler_->call();
+      }
+
+      inline cancellation_slot slot() noexcept;
+
+    private:
+      cancellation_handler_base* handler_;
+    };
+
+    class cancellation_slot {
+    public:
+      cancellation_slot() noexcept : handler_(nullptr) {}
+
+      template <typename Handler, typename... Args>
+      Handler& emplace(Args&&... args) {
+        using handler_type = cancellation_handler<Handler>;
+        clear();
+        std::size_t size = sizeof(handler_type);
+        void* p = thread_info::allocate(thread_info::cancellation_signal_tag(),
+                                        thread_context::top_of_thread_call_stack(),
+                                        size, alignof(handler_type));
+        handler_type* h;
+        try {
+          h = new (p) handler_type(size, std::forward<Args>(args)...);
+        } catch (...) {
+          thread_info::deallocate(thread_info::cancellation_signal_tag(),
+                                  thread_context::top_of_thread_call_stack(), p, size);
+          throw;
+        }
+        *handler_ = h;
+        return h->handler();
+      }
+
+      void clear() noexcept {
+        if (handler_ && *handler_) {
+          std::pair<void*, std::size_t> mem = (*handler_)->destroy();
+          *handler_ = nullptr;
+          thread_info::deallocate(thread_info::cancellation_signal_tag(),
+                                  thread_context::top_of_thread_call_stack(),
+                                  mem.first, mem.second);
+        }
+      }
+
+      bool is_connected() const noexcept {
+        return handler_ != nullptr;
+      }
+
+      bool has_handler() const noexcept {
+        return handler_ && *handler_;
+      }
+
+    private:
+      friend class cancellation_signal;
+
+      explicit cancellation_slot(cancellation_handler_base** handler) noexcept
+        : handler_(handler) {}
+
+      cancellation_handler_base** handler_;
+    };
+
+    cancellation_signal::~cancellation_signal() {
+      cancellation_slot(&handler_).clear();
+    }
+
+    cancellation_slot cancellation_signal::slot() noexcept {
+      return cancellation_slot(&handler_);
+    }
+  }  // namespace base
+}  // namespace easio
+
+#endif
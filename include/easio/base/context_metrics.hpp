@@ -0,0 +1,216 @@
+#ifndef EASIO_BASE_CONTEXT_METRICS_HPP
+#define EASIO_BASE_CONTEXT_METRICS_HPP
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "base/noncopyable.hpp"
+
+namespace easio {
+  namespace base {
+
+    // A context's counters, summed over its threads when read. Counters
+    // only grow; rates come from the difference of two snapshots. With
+    // EASIO_DISABLE_METRICS defined nothing is recorded and only
+    // outstanding_work and queue_depth are filled in.
+    struct context_metrics {
+      using clock = std::chrono::steady_clock;
+
+      // Bucket 0 holds handlers that ran for under 1024ns, and bucket i
+      // those that ran for [2^(i-1), 2^i) * 1024ns. The last bucket also
+      // takes everything longer.
+      static constexpr std::size_t histogram_buckets = 24;
+
+      clock::time_point taken_at;
+      std::uint64_t completions = 0;
+      std::uint64_t wakeups = 0;
+      std::uint64_t allocation_hits = 0;
+      std::uint64_t allocation_misses = 0;
+      std::chrono::nanoseconds handler_time{0};
+      std::chrono::nanoseconds blocked_time{0};
+      long outstanding_work = 0;
+      std::size_t queue_depth = 0;
+      std::array<std::uint64_t, histogram_buckets> handler_histogram{};
+
+      // Receives that carried a kernel timestamp, and how long their
+      // datagrams waited between the kernel and the handler, bucketed as
+      // handler_histogram is.
+      std::uint64_t timestamped_receives = 0;
+      std::chrono::nanoseconds receive_delay{0};
+      std::array<std::uint64_t, histogram_buckets> receive_delay_histogram{};
+
+      double completions_per_second(const context_metrics& earlier) const {
+        std::chrono::duration<double> elapsed = taken_at - earlier.taken_at;
+        if (elapsed.count() <= 0)
+          return 0;
+        return static_cast<double>(completions - earlier.completions) / elapsed.count();
+      }
+
+      static std::size_t histogram_bucket(std::chrono::nanoseconds d) noexcept {
+        std::uint64_t units = d.count() > 0 ? static_cast<std::uint64_t>(d.count()) >> 10 : 0;
+        std::size_t bucket = static_cast<std::size_t>(std::bit_width(units));
+        return bucket < histogram_buckets ? bucket : histogram_buckets - 1;
+      }
+    };
+
+#if !defined(EASIO_DISABLE_METRICS)
+    // One thread's counters, on cache lines of their own. Normally only
+    // the owning thread writes a slot, so the relaxed adds never contend.
+    class alignas(64) metrics_slot : private noncopyable {
+    public:
+      void on_handler(std::chrono::nanoseconds d) noexcept {
+        completions_.fetch_add(1, std::memory_order_relaxed);
+        handler_ns_.fetch_add(static_cast<std::uint64_t>(d.count()), std::memory_order_relaxed);
+        histogram_[context_metrics::histogram_bucket(d)].fetch_add(1, std::memory_order_relaxed);
+      }
+
+      void on_blocked(std::chrono::nanoseconds d) noexcept {
+        blocked_ns_.fetch_add(static_cast<std::uint64_t>(d.count()), std::memory_order_relaxed);
+      }
+
+      void on_wakeup() noexcept {
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      void on_receive_delay(std::chrono::nanoseconds d) noexcept {
+        if (d.count() < 0)
+          d = std::chrono::nanoseconds(0);
+        timestamped_receives_.fetch_add(1, std::memory_order_relaxed);
+        receive_delay_ns_.fetch_add(static_cast<std::uint64_t>(d.count()), std::memory_order_relaxed);
+        receive_delay_histogram_[context_metrics::histogram_bucket(d)].fetch_add(1, std::memory_order_relaxed);
+      }
+
+      void on_allocation(bool hit) noexcept {
+        (hit ? allocation_hits_ : allocation_misses_).fetch_add(1, std::memory_order_relaxed);
+      }
+
+      void add_to(context_metrics& m) const noexcept {
+        m.completions += completions_.load(std::memory_order_relaxed);
+        m.wakeups += wakeups_.load(std::memory_order_relaxed);
+        m.allocation_hits += allocation_hits_.load(std::memory_order_relaxed);
+        m.allocation_misses += allocation_misses_.load(std::memory_order_relaxed);
+        m.handler_time += std::chrono::nanoseconds(handler_ns_.load(std::memory_order_relaxed));
+        m.blocked_time += std::chrono::nanoseconds(blocked_ns_.load(std::memory_order_relaxed));
+        m.timestamped_receives += timestamped_receives_.load(std::memory_order_relaxed);
+        m.receive_delay += std::chrono::nanoseconds(receive_delay_ns_.load(std::memory_order_relaxed));
+        for (std::size_t i = 0; i < context_metrics::histogram_buckets; ++i) {
+          m.handler_histogram[i] += histogram_[i].load(std::memory_order_relaxed);
+          m.receive_delay_histogram[i] += receive_delay_histogram_[i].load(std::memory_order_relaxed);
+        }
+      }
+
+    private:
+      friend class metrics_registry;
+
+      std::atomic<bool> in_use_{false};
+      std::atomic<std::uint64_t> completions_{0};
+      std::atomic<std::uint64_t> wakeups_{0};
+      std::atomic<std::uint64_t> allocation_hits_{0};
+      std::atomic<std::uint64_t> allocation_misses_{0};
+      std::atomic<std::uint64_t> handler_ns_{0};
+      std::atomic<std::uint64_t> blocked_ns_{0};
+      std::atomic<std::uint64_t> histogram_[context_metrics::histogram_buckets] = {};
+      std::atomic<std::uint64_t> timestamped_receives_{0};
+      std::atomic<std::uint64_t> receive_delay_ns_{0};
+      std::atomic<std::uint64_t> receive_delay_histogram_[context_metrics::histogram_buckets] = {};
+    };
+
+    // A context's slots. A thread entering run() claims a free slot and
+    // gives it back, counts intact, when it leaves. Threads beyond
+    // max_metrics_slots share one extra slot.
+    class metrics_registry : private noncopyable {
+    public:
+      static const std::size_t max_metrics_slots = 32;
+
+      metrics_slot* acquire() noexcept {
+        for (metrics_slot& slot : slots_) {
+          bool expected = false;
+          if (!slot.in_use_.load(std::memory_order_relaxed) &&
+              slot.in_use_.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return &slot;
+        }
+        return &overflow_;
+      }
+
+      void release(metrics_slot* slot) noexcept {
+        if (slot != &overflow_)
+          slot->in_use_.store(false, std::memory_order_release);
+      }
+
+      void collect(context_metrics& m) const noexcept {
+        for (const metrics_slot& slot : slots_)
+          slot.add_to(m);
+        overflow_.add_to(m);
+      }
+
+    private:
+      metrics_slot slots_[max_metrics_slots];
+      metrics_slot overflow_;
+    };
+
+    // Times a span of a thread's work into its slot, if it has one.
+    class handler_timer : private noncopyable {
+    public:
+      explicit handler_timer(metrics_slot* slot) noexcept
+        : slot_(slot), start_(slot ? context_metrics::clock::now() : context_metrics::clock::time_point()) {}
+
+      ~handler_timer() {
+        if (slot_)
+          slot_->on_handler(context_metrics::clock::now() - start_);
+      }
+
+    private:
+      metrics_slot* slot_;
+      context_metrics::clock::time_point start_;
+    };
+
+    class blocked_timer : private noncopyable {
+    public:
+      explicit blocked_timer(metrics_slot* slot) noexcept
+        : slot_(slot), start_(slot ? context_metrics::clock::now() : context_metrics::clock::time_point()) {}
+
+      ~blocked_timer() {
+        if (slot_)
+          slot_->on_blocked(context_metrics::clock::now() - start_);
+      }
+
+    private:
+      metrics_slot* slot_;
+      context_metrics::clock::time_point start_;
+    };
+#else
+    class metrics_slot : private noncopyable {
+    public:
+      void on_handler(std::chrono::nanoseconds) noexcept {}
+      void on_blocked(std::chrono::nanoseconds) noexcept {}
+      void on_wakeup() noexcept {}
+      void on_receive_delay(std::chrono::nanoseconds) noexcept {}
+      void on_allocation(bool) noexcept {}
+    };
+
+    class metrics_registry : private noncopyable {
+    public:
+      metrics_slot* acquire() noexcept { return nullptr; }
+      void release(metrics_slot*) noexcept {}
+      void collect(context_metrics&) const noexcept {}
+    };
+
+    class handler_timer : private noncopyable {
+    public:
+      explicit handler_timer(metrics_slot*) noexcept {}
+    };
+
+    class blocked_timer : private noncopyable {
+    public:
+      explicit blocked_timer(metrics_slot*) noexcept {}
+    };
+#endif
+  }  // namespace base
+}  // namespace easio
+
+#endif
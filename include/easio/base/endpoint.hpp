@@ -6,9 +6,12 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #else
+#include <arpa/inet.h>
+#include <netdb.h>
 #include <netinet/in.h>
 #endif
 
+#include <cstddef>
 #include <string_view>
 
 namespace easio {
@@ -17,9 +20,11 @@ namespace easio {
     template <typename Protocol>
     class endpoint {
     public:
+      using protocol_type = Protocol;
+
       endpoint() noexcept : data_() { data_.v4.sin_family = AF_INET; }
 
-      endpoint(const Protocol &protocol, unsigned short port) noexcept : data_() {
+      endpoint(const Protocol &protocol, unsigned short port_num) noexcept : data_() {
         if (protocol.family() == AF_INET) {
           data_.v4.sin_family = AF_INET;
           data_.v4.sin_port = htons(port_num);
@@ -36,6 +41,24 @@ namespace easio {
 
       bool is_v4() const noexcept { return data_.base.sa_family == AF_INET; }
 
+      protocol_type protocol() const noexcept {
+        return is_v4() ? Protocol::v4() : Protocol::v6();
+      }
+
+      unsigned short port() const noexcept {
+        return ntohs(is_v4() ? data_.v4.sin_port : data_.v6.sin6_port);
+      }
+
+      struct sockaddr *data() noexcept { return &data_.base; }
+
+      const struct sockaddr *data() const noexcept { return &data_.base; }
+
+      std::size_t size() const noexcept {
+        return is_v4() ? sizeof(data_.v4) : sizeof(data_.v6);
+      }
+
+      std::size_t capacity() const noexcept { return sizeof(data_); }
+
     private:
       union {
         struct sockaddr base;
@@ -45,4 +68,4 @@ namespace easio {
     };
   }  // namespace base
 }  // namespace easio
-#endif
\ No newline at end of file
+#endif
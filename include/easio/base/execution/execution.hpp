@@ -1,4 +1,7 @@
 #include <include/tag_invoke.hpp>
 
 #include <include/receiver.hpp>
-#include <include/sender.hpp>
\ No newline at end of file
+#include <include/stop_token.hpp>
+#include <include/queries.hpp>
+#include <include/sender.hpp>
+#include <include/scheduler.hpp>
@@ -1,6 +1,6 @@
 //
 // Copyright (c) 2021- Lee Goudan
-// Last Modified: 2021-09-03
+// Last Modified: 2026-10-19
 // Distributed under The MIT License (MIT) at https://mit-license.org/
 //
 
@@ -8,14 +8,35 @@
 #define EASIO_BASE_EXECUTION_QUERIES_HPP
 #pragma once
 
-#include "include/scheduler.hpp"
+#include "include/receiver.hpp"
+#include "include/stop_token.hpp"
 
 namespace easio {
   namespace base {
     namespace execution {
-      
+      /////////////////////////////////////////////////////////////////////////////
+      // [execution.queries.get_stop_token]
+      //
+      // Receivers that can ask their sender to stop answer with a stoppable
+      // token; every other receiver gets never_stop_token.
+      inline namespace _get_stop_token_cpo {
+        inline constexpr struct get_stop_token_t {
+          template <typename R>
+          auto operator()(const R& r) const noexcept {
+            if constexpr (tag_invocable<get_stop_token_t, const R&>) {
+              static_assert(stoppable_token<tag_invoke_result_t<get_stop_token_t, const R&>>);
+              return tag_invoke(get_stop_token_t{}, r);
+            } else {
+              return never_stop_token{};
+            }
+          }
+        } get_stop_token{};
+      }  // namespace _get_stop_token_cpo
+
+      template <typename R>
+      using stop_token_of_t = std::remove_cvref_t<decltype(get_stop_token(std::declval<const R&>()))>;
     }
   }
 }
 
-#endif
\ No newline at end of file
+#endif
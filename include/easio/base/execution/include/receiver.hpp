@@ -1,6 +1,6 @@
 //
 // Copyright (c) 2021- Lee Goudan
-// Last Modified: 2021-08-30
+// Last Modified: 2026-10-19
 // Distributed under The MIT License (MIT) at https://mit-license.org/
 //
 
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <exception>
+#include <utility>
 #include "include/tag_invoke.hpp"
 
 namespace easio {
@@ -22,7 +23,7 @@ namespace easio {
           requires tag_invocable<set_value_t, R, Values...>
           void operator()(R&& r, Values&&... vs) const
               noexcept(nothrow_tag_invocable<set_value_t, R, Values...>) {
-            (void)tag_invoke(set_value_t{}, std::forward(R), std::forward(vs));
+            (void)tag_invoke(set_value_t{}, std::forward<R>(r), std::forward<Values>(vs)...);
           }
         } set_value{};
         /////////////////////////////////////////////////////////////////////////////
@@ -32,7 +33,7 @@ namespace easio {
           requires tag_invocable<set_error_t, R, E>
           void operator()(R&& r, E&& e) const
               noexcept(nothrow_tag_invocable<set_error_t, R, E>) {
-            (void)tag_invoke(set_error_t{}, std::forward(R), std::forward(e));
+            (void)tag_invoke(set_error_t{}, std::forward<R>(r), std::forward<E>(e));
           }
         } set_error{};
         /////////////////////////////////////////////////////////////////////////////
@@ -42,7 +43,7 @@ namespace easio {
           requires tag_invocable<set_done_t, R>
           void operator()(R&& r) const
               noexcept(nothrow_tag_invocable<set_done_t, R>) {
-            (void)tag_invoke(set_done_t{}, std::forward(R));
+            (void)tag_invoke(set_done_t{}, std::forward<R>(r));
           }
         } set_done{};
       }  // namespace _receiver_cpo
@@ -51,25 +52,25 @@ namespace easio {
       template <typename R, typename E = std::exception_ptr>
       concept receiver =
           std::move_constructible<std::remove_cvref_t<R>> &&
-          std::constructible_from<std::remove_cvref_t<R>> &&
+          std::constructible_from<std::remove_cvref_t<R>, R> &&
           requires(std::remove_cvref_t<R>&& r, E&& e) {
         { set_done(std::move(r)) }
         noexcept;
-        { set_error(std::move(r), std::forward(e)) }
+        { set_error(std::move(r), std::forward<E>(e)) }
         noexcept;
       };
 
       template <typename R, typename... Values>
       concept receiver_of = receiver<R> &&
-          requires(std::remove_cvref_t<R>&& r, Values... vs) {
-        {set_value(std::move(r), std::forward(vs...))};
+          requires(std::remove_cvref_t<R>&& r, Values&&... vs) {
+        {set_value(std::move(r), std::forward<Values>(vs)...)};
       };
 
       template <typename R, typename... Values>
       concept nothrow_receiver_of = receiver_of<R, Values...> &&
           nothrow_tag_invocable<set_value_t, R, Values...>;
 
-    };  // namespace execution
+    }  // namespace execution
   }     // namespace base
 }  // namespace easio
 
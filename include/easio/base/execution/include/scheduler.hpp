@@ -1,6 +1,6 @@
 //
 // Copyright (c) 2021- Lee Goudan
-// Last Modified: 2021-09-02
+// Last Modified: 2026-10-19
 // Distributed under The MIT License (MIT) at https://mit-license.org/
 //
 
@@ -16,10 +16,13 @@ namespace easio {
       /////////////////////////////////////////////////////////////////////////////
       // [execution.schedulers]
       template<typename S>
-      concept scheduler = 
+      concept scheduler =
         std::copy_constructible<std::remove_cvref_t<S>> &&
         std::equality_comparable<std::remove_cvref_t<S>> &&
-        requires(S&& s) { schedule(std::forward(s)); };
+        requires(S&& s) { schedule(std::forward<S>(s)); };
+
+      template <scheduler S>
+      using schedule_result_t = decltype(schedule(std::declval<S>()));
       /////////////////////////////////////////////////////////////////////////////
       // [execution.schedulers.queries]
       enum class forward_progress_guarantee {
@@ -30,11 +33,294 @@ namespace easio {
 
       inline namespace _get_forward_progress_guarantee_cpo {
         inline constexpr struct get_forward_progress_guarantee_t {
-          
+          template <scheduler S>
+          constexpr forward_progress_guarantee operator()(S&& s) const noexcept {
+            if constexpr (tag_invocable<get_forward_progress_guarantee_t, const std::remove_cvref_t<S>&>) {
+              return tag_invoke(get_forward_progress_guarantee_t{}, std::as_const(s));
+            } else {
+              return forward_progress_guarantee::weakly_parallel;
+            }
+          }
         } get_forward_progress_guarantee{};
       }
+
+      /////////////////////////////////////////////////////////////////////////////
+      // [execution.senders.adaptors.transfer]
+      //
+      // Values are stored in the op state and re-sent from a schedule() on the
+      // target. If the source already completes set_value on an equal
+      // scheduler the hop is skipped and the values are forwarded inline.
+      // Errors and done are always forwarded inline.
+      inline namespace _transfer_cpo {
+        template <typename S, typename Sch>
+        constexpr bool _completes_on() {
+          if constexpr (requires(const S& s) { get_completion_scheduler<set_value_t>(s); }) {
+            return std::same_as<std::remove_cvref_t<decltype(get_completion_scheduler<set_value_t>(
+                                    std::declval<const S&>()))>,
+                                Sch>;
+          } else {
+            return false;
+          }
+        }
+
+        template <typename S, typename Sch, typename R>
+        struct _transfer_op;
+
+        template <typename S, typename Sch, typename R>
+        struct _transfer_receiver {
+          _transfer_op<S, Sch, R>* op_;
+
+          template <typename... As>
+          friend void tag_invoke(set_value_t, _transfer_receiver&& self, As&&... as) noexcept {
+            self.op_->set_value(std::forward<As>(as)...);
+          }
+
+          template <typename E>
+          friend void tag_invoke(set_error_t, _transfer_receiver&& self, E&& e) noexcept {
+            set_error(std::move(self.op_->r_), std::forward<E>(e));
+          }
+
+          friend void tag_invoke(set_done_t, _transfer_receiver&& self) noexcept {
+            set_done(std::move(self.op_->r_));
+          }
+
+          friend auto tag_invoke(get_stop_token_t, const _transfer_receiver& self) noexcept {
+            return get_stop_token(self.op_->r_);
+          }
+        };
+
+        // Receives the schedule() completion and sends the stored values.
+        template <typename S, typename Sch, typename R>
+        struct _transfer_hop_receiver {
+          _transfer_op<S, Sch, R>* op_;
+
+          friend void tag_invoke(set_value_t, _transfer_hop_receiver&& self) noexcept {
+            auto* op = self.op_;
+            std::visit([op]<typename T>(T& values) {
+              if constexpr (!std::is_same_v<T, std::monostate>) {
+                std::apply([op](auto&... as) {
+                  try {
+                    set_value(std::move(op->r_), std::move(as)...);
+                  } catch (...) {
+                    set_error(std::move(op->r_), std::current_exception());
+                  }
+                }, values);
+              }
+            }, op->values_);
+          }
+
+          template <typename E>
+          friend void tag_invoke(set_error_t, _transfer_hop_receiver&& self, E&& e) noexcept {
+            set_error(std::move(self.op_->r_), std::forward<E>(e));
+          }
+
+          friend void tag_invoke(set_done_t, _transfer_hop_receiver&& self) noexcept {
+            set_done(std::move(self.op_->r_));
+          }
+
+          friend auto tag_invoke(get_stop_token_t, const _transfer_hop_receiver& self) noexcept {
+            return get_stop_token(self.op_->r_);
+          }
+        };
+
+        template <typename S, typename Sch, typename R>
+        struct _transfer_op {
+          using values_type = value_types_of_t<S, _adaptors::_decayed_tuple, _adaptors::_monostate_variant>;
+          using hop_op_type = connect_result_t<schedule_result_t<Sch&>, _transfer_hop_receiver<S, Sch, R>>;
+
+          template <typename S2, typename R2>
+          _transfer_op(S2&& s, Sch sch, R2&& r)
+            : r_(std::forward<R2>(r)), sch_(std::move(sch)), inline_(_is_inline(s, sch_)),
+              child_op_(connect(std::forward<S2>(s), _transfer_receiver<S, Sch, R>{this})) {}
+
+          _transfer_op(_transfer_op&&) = delete;
+
+          static bool _is_inline(const S& s, const Sch& sch) {
+            if constexpr (_completes_on<S, Sch>())
+              return get_completion_scheduler<set_value_t>(s) == sch;
+            else
+              return false;
+          }
+
+          template <typename... As>
+          void set_value(As&&... as) noexcept {
+            if (inline_) {
+              try {
+                execution::set_value(std::move(r_), std::forward<As>(as)...);
+              } catch (...) {
+                execution::set_error(std::move(r_), std::current_exception());
+              }
+              return;
+            }
+
+            try {
+              values_.template emplace<_adaptors::_decayed_tuple<As...>>(std::forward<As>(as)...);
+              auto& op = hop_op_.emplace(_adaptors::_conv{[this] {
+                return connect(schedule(sch_), _transfer_hop_receiver<S, Sch, R>{this});
+              }});
+              start(op);
+            } catch (...) {
+              execution::set_error(std::move(r_), std::current_exception());
+            }
+          }
+
+          friend void tag_invoke(start_t, _transfer_op& self) noexcept {
+            start(self.child_op_);
+          }
+
+          R r_;
+          Sch sch_;
+          bool inline_;
+          values_type values_;
+          std::optional<hop_op_type> hop_op_;
+          connect_result_t<S, _transfer_receiver<S, Sch, R>> child_op_;
+        };
+
+        template <typename S, typename Sch>
+        struct _transfer_sender {
+          S s_;
+          Sch sch_;
+
+          template <template <typename...> typename Tuple, template <typename...> typename Variant>
+          using value_types = value_types_of_t<S, Tuple, Variant>;
+
+          template <template <typename...> typename Variant>
+          using error_types = typename _adaptors::_apply<
+              _adaptors::_concat_t<error_types_of_t<S, _adaptors::_type_lists>,
+                                   error_types_of_t<schedule_result_t<Sch&>, _adaptors::_type_lists>,
+                                   type_list<std::exception_ptr>>,
+              _adaptors::_unique_variant<Variant>::template apply>::type;
+
+          static constexpr bool sends_done =
+              sender_traits<S>::sends_done || sender_traits<schedule_result_t<Sch&>>::sends_done;
+
+          friend Sch tag_invoke(get_completion_scheduler_t<set_value_t>, const _transfer_sender& self) noexcept {
+            return self.sch_;
+          }
+
+          template <receiver R>
+          friend auto tag_invoke(connect_t, _transfer_sender&& self, R&& r) {
+            return _transfer_op<S, Sch, std::remove_cvref_t<R>>(
+                std::move(self.s_), std::move(self.sch_), std::forward<R>(r));
+          }
+
+          template <receiver R>
+          requires std::copy_constructible<S>
+          friend auto tag_invoke(connect_t, const _transfer_sender& self, R&& r) {
+            return _transfer_op<S, Sch, std::remove_cvref_t<R>>(self.s_, self.sch_, std::forward<R>(r));
+          }
+        };
+
+        inline constexpr struct transfer_t {
+          template <sender S, scheduler Sch>
+          _transfer_sender<std::remove_cvref_t<S>, std::remove_cvref_t<Sch>> operator()(S&& s, Sch&& sch) const {
+            return {std::forward<S>(s), std::forward<Sch>(sch)};
+          }
+
+          template <scheduler Sch>
+          auto operator()(Sch&& sch) const {
+            return _adaptors::_pipeable{[sch = std::forward<Sch>(sch)]<typename S>(S&& s) mutable {
+              return transfer_t{}(std::forward<S>(s), std::move(sch));
+            }};
+          }
+        } transfer{};
+      }  // namespace _transfer_cpo
+
+      /////////////////////////////////////////////////////////////////////////////
+      // [execution.senders.adaptors.bulk]
+      //
+      // Calls f(i, values...) for every i in [0, shape), then sends the values
+      // on. By default the calls run in order on the thread that completed the
+      // source. A scheduler the source completes set_value on can spread them
+      // out by customising bulk: tag_invoke(bulk, sch, s, shape, f).
+      inline namespace _bulk_cpo {
+        template <typename R, typename Shape, typename F>
+        struct _bulk_receiver {
+          R r_;
+          Shape shape_;
+          F f_;
+
+          template <typename... As>
+          friend void tag_invoke(set_value_t, _bulk_receiver&& self, As&&... as) noexcept {
+            try {
+              for (Shape i = 0; i < self.shape_; ++i)
+                std::invoke(self.f_, i, as...);
+              set_value(std::move(self.r_), std::forward<As>(as)...);
+            } catch (...) {
+              set_error(std::move(self.r_), std::current_exception());
+            }
+          }
+
+          template <typename E>
+          friend void tag_invoke(set_error_t, _bulk_receiver&& self, E&& e) noexcept {
+            set_error(std::move(self.r_), std::forward<E>(e));
+          }
+
+          friend void tag_invoke(set_done_t, _bulk_receiver&& self) noexcept {
+            set_done(std::move(self.r_));
+          }
+
+          friend auto tag_invoke(get_stop_token_t, const _bulk_receiver& self) noexcept {
+            return get_stop_token(self.r_);
+          }
+        };
+
+        template <typename S, typename Shape, typename F>
+        struct _bulk_sender {
+          S s_;
+          Shape shape_;
+          F f_;
+
+          template <template <typename...> typename Tuple, template <typename...> typename Variant>
+          using value_types = value_types_of_t<S, Tuple, Variant>;
+
+          template <template <typename...> typename Variant>
+          using error_types = error_types_of_t<S, _adaptors::_append_unique<Variant, std::exception_ptr>::template apply>;
+
+          static constexpr bool sends_done = sender_traits<S>::sends_done;
+
+          template <receiver R>
+          friend auto tag_invoke(connect_t, _bulk_sender&& self, R&& r) {
+            return connect(std::move(self.s_), _bulk_receiver<std::remove_cvref_t<R>, Shape, F>{
+                                                   std::forward<R>(r), self.shape_, std::move(self.f_)});
+          }
+
+          template <receiver R>
+          requires std::copy_constructible<S> && std::copy_constructible<F>
+          friend auto tag_invoke(connect_t, const _bulk_sender& self, R&& r) {
+            return connect(self.s_, _bulk_receiver<std::remove_cvref_t<R>, Shape, F>{
+                                        std::forward<R>(r), self.shape_, self.f_});
+          }
+
+          friend auto tag_invoke(get_completion_scheduler_t<set_value_t>, const _bulk_sender& self) noexcept
+          requires requires(const S& s) { get_completion_scheduler<set_value_t>(s); } {
+            return get_completion_scheduler<set_value_t>(self.s_);
+          }
+        };
+
+        inline constexpr struct bulk_t {
+          template <sender S, std::integral Shape, typename F>
+          auto operator()(S&& s, Shape shape, F&& f) const {
+            if constexpr (requires { tag_invoke(bulk_t{}, get_completion_scheduler<set_value_t>(s),
+                                                std::forward<S>(s), shape, std::forward<F>(f)); }) {
+              auto sch = get_completion_scheduler<set_value_t>(s);
+              return tag_invoke(bulk_t{}, std::move(sch), std::forward<S>(s), shape, std::forward<F>(f));
+            } else {
+              return _bulk_sender<std::remove_cvref_t<S>, Shape, std::decay_t<F>>{
+                  std::forward<S>(s), shape, std::forward<F>(f)};
+            }
+          }
+
+          template <std::integral Shape, typename F>
+          auto operator()(Shape shape, F&& f) const {
+            return _adaptors::_pipeable{[shape, f = std::forward<F>(f)]<typename S>(S&& s) mutable {
+              return bulk_t{}(std::forward<S>(s), shape, std::move(f));
+            }};
+          }
+        } bulk{};
+      }  // namespace _bulk_cpo
     }
   }
 }
 
-#endif
\ No newline at end of file
+#endif
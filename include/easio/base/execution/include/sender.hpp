@@ -1,6 +1,6 @@
 //
 // Copyright (c) 2021- Lee Goudan
-// Last Modified: 2021-08-25
+// Last Modified: 2026-10-19
 // Distributed under The MIT License (MIT) at https://mit-license.org/
 //
 
@@ -8,9 +8,15 @@
 #define EASIO_BASE_EXECUTION_SENDER_HPP
 #pragma once
 
-#include <iostream>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <variant>
 
 #include "include/op_state.hpp"
+#include "include/queries.hpp"
 #include "include/receiver.hpp"
 
 namespace easio {
@@ -20,6 +26,19 @@ namespace easio {
       // [execution.senders.traits]
       struct sender_base {};
 
+      template <template <template <typename...> typename, template <typename...> typename> typename>
+      struct _has_value_types;
+
+      template <template <template <typename...> typename> typename>
+      struct _has_error_types;
+
+      template <typename S>
+      concept has_sender_types = requires {
+        typename _has_value_types<S::template value_types>;
+        typename _has_error_types<S::template error_types>;
+        typename std::bool_constant<S::sends_done>;
+      };
+
       template <typename>
       struct sender_trait_base {
         using __unspecialized = void;
@@ -51,19 +70,6 @@ namespace easio {
             typename sender_traits<std::remove_cvref_t<S>>::__unspecialized;
           };
 
-      template <template <template <typename...> typename, template <typename...> typename> typename>
-      struct _has_value_types;
-
-      template <template <template <typename...> typename> typename>
-      struct _has_error_types;
-
-      template <typename S>
-      concept has_sender_types = requires {
-        typename _has_value_types<S::template value_types>;
-        typename _has_error_types<S::template error_types>;
-        typename std::bool_constant<S::send_done>;
-      };
-
       template <typename S>
       concept typed_sender = sender<S> &&
           has_sender_types<sender_traits<std::remove_cvref_t<S>>>;
@@ -75,7 +81,15 @@ namespace easio {
       concept sender_of = typed_sender<S> &&
                         std::same_as <
                         type_list<Types...>,
-      typename sender_traits<S>::template value_types<type_list, std::type_identity_t> > ;
+      typename sender_traits<std::remove_cvref_t<S>>::template value_types<type_list, std::type_identity_t> > ;
+
+      template <typename S, template <typename...> typename Tuple, template <typename...> typename Variant>
+      using value_types_of_t =
+          typename sender_traits<std::remove_cvref_t<S>>::template value_types<Tuple, Variant>;
+
+      template <typename S, template <typename...> typename Variant>
+      using error_types_of_t =
+          typename sender_traits<std::remove_cvref_t<S>>::template error_types<Variant>;
       /////////////////////////////////////////////////////////////////////////////
       // [execution.senders.connect]
       inline namespace _connect_cpo {
@@ -85,30 +99,40 @@ namespace easio {
               operation_state<tag_invoke_result_t<connect_t, S, R>>
           auto operator()(S&& s, R&& r) const
               noexcept(nothrow_tag_invocable<connect_t, S, R>) {
-            return tag_invoke(connect_t{}, std::forward(s), std::forward(r));
+            return tag_invoke(connect_t{}, std::forward<S>(s), std::forward<R>(r));
           }
         } connect{};
       }  // namespace _connect_cpo
+
+      template <typename S, typename R>
+      using connect_result_t = decltype(connect(std::declval<S>(), std::declval<R>()));
       /////////////////////////////////////////////////////////////////////////////
       // [execution.senders]
       template <typename S, typename R>
       concept sender_to =
           sender<S> && receiver<R> &&
           requires(S&& s, R&& r) {
-        connect(std::forward(s), std::forward(r));
+        connect(std::forward<S>(s), std::forward<R>(r));
       };
       /////////////////////////////////////////////////////////////////////////////
       // [execution.senders.queries], sender queries
       inline namespace _get_completion_scheduler_cpo {
-        inline constexpr struct get_completion_scheduler_t {
-          template <typename CPO, sender S>
-          requires tag_invocable<get_completion_scheduler_t, CPO, S>
-          auto operator()(S&& s) const
-              noexcept(nothrow_tag_invocable<get_completion_scheduler_t, CPO, S>) {
-            return tag_invoke(get_completion_scheduler_t{}, std::forward(s));
+        // get_completion_scheduler<set_value_t>(s) names the scheduler whose
+        // execution context s completes set_value on.
+        template <typename CPO>
+        requires std::same_as<CPO, set_value_t> || std::same_as<CPO, set_error_t> ||
+                 std::same_as<CPO, set_done_t>
+        struct get_completion_scheduler_t {
+          template <sender S>
+          requires tag_invocable<get_completion_scheduler_t, const S&>
+          auto operator()(const S& s) const
+              noexcept(nothrow_tag_invocable<get_completion_scheduler_t, const S&>) {
+            return tag_invoke(get_completion_scheduler_t{}, s);
           }
+        };
 
-        } get_completion_scheduler{};
+        template <typename CPO>
+        inline constexpr get_completion_scheduler_t<CPO> get_completion_scheduler{};
       }  // namespace _get_completion_scheduler_cpo
 
       /////////////////////////////////////////////////////////////////////////////
@@ -120,7 +144,7 @@ namespace easio {
               sender<tag_invoke_result_t<schedule_t, S>>
           auto operator()(S&& s) const
               noexcept(nothrow_tag_invocable<schedule_t, S>) {
-            return tag_invoke(schedule_t{}, std::forward(s));
+            return tag_invoke(schedule_t{}, std::forward<S>(s));
           }
         } schedule{};
       }  // namespace _schedule_cpo
@@ -132,7 +156,7 @@ namespace easio {
           requires tag_invocable<consumer_start_detached_t, S, R>
           void operator()(S&& s, R&& r) const
               noexcept(nothrow_tag_invocable<consumer_start_detached_t, S, R>) {
-            (void)tag_invoke(consumer_start_detached_t{}, std::forward(s), std::forward(r));
+            (void)tag_invoke(consumer_start_detached_t{}, std::forward<S>(s), std::forward<R>(r));
           }
         } consumer_start_detached{};
       }  // namespace _consumer_start_detached_cpo
@@ -145,42 +169,73 @@ namespace easio {
         };
 
         template <typename... Ts>
-        struct _just_sender {
-          std::tuple<Ts...> vs_;
+        struct _just_sender_traits<set_value_t, Ts...> {
           template <template <typename...> typename Tuple, template <typename...> typename Variant>
           using value_types = Variant<Tuple<Ts...>>;
 
           template <template <typename...> typename Variant>
-          using error_types = Variant<>;
+          using error_types = Variant<std::exception_ptr>;
+
+          static constexpr bool sends_done = false;
+        };
+
+        template <typename E>
+        struct _just_sender_traits<set_error_t, E> {
+          template <template <typename...> typename Tuple, template <typename...> typename Variant>
+          using value_types = Variant<>;
+
+          template <template <typename...> typename Variant>
+          using error_types = Variant<E>;
 
           static constexpr bool sends_done = false;
+        };
+
+        template <>
+        struct _just_sender_traits<set_done_t> {
+          template <template <typename...> typename Tuple, template <typename...> typename Variant>
+          using value_types = Variant<>;
+
+          template <template <typename...> typename Variant>
+          using error_types = Variant<>;
+
+          static constexpr bool sends_done = true;
+        };
+
+        template <typename CPO, typename... Ts>
+        struct _just_sender : _just_sender_traits<CPO, Ts...> {
+          std::tuple<Ts...> vs_;
 
           template <typename R>
           struct operation_state {
             std::tuple<Ts...> vs_;
             R r_;
 
-            void tag_invoke(start_t)
-              noexcept(noexcept(set_value(std::declval<R>(), std::declval<Ts>()...))) {
-              try {
+            friend void tag_invoke(start_t, operation_state& self) noexcept {
+              if constexpr (std::is_same_v<CPO, set_value_t>) {
+                try {
+                  std::apply(
+                      [&](Ts&... values) { set_value(std::move(self.r_), std::move(values)...); },
+                      self.vs_);
+                } catch (...) {
+                  set_error(std::move(self.r_), std::current_exception());
+                }
+              } else {
                 std::apply(
-                    [&](Ts&&... values_) { set_value(std::move(r_), std::forward(values_)...); },
-                    std::move(vs_));
-              } catch (...) {
-                set_error(std::move(r_), std::current_exception());
+                    [&](Ts&... values) { CPO{}(std::move(self.r_), std::move(values)...); },
+                    self.vs_);
               }
             }
           };
 
           template <receiver R>
-          requires receiver_of<R, Ts...> &&(std::copyable<Ts>&&...) auto tag_invoke(connect_t, R&& r) const& {
-            return operation_state<R>(vs_, std::forward(r));
+          requires(std::copyable<Ts>&&...)
+          friend auto tag_invoke(connect_t, const _just_sender& self, R&& r) {
+            return operation_state<std::remove_cvref_t<R>>{self.vs_, std::forward<R>(r)};
           }
 
           template <receiver R>
-          requires receiver_of<R, Ts...>
-          auto tag_invoke(connect_t, R&& r) && {
-            return operation_state<R>(std::move(vs_), std::forward(r));
+          friend auto tag_invoke(connect_t, _just_sender&& self, R&& r) {
+            return operation_state<std::remove_cvref_t<R>>{std::move(self.vs_), std::forward<R>(r)};
           }
         };
 
@@ -189,7 +244,7 @@ namespace easio {
             requires(std::constructible_from<std::decay_t<Ts>, Ts>&&...)
           _just_sender<set_value_t, std::decay_t<Ts>...> operator()(Ts&&... ts) const
             noexcept((std::is_nothrow_constructible_v<std::decay_t<Ts>, Ts> && ...)) {
-            return {{}, {std::forward(ts)...}};
+            return {{}, {std::forward<Ts>(ts)...}};
           }
         } just{};
 
@@ -197,18 +252,18 @@ namespace easio {
           template<typename Error>
             requires std::constructible_from<std::decay_t<Error>, Error>
           _just_sender<set_error_t, std::decay_t<Error>> operator()(Error&& e) const
-            noexcept(std::is_nothrow_constructible_v(std::decay_t<Error>, Error)) {
-            return {{}, {std::forward(e)}};
+            noexcept(std::is_nothrow_constructible_v<std::decay_t<Error>, Error>) {
+            return {{}, {std::forward<Error>(e)}};
           }
         } just_error{};
 
         inline constexpr struct just_done_t {
           _just_sender<set_done_t> operator()() const noexcept {
-            return {{}};
+            return {{}, {}};
           }
         } just_done{};
       }  // namespace _just_cpo
-      
+
       /////////////////////////////////////////////////////////////////////////////
       // [execution.senders.transfer_just]
       inline namespace _transfer_just_cpo {
@@ -216,8 +271,834 @@ namespace easio {
       }
       /////////////////////////////////////////////////////////////////////////////
       // [execution.senders.adaptors]
+      //
+      // Every adaptor connects its child with a receiver that points back into
+      // the adaptor's own operation state, so a whole pipeline connects into a
+      // single nested object and no stage allocates.
+      namespace _adaptors {
+        template <typename... Lists>
+        struct _concat {
+          using type = type_list<>;
+        };
+
+        template <typename... As>
+        struct _concat<type_list<As...>> {
+          using type = type_list<As...>;
+        };
+
+        template <typename... As, typename... Bs, typename... Rest>
+        struct _concat<type_list<As...>, type_list<Bs...>, Rest...>
+          : _concat<type_list<As..., Bs...>, Rest...> {};
+
+        template <typename Out, typename... Ts>
+        struct _unique {
+          using type = Out;
+        };
+
+        template <typename... Os, typename T, typename... Ts>
+        struct _unique<type_list<Os...>, T, Ts...>
+          : _unique<std::conditional_t<(std::is_same_v<T, Os> || ...),
+                                       type_list<Os...>, type_list<Os..., T>>,
+                    Ts...> {};
+
+        template <typename List, template <typename...> typename Fn>
+        struct _apply;
+
+        template <typename... Ts, template <typename...> typename Fn>
+        struct _apply<type_list<Ts...>, Fn> {
+          using type = Fn<Ts...>;
+        };
+
+        template <typename... Lists>
+        using _concat_t = typename _concat<Lists...>::type;
+
+        // Variant<Ts...> with duplicates removed.
+        template <template <typename...> typename Variant>
+        struct _unique_variant {
+          template <typename... Ts>
+          using apply = typename _apply<typename _unique<type_list<>, Ts...>::type, Variant>::type;
+        };
+
+        template <template <typename...> typename Variant, typename... Extra>
+        struct _append_unique {
+          template <typename... Ts>
+          using apply = typename _unique_variant<Variant>::template apply<Ts..., Extra...>;
+        };
+
+        template <typename... Ts>
+        using _decayed_tuple = std::tuple<std::decay_t<Ts>...>;
+
+        template <typename... Ts>
+        using _decayed_type_list = type_list<std::decay_t<Ts>...>;
+
+        template <typename... Ts>
+        using _monostate_variant =
+            typename _unique_variant<std::variant>::template apply<std::monostate, Ts...>;
+
+        template <typename... Ts>
+        using _type_lists = type_list<Ts...>;
+
+        template <template <typename...> typename Tuple, typename Result>
+        struct _result_tuple {
+          using type = Tuple<Result>;
+        };
+
+        template <template <typename...> typename Tuple>
+        struct _result_tuple<Tuple, void> {
+          using type = Tuple<>;
+        };
+
+        // Builds a non-movable operation state in place from a function's
+        // prvalue result, e.g. inside std::optional::emplace.
+        template <typename Fn>
+        struct _conv {
+          Fn fn_;
+          using type = std::invoke_result_t<Fn>;
+          operator type() && { return std::move(fn_)(); }
+        };
+
+        template <typename Fn>
+        _conv(Fn) -> _conv<Fn>;
+
+        template <typename Fn>
+        struct _pipeable {
+          Fn fn_;
+
+          template <sender S>
+          friend auto operator|(S&& s, _pipeable&& self) {
+            return std::move(self.fn_)(std::forward<S>(s));
+          }
+        };
+
+        template <typename Fn>
+        _pipeable(Fn) -> _pipeable<Fn>;
+      }  // namespace _adaptors
+
+      /////////////////////////////////////////////////////////////////////////////
+      // [execution.senders.adaptors.then]
+      inline namespace _then_cpo {
+        template <template <typename...> typename Tuple, typename F>
+        struct _then_value {
+          template <typename... As>
+          using apply = typename _adaptors::_result_tuple<Tuple, std::invoke_result_t<F, As...>>::type;
+        };
+
+        template <typename R, typename F>
+        struct _then_receiver {
+          R r_;
+          F f_;
+
+          template <typename... As>
+          requires std::invocable<F, As...>
+          friend void tag_invoke(set_value_t, _then_receiver&& self, As&&... as) noexcept {
+            try {
+              if constexpr (std::is_void_v<std::invoke_result_t<F, As...>>) {
+                std::invoke(std::move(self.f_), std::forward<As>(as)...);
+                set_value(std::move(self.r_));
+              } else {
+                set_value(std::move(self.r_), std::invoke(std::move(self.f_), std::forward<As>(as)...));
+              }
+            } catch (...) {
+              set_error(std::move(self.r_), std::current_exception());
+            }
+          }
+
+          template <typename E>
+          friend void tag_invoke(set_error_t, _then_receiver&& self, E&& e) noexcept {
+            set_error(std::move(self.r_), std::forward<E>(e));
+          }
+
+          friend void tag_invoke(set_done_t, _then_receiver&& self) noexcept {
+            set_done(std::move(self.r_));
+          }
+
+          friend auto tag_invoke(get_stop_token_t, const _then_receiver& self) noexcept {
+            return get_stop_token(self.r_);
+          }
+        };
+
+        template <typename S, typename F>
+        struct _then_sender {
+          S s_;
+          F f_;
+
+          template <template <typename...> typename Tuple, template <typename...> typename Variant>
+          using value_types = value_types_of_t<S, _then_value<Tuple, F>::template apply,
+                                               _adaptors::_unique_variant<Variant>::template apply>;
+
+          template <template <typename...> typename Variant>
+          using error_types = error_types_of_t<S, _adaptors::_append_unique<Variant, std::exception_ptr>::template apply>;
+
+          static constexpr bool sends_done = sender_traits<S>::sends_done;
+
+          template <receiver R>
+          friend auto tag_invoke(connect_t, _then_sender&& self, R&& r) {
+            return connect(std::move(self.s_),
+                           _then_receiver<std::remove_cvref_t<R>, F>{std::forward<R>(r), std::move(self.f_)});
+          }
+
+          template <receiver R>
+          requires std::copy_constructible<S> && std::copy_constructible<F>
+          friend auto tag_invoke(connect_t, const _then_sender& self, R&& r) {
+            return connect(self.s_, _then_receiver<std::remove_cvref_t<R>, F>{std::forward<R>(r), self.f_});
+          }
+
+          // f runs where the source completes, so the value does too.
+          friend auto tag_invoke(get_completion_scheduler_t<set_value_t>, const _then_sender& self) noexcept
+          requires requires(const S& s) { get_completion_scheduler<set_value_t>(s); } {
+            return get_completion_scheduler<set_value_t>(self.s_);
+          }
+        };
+
+        inline constexpr struct then_t {
+          template <sender S, typename F>
+          _then_sender<std::remove_cvref_t<S>, std::decay_t<F>> operator()(S&& s, F&& f) const {
+            return {std::forward<S>(s), std::forward<F>(f)};
+          }
+
+          template <typename F>
+          auto operator()(F&& f) const {
+            return _adaptors::_pipeable{[f = std::forward<F>(f)]<typename S>(S&& s) mutable {
+              return then_t{}(std::forward<S>(s), std::move(f));
+            }};
+          }
+        } then{};
+      }  // namespace _then_cpo
+
+      /////////////////////////////////////////////////////////////////////////////
+      // [execution.senders.adaptors.upon_error]
+      inline namespace _upon_error_cpo {
+        template <template <typename...> typename Tuple, typename F>
+        struct _upon_error_value {
+          template <typename... Es>
+          using apply = type_list<
+              typename _adaptors::_result_tuple<Tuple, std::invoke_result_t<F, Es>>::type...>;
+        };
+
+        template <typename R, typename F>
+        struct _upon_error_receiver {
+          R r_;
+          F f_;
+
+          template <typename... As>
+          friend void tag_invoke(set_value_t, _upon_error_receiver&& self, As&&... as) noexcept {
+            try {
+              set_value(std::move(self.r_), std::forward<As>(as)...);
+            } catch (...) {
+              set_error(std::move(self.r_), std::current_exception());
+            }
+          }
+
+          template <typename E>
+          friend void tag_invoke(set_error_t, _upon_error_receiver&& self, E&& e) noexcept {
+            try {
+              if constexpr (!std::invocable<F, E>) {
+                set_error(std::move(self.r_), std::forward<E>(e));
+              } else if constexpr (std::is_void_v<std::invoke_result_t<F, E>>) {
+                std::invoke(std::move(self.f_), std::forward<E>(e));
+                set_value(std::move(self.r_));
+              } else {
+                set_value(std::move(self.r_), std::invoke(std::move(self.f_), std::forward<E>(e)));
+              }
+            } catch (...) {
+              set_error(std::move(self.r_), std::current_exception());
+            }
+          }
+
+          friend void tag_invoke(set_done_t, _upon_error_receiver&& self) noexcept {
+            set_done(std::move(self.r_));
+          }
+
+          friend auto tag_invoke(get_stop_token_t, const _upon_error_receiver& self) noexcept {
+            return get_stop_token(self.r_);
+          }
+        };
+
+        template <typename S, typename F>
+        struct _upon_error_sender {
+          S s_;
+          F f_;
+
+          template <template <typename...> typename Tuple, template <typename...> typename Variant>
+          using value_types = typename _adaptors::_apply<
+              _adaptors::_concat_t<value_types_of_t<S, Tuple, _adaptors::_type_lists>,
+                                   error_types_of_t<S, _upon_error_value<Tuple, F>::template apply>>,
+              _adaptors::_unique_variant<Variant>::template apply>::type;
+
+          template <template <typename...> typename Variant>
+          using error_types = Variant<std::exception_ptr>;
+
+          static constexpr bool sends_done = sender_traits<S>::sends_done;
+
+          template <receiver R>
+          friend auto tag_invoke(connect_t, _upon_error_sender&& self, R&& r) {
+            return connect(std::move(self.s_),
+                           _upon_error_receiver<std::remove_cvref_t<R>, F>{std::forward<R>(r), std::move(self.f_)});
+          }
+
+          template <receiver R>
+          requires std::copy_constructible<S> && std::copy_constructible<F>
+          friend auto tag_invoke(connect_t, const _upon_error_sender& self, R&& r) {
+            return connect(self.s_, _upon_error_receiver<std::remove_cvref_t<R>, F>{std::forward<R>(r), self.f_});
+          }
+        };
+
+        inline constexpr struct upon_error_t {
+          template <sender S, typename F>
+          _upon_error_sender<std::remove_cvref_t<S>, std::decay_t<F>> operator()(S&& s, F&& f) const {
+            return {std::forward<S>(s), std::forward<F>(f)};
+          }
+
+          template <typename F>
+          auto operator()(F&& f) const {
+            return _adaptors::_pipeable{[f = std::forward<F>(f)]<typename S>(S&& s) mutable {
+              return upon_error_t{}(std::forward<S>(s), std::move(f));
+            }};
+          }
+        } upon_error{};
+      }  // namespace _upon_error_cpo
+
+      /////////////////////////////////////////////////////////////////////////////
+      // [execution.senders.adaptors.let_value]
+      inline namespace _let_value_cpo {
+        template <typename F, typename... As>
+        using _let_sender_t = std::invoke_result_t<F, std::decay_t<As>&...>;
+
+        template <typename F, typename R>
+        struct _let_ops {
+          template <typename... As>
+          using apply = connect_result_t<_let_sender_t<F, As...>, R>;
+        };
+
+        template <typename F, template <typename...> typename Tuple>
+        struct _let_values {
+          template <typename... As>
+          using apply = value_types_of_t<_let_sender_t<F, As...>, Tuple, _adaptors::_type_lists>;
+        };
+
+        template <typename F>
+        struct _let_errors {
+          template <typename... As>
+          using apply = error_types_of_t<_let_sender_t<F, As...>, _adaptors::_type_lists>;
+        };
+
+        template <typename F>
+        struct _let_done {
+          template <typename... As>
+          using apply = std::bool_constant<sender_traits<_let_sender_t<F, As...>>::sends_done>;
+        };
+
+        template <typename... Bs>
+        using _any_of = std::bool_constant<(Bs::value || ...)>;
+
+        template <typename S, typename R, typename F>
+        struct _let_value_op;
+
+        template <typename S, typename R, typename F>
+        struct _let_value_receiver {
+          _let_value_op<S, R, F>* op_;
+
+          template <typename... As>
+          friend void tag_invoke(set_value_t, _let_value_receiver&& self, As&&... as) noexcept {
+            self.op_->set_value(std::forward<As>(as)...);
+          }
+
+          template <typename E>
+          friend void tag_invoke(set_error_t, _let_value_receiver&& self, E&& e) noexcept {
+            set_error(std::move(self.op_->r_), std::forward<E>(e));
+          }
+
+          friend void tag_invoke(set_done_t, _let_value_receiver&& self) noexcept {
+            set_done(std::move(self.op_->r_));
+          }
+
+          friend auto tag_invoke(get_stop_token_t, const _let_value_receiver& self) noexcept {
+            return get_stop_token(self.op_->r_);
+          }
+        };
+
+        template <typename S, typename R, typename F>
+        struct _let_value_op {
+          using values_type = value_types_of_t<S, _adaptors::_decayed_tuple, _adaptors::_monostate_variant>;
+          using ops_type = value_types_of_t<S, _let_ops<F, R>::template apply, _adaptors::_monostate_variant>;
+
+          template <typename S2, typename R2>
+          _let_value_op(S2&& s, R2&& r, F f)
+            : r_(std::forward<R2>(r)), f_(std::move(f)),
+              child_op_(connect(std::forward<S2>(s), _let_value_receiver<S, R, F>{this})) {}
+
+          _let_value_op(_let_value_op&&) = delete;
+
+          template <typename... As>
+          void set_value(As&&... as) noexcept {
+            try {
+              // The values live in this op state so the successor may hold
+              // references to them.
+              auto& args = values_.template emplace<_adaptors::_decayed_tuple<As...>>(std::forward<As>(as)...);
+              using op_type = connect_result_t<_let_sender_t<F, As...>, R>;
+              auto& op = ops_.template emplace<op_type>(_adaptors::_conv{[&] {
+                return connect(std::apply(std::move(f_), args), std::move(r_));
+              }});
+              start(op);
+            } catch (...) {
+              execution::set_error(std::move(r_), std::current_exception());
+            }
+          }
+
+          friend void tag_invoke(start_t, _let_value_op& self) noexcept {
+            start(self.child_op_);
+          }
+
+          R r_;
+          F f_;
+          values_type values_;
+          ops_type ops_;
+          connect_result_t<S, _let_value_receiver<S, R, F>> child_op_;
+        };
+
+        template <typename S, typename F>
+        struct _let_value_sender {
+          S s_;
+          F f_;
+
+          template <template <typename...> typename Tuple, template <typename...> typename Variant>
+          using value_types = typename _adaptors::_apply<
+              typename _adaptors::_apply<value_types_of_t<S, _let_values<F, Tuple>::template apply,
+                                                          _adaptors::_type_lists>,
+                                         _adaptors::_concat_t>::type,
+              _adaptors::_unique_variant<Variant>::template apply>::type;
+
+          template <template <typename...> typename Variant>
+          using error_types = typename _adaptors::_apply<
+              _adaptors::_concat_t<
+                  error_types_of_t<S, _adaptors::_type_lists>,
+                  typename _adaptors::_apply<value_types_of_t<S, _let_errors<F>::template apply,
+                                                              _adaptors::_type_lists>,
+                                             _adaptors::_concat_t>::type,
+                  type_list<std::exception_ptr>>,
+              _adaptors::_unique_variant<Variant>::template apply>::type;
+
+          static constexpr bool sends_done = sender_traits<S>::sends_done ||
+              value_types_of_t<S, _let_done<F>::template apply, _any_of>::value;
+
+          template <receiver R>
+          friend auto tag_invoke(connect_t, _let_value_sender&& self, R&& r) {
+            return _let_value_op<S, std::remove_cvref_t<R>, F>(
+                std::move(self.s_), std::forward<R>(r), std::move(self.f_));
+          }
+
+          template <receiver R>
+          requires std::copy_constructible<S> && std::copy_constructible<F>
+          friend auto tag_invoke(connect_t, const _let_value_sender& self, R&& r) {
+            return _let_value_op<S, std::remove_cvref_t<R>, F>(self.s_, std::forward<R>(r), self.f_);
+          }
+        };
+
+        inline constexpr struct let_value_t {
+          template <sender S, typename F>
+          _let_value_sender<std::remove_cvref_t<S>, std::decay_t<F>> operator()(S&& s, F&& f) const {
+            return {std::forward<S>(s), std::forward<F>(f)};
+          }
+
+          template <typename F>
+          auto operator()(F&& f) const {
+            return _adaptors::_pipeable{[f = std::forward<F>(f)]<typename S>(S&& s) mutable {
+              return let_value_t{}(std::forward<S>(s), std::move(f));
+            }};
+          }
+        } let_value{};
+      }  // namespace _let_value_cpo
+
+      /////////////////////////////////////////////////////////////////////////////
+      // [execution.senders.adaptors.when_all]
+      inline namespace _when_all_cpo {
+        template <typename T>
+        using _single_t = T;
+
+        // Every child must send exactly one set of values.
+        template <typename S>
+        using _when_all_values_t = value_types_of_t<S, _adaptors::_decayed_tuple, _single_t>;
+
+        template <typename R, typename... Ss>
+        struct _when_all_op;
+
+        template <std::size_t I, typename R, typename... Ss>
+        struct _when_all_receiver {
+          _when_all_op<R, Ss...>* op_;
+
+          template <typename... As>
+          friend void tag_invoke(set_value_t, _when_all_receiver&& self, As&&... as) noexcept {
+            try {
+              std::get<I>(self.op_->values_).emplace(std::forward<As>(as)...);
+            } catch (...) {
+              self.op_->set_error(std::current_exception());
+            }
+            self.op_->arrive();
+          }
+
+          template <typename E>
+          friend void tag_invoke(set_error_t, _when_all_receiver&& self, E&& e) noexcept {
+            self.op_->set_error(std::forward<E>(e));
+            self.op_->arrive();
+          }
+
+          friend void tag_invoke(set_done_t, _when_all_receiver&& self) noexcept {
+            self.op_->set_done();
+            self.op_->arrive();
+          }
+
+          friend in_place_stop_token tag_invoke(get_stop_token_t, const _when_all_receiver& self) noexcept {
+            return self.op_->stop_source_.get_token();
+          }
+        };
+
+        template <typename R, typename... Ss>
+        struct _when_all_op {
+          using errors_type = typename _adaptors::_apply<
+              _adaptors::_concat_t<error_types_of_t<Ss, _adaptors::_type_lists>...,
+                                   type_list<std::exception_ptr>>,
+              _adaptors::_monostate_variant>::type;
+
+          template <std::size_t... Is, typename... Ss2>
+          _when_all_op(std::index_sequence<Is...>, R&& r, Ss2&&... ss)
+            : r_(std::move(r)), count_(sizeof...(Ss)), state_(running),
+              child_ops_(_adaptors::_conv{[&] {
+                return connect(std::forward<Ss2>(ss), _when_all_receiver<Is, R, Ss...>{this});
+              }}...) {}
+
+          _when_all_op(_when_all_op&&) = delete;
+
+          static const int running = 0;
+          static const int failed = 1;
+          static const int stopped = 2;
+
+          // Forwards a stop request from the receiver to the children.
+          struct _forward_stop {
+            in_place_stop_source* source_;
+            void operator()() noexcept { source_->request_stop(); }
+          };
+
+          // The first error or done wins; later ones are dropped. Either one
+          // asks the remaining children to stop.
+          template <typename E>
+          void set_error(E&& e) noexcept {
+            int expected = running;
+            if (state_.compare_exchange_strong(expected, failed)) {
+              error_.template emplace<std::decay_t<E>>(std::forward<E>(e));
+              stop_source_.request_stop();
+            }
+          }
+
+          void set_done() noexcept {
+            int expected = running;
+            if (state_.compare_exchange_strong(expected, stopped))
+              stop_source_.request_stop();
+          }
+
+          void arrive() noexcept {
+            if (count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+              complete();
+          }
+
+          void complete() noexcept {
+            on_stop_.reset();
+            switch (state_.load(std::memory_order_relaxed)) {
+            case running:
+              try {
+                std::apply(
+                    [&](auto&&... vs) { execution::set_value(std::move(r_), std::move(vs)...); },
+                    std::apply([](auto&... vs) { return std::tuple_cat(std::move(*vs)...); }, values_));
+              } catch (...) {
+                execution::set_error(std::move(r_), std::current_exception());
+              }
+              break;
+            case failed:
+              std::visit(
+                  [&](auto& e) {
+                    if constexpr (!std::is_same_v<std::decay_t<decltype(e)>, std::monostate>)
+                      execution::set_error(std::move(r_), std::move(e));
+                  },
+                  error_);
+              break;
+            default:
+              execution::set_done(std::move(r_));
+              break;
+            }
+          }
+
+          friend void tag_invoke(start_t, _when_all_op& self) noexcept {
+            if constexpr (sizeof...(Ss) == 0) {
+              self.complete();
+            } else {
+              self.on_stop_.emplace(get_stop_token(self.r_), _forward_stop{&self.stop_source_});
+              std::apply([](auto&... ops) { (start(ops), ...); }, self.child_ops_);
+            }
+          }
+
+          template <typename Seq>
+          struct _child_ops;
+
+          template <std::size_t... Is>
+          struct _child_ops<std::index_sequence<Is...>> {
+            using type = std::tuple<connect_result_t<Ss, _when_all_receiver<Is, R, Ss...>>...>;
+          };
+
+          R r_;
+          std::atomic<std::size_t> count_;
+          std::atomic<int> state_;
+          std::tuple<std::optional<_when_all_values_t<Ss>>...> values_;
+          errors_type error_;
+          in_place_stop_source stop_source_;
+          optional_stop_callback<stop_token_of_t<R>, _forward_stop> on_stop_;
+          typename _child_ops<std::index_sequence_for<Ss...>>::type child_ops_;
+        };
+
+        template <typename... Ss>
+        struct _when_all_sender {
+          std::tuple<Ss...> ss_;
+
+          template <template <typename...> typename Tuple, template <typename...> typename Variant>
+          using value_types = Variant<typename _adaptors::_apply<
+              _adaptors::_concat_t<value_types_of_t<Ss, _adaptors::_decayed_type_list, _single_t>...>, Tuple>::type>;
+
+          template <template <typename...> typename Variant>
+          using error_types = typename _adaptors::_apply<
+              _adaptors::_concat_t<error_types_of_t<Ss, _adaptors::_type_lists>...,
+                                   type_list<std::exception_ptr>>,
+              _adaptors::_unique_variant<Variant>::template apply>::type;
+
+          static constexpr bool sends_done = (sender_traits<Ss>::sends_done || ...);
+
+          template <receiver R>
+          friend auto tag_invoke(connect_t, _when_all_sender&& self, R&& r) {
+            return std::apply(
+                [&](Ss&... ss) {
+                  return _when_all_op<std::remove_cvref_t<R>, Ss...>(
+                      std::index_sequence_for<Ss...>{}, std::remove_cvref_t<R>(std::forward<R>(r)),
+                      std::move(ss)...);
+                },
+                self.ss_);
+          }
+        };
+
+        inline constexpr struct when_all_t {
+          template <typed_sender... Ss>
+          _when_all_sender<std::remove_cvref_t<Ss>...> operator()(Ss&&... ss) const {
+            return {{std::forward<Ss>(ss)...}};
+          }
+        } when_all{};
+      }  // namespace _when_all_cpo
+
+      /////////////////////////////////////////////////////////////////////////////
+      // [execution.senders.adaptors.when_any]
+      //
+      // Not part of P2300R1. Completes with whichever child finishes first,
+      // be it a value, an error or done, and asks the others to stop. The
+      // result is sent once every child has finished, so nothing outlives
+      // the operation state.
+      inline namespace _when_any_cpo {
+        template <typename Lists, template <typename...> typename Tuple,
+                  template <typename...> typename Variant>
+        struct _lists_to_variant;
+
+        template <typename... Ls, template <typename...> typename Tuple,
+                  template <typename...> typename Variant>
+        struct _lists_to_variant<type_list<Ls...>, Tuple, Variant> {
+          using type = typename _adaptors::_unique_variant<Variant>::template apply<
+              typename _adaptors::_apply<Ls, Tuple>::type...>;
+        };
+
+        // Every distinct set of values any child may send.
+        template <template <typename...> typename Tuple, template <typename...> typename Variant,
+                  typename... Ss>
+        using _when_any_values_t = typename _lists_to_variant<
+            _adaptors::_concat_t<value_types_of_t<Ss, _adaptors::_decayed_type_list, _adaptors::_type_lists>...>,
+            Tuple, Variant>::type;
+
+        template <typename R, typename... Ss>
+        struct _when_any_op;
+
+        template <std::size_t I, typename R, typename... Ss>
+        struct _when_any_receiver {
+          _when_any_op<R, Ss...>* op_;
+
+          template <typename... As>
+          friend void tag_invoke(set_value_t, _when_any_receiver&& self, As&&... as) noexcept {
+            if (self.op_->try_win(I)) {
+              try {
+                self.op_->values_.template emplace<_adaptors::_decayed_tuple<As...>>(std::forward<As>(as)...);
+              } catch (...) {
+                self.op_->error_.template emplace<std::exception_ptr>(std::current_exception());
+                self.op_->state_ = _when_any_op<R, Ss...>::failed;
+              }
+            }
+            self.op_->arrive();
+          }
+
+          template <typename E>
+          friend void tag_invoke(set_error_t, _when_any_receiver&& self, E&& e) noexcept {
+            if (self.op_->try_win(I)) {
+              self.op_->error_.template emplace<std::decay_t<E>>(std::forward<E>(e));
+              self.op_->state_ = _when_any_op<R, Ss...>::failed;
+            }
+            self.op_->arrive();
+          }
+
+          friend void tag_invoke(set_done_t, _when_any_receiver&& self) noexcept {
+            if (self.op_->try_win(I))
+              self.op_->state_ = _when_any_op<R, Ss...>::stopped;
+            self.op_->arrive();
+          }
+
+          friend in_place_stop_token tag_invoke(get_stop_token_t, const _when_any_receiver& self) noexcept {
+            return self.op_->stop_source_.get_token();
+          }
+        };
+
+        template <typename R, typename... Ss>
+        struct _when_any_op {
+          using values_type = _when_any_values_t<_adaptors::_decayed_tuple, _adaptors::_monostate_variant, Ss...>;
+          using errors_type = typename _adaptors::_apply<
+              _adaptors::_concat_t<error_types_of_t<Ss, _adaptors::_type_lists>...,
+                                   type_list<std::exception_ptr>>,
+              _adaptors::_monostate_variant>::type;
+
+          template <std::size_t... Is, typename... Ss2>
+          _when_any_op(std::index_sequence<Is...>, R&& r, Ss2&&... ss)
+            : r_(std::move(r)), count_(sizeof...(Ss)), won_(false), state_(stopped), winner_(0),
+              child_ops_(_adaptors::_conv{[&] {
+                return connect(std::forward<Ss2>(ss), _when_any_receiver<Is, R, Ss...>{this});
+              }}...) {}
+
+          _when_any_op(_when_any_op&&) = delete;
+
+          static const int succeeded = 0;
+          static const int failed = 1;
+          static const int stopped = 2;
+
+          struct _forward_stop {
+            in_place_stop_source* source_;
+            void operator()() noexcept { source_->request_stop(); }
+          };
+
+          // Index of the child that finished first. Valid once the receiver
+          // has been completed.
+          std::size_t winner() const noexcept {
+            return winner_;
+          }
+
+          // Only the first completion is kept. It asks the others to stop.
+          bool try_win(std::size_t index) noexcept {
+            if (won_.exchange(true, std::memory_order_acq_rel))
+              return false;
+            winner_ = index;
+            state_ = succeeded;
+            stop_source_.request_stop();
+            return true;
+          }
+
+          void arrive() noexcept {
+            if (count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+              complete();
+          }
+
+          void complete() noexcept {
+            on_stop_.reset();
+            switch (state_) {
+            case succeeded:
+              std::visit(
+                  [&](auto& vs) {
+                    if constexpr (!std::is_same_v<std::decay_t<decltype(vs)>, std::monostate>) {
+                      try {
+                        std::apply([&](auto&... as) { execution::set_value(std::move(r_), std::move(as)...); }, vs);
+                      } catch (...) {
+                        execution::set_error(std::move(r_), std::current_exception());
+                      }
+                    }
+                  },
+                  values_);
+              break;
+            case failed:
+              std::visit(
+                  [&](auto& e) {
+                    if constexpr (!std::is_same_v<std::decay_t<decltype(e)>, std::monostate>)
+                      execution::set_error(std::move(r_), std::move(e));
+                  },
+                  error_);
+              break;
+            default:
+              execution::set_done(std::move(r_));
+              break;
+            }
+          }
+
+          friend void tag_invoke(start_t, _when_any_op& self) noexcept {
+            if constexpr (sizeof...(Ss) == 0) {
+              self.complete();
+            } else {
+              self.on_stop_.emplace(get_stop_token(self.r_), _forward_stop{&self.stop_source_});
+              std::apply([](auto&... ops) { (start(ops), ...); }, self.child_ops_);
+            }
+          }
+
+          template <typename Seq>
+          struct _child_ops;
+
+          template <std::size_t... Is>
+          struct _child_ops<std::index_sequence<Is...>> {
+            using type = std::tuple<connect_result_t<Ss, _when_any_receiver<Is, R, Ss...>>...>;
+          };
+
+          R r_;
+          std::atomic<std::size_t> count_;
+          std::atomic<bool> won_;
+          // Written only by the winner, read after the last arrive().
+          int state_;
+          std::size_t winner_;
+          values_type values_;
+          errors_type error_;
+          in_place_stop_source stop_source_;
+          optional_stop_callback<stop_token_of_t<R>, _forward_stop> on_stop_;
+          typename _child_ops<std::index_sequence_for<Ss...>>::type child_ops_;
+        };
+
+        template <typename... Ss>
+        struct _when_any_sender {
+          std::tuple<Ss...> ss_;
+
+          template <template <typename...> typename Tuple, template <typename...> typename Variant>
+          using value_types = _when_any_values_t<Tuple, Variant, Ss...>;
+
+          template <template <typename...> typename Variant>
+          using error_types = typename _adaptors::_apply<
+              _adaptors::_concat_t<error_types_of_t<Ss, _adaptors::_type_lists>...,
+                                   type_list<std::exception_ptr>>,
+              _adaptors::_unique_variant<Variant>::template apply>::type;
+
+          // Losers are asked to stop, so any child may end the race with done.
+          static constexpr bool sends_done = true;
+
+          template <receiver R>
+          friend auto tag_invoke(connect_t, _when_any_sender&& self, R&& r) {
+            return std::apply(
+                [&](Ss&... ss) {
+                  return _when_any_op<std::remove_cvref_t<R>, Ss...>(
+                      std::index_sequence_for<Ss...>{}, std::remove_cvref_t<R>(std::forward<R>(r)),
+                      std::move(ss)...);
+                },
+                self.ss_);
+          }
+        };
+
+        inline constexpr struct when_any_t {
+          template <typed_sender... Ss>
+          _when_any_sender<std::remove_cvref_t<Ss>...> operator()(Ss&&... ss) const {
+            return {{std::forward<Ss>(ss)...}};
+          }
+        } when_any{};
+      }  // namespace _when_any_cpo
     }    // namespace execution
   }      // namespace base
 }  // namespace easio
 
-#endif
\ No newline at end of file
+#endif
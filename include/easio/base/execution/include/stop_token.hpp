@@ -0,0 +1,300 @@
+//
+// Copyright (c) 2021- Lee Goudan
+// Last Modified: 2026-10-19
+// Distributed under The MIT License (MIT) at https://mit-license.org/
+//
+
+#ifndef EASIO_BASE_EXECUTION_STOP_TOKEN_HPP
+#define EASIO_BASE_EXECUTION_STOP_TOKEN_HPP
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace easio {
+  namespace base {
+    namespace execution {
+      /////////////////////////////////////////////////////////////////////////////
+      // [stoptoken.concepts]
+      template <typename T>
+      concept stoppable_token =
+          std::copy_constructible<T> && std::equality_comparable<T> &&
+          requires(const T& token) {
+            { token.stop_requested() } noexcept -> std::convertible_to<bool>;
+            { token.stop_possible() } noexcept -> std::convertible_to<bool>;
+          };
+
+      // A token whose stop_possible() is a constant false.
+      template <typename T>
+      concept unstoppable_token = stoppable_token<T> &&
+          requires { std::bool_constant<T::stop_possible()>{}; } && !T::stop_possible();
+
+      template <typename Token, typename F>
+      struct _stop_callback_for {
+        using type = typename Token::template callback_type<F>;
+      };
+
+      template <typename F>
+      struct _stop_callback_for<std::stop_token, F> {
+        using type = std::stop_callback<F>;
+      };
+
+      template <typename Token, typename F>
+      using stop_callback_for_t = typename _stop_callback_for<Token, F>::type;
+      /////////////////////////////////////////////////////////////////////////////
+      // [stoptoken.never]
+      class never_stop_token {
+        struct _callback {
+          template <typename F>
+          explicit _callback(never_stop_token, F&&) noexcept {}
+        };
+
+      public:
+        template <typename F>
+        using callback_type = _callback;
+
+        static constexpr bool stop_requested() noexcept { return false; }
+
+        static constexpr bool stop_possible() noexcept { return false; }
+
+        friend constexpr bool operator==(never_stop_token, never_stop_token) noexcept {
+          return true;
+        }
+      };
+      /////////////////////////////////////////////////////////////////////////////
+      // [stopsource.inplace]
+      //
+      // A stop source that lives inside an operation state. Unlike
+      // std::stop_source it never allocates; callbacks are linked into a list
+      // through the callback objects themselves.
+      class in_place_stop_source;
+
+      template <typename F>
+      class in_place_stop_callback;
+
+      class _in_place_stop_callback_base {
+      public:
+        void execute() noexcept { fn_(this); }
+
+      protected:
+        using fn_type = void(_in_place_stop_callback_base*) noexcept;
+
+        _in_place_stop_callback_base(in_place_stop_source* source, fn_type* fn) noexcept
+          : source_(source), fn_(fn) {}
+
+        inline void register_callback() noexcept;
+
+        inline void unregister_callback() noexcept;
+
+      private:
+        friend class in_place_stop_source;
+
+        in_place_stop_source* source_;
+        fn_type* fn_;
+        _in_place_stop_callback_base* next_ = nullptr;
+        _in_place_stop_callback_base** prev_ = nullptr;
+        bool* removed_during_callback_ = nullptr;
+        std::atomic<bool> callback_completed_{false};
+      };
+
+      class in_place_stop_token;
+
+      class in_place_stop_source {
+      public:
+        in_place_stop_source() noexcept = default;
+
+        in_place_stop_source(in_place_stop_source&&) = delete;
+
+        inline in_place_stop_token get_token() const noexcept;
+
+        bool stop_requested() const noexcept {
+          return stop_requested_.load(std::memory_order_acquire);
+        }
+
+        // Runs every registered callback on the calling thread. Returns false
+        // if stop had already been requested.
+        bool request_stop() noexcept {
+          std::unique_lock<std::mutex> lock(mutex_);
+          if (stop_requested_.load(std::memory_order_relaxed))
+            return false;
+
+          notifying_thread_ = std::this_thread::get_id();
+          stop_requested_.store(true, std::memory_order_release);
+
+          while (callbacks_) {
+            _in_place_stop_callback_base* cb = callbacks_;
+            callbacks_ = cb->next_;
+            if (callbacks_)
+              callbacks_->prev_ = &callbacks_;
+            cb->prev_ = nullptr;
+
+            bool removed = false;
+            cb->removed_during_callback_ = &removed;
+            lock.unlock();
+
+            cb->execute();
+            if (!removed) {
+              cb->removed_during_callback_ = nullptr;
+              cb->callback_completed_.store(true, std::memory_order_release);
+            }
+
+            lock.lock();
+          }
+          return true;
+        }
+
+      private:
+        friend class _in_place_stop_callback_base;
+
+        bool try_add(_in_place_stop_callback_base* cb) noexcept {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (stop_requested_.load(std::memory_order_relaxed))
+            return false;
+
+          cb->next_ = callbacks_;
+          cb->prev_ = &callbacks_;
+          if (callbacks_)
+            callbacks_->prev_ = &cb->next_;
+          callbacks_ = cb;
+          return true;
+        }
+
+        // Once this returns the callback is not running and never will be.
+        void remove(_in_place_stop_callback_base* cb) noexcept {
+          std::unique_lock<std::mutex> lock(mutex_);
+          if (cb->prev_) {
+            *cb->prev_ = cb->next_;
+            if (cb->next_)
+              cb->next_->prev_ = cb->prev_;
+            return;
+          }
+
+          bool on_notifying_thread = notifying_thread_ == std::this_thread::get_id();
+          lock.unlock();
+
+          if (!cb->callback_completed_.load(std::memory_order_acquire)) {
+            if (on_notifying_thread) {
+              // Destroyed from inside its own callback.
+              if (cb->removed_during_callback_)
+                *cb->removed_during_callback_ = true;
+            } else {
+              while (!cb->callback_completed_.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            }
+          }
+        }
+
+        std::mutex mutex_;
+        std::atomic<bool> stop_requested_{false};
+        _in_place_stop_callback_base* callbacks_ = nullptr;
+        std::thread::id notifying_thread_;
+      };
+
+      class in_place_stop_token {
+      public:
+        template <typename F>
+        using callback_type = in_place_stop_callback<F>;
+
+        in_place_stop_token() noexcept : source_(nullptr) {}
+
+        bool stop_requested() const noexcept {
+          return source_ && source_->stop_requested();
+        }
+
+        bool stop_possible() const noexcept {
+          return source_ != nullptr;
+        }
+
+        friend bool operator==(const in_place_stop_token& a, const in_place_stop_token& b) noexcept {
+          return a.source_ == b.source_;
+        }
+
+      private:
+        friend class in_place_stop_source;
+
+        template <typename F>
+        friend class in_place_stop_callback;
+
+        explicit in_place_stop_token(const in_place_stop_source* source) noexcept
+          : source_(source) {}
+
+        const in_place_stop_source* source_;
+      };
+
+      template <typename F>
+      class in_place_stop_callback : private _in_place_stop_callback_base {
+      public:
+        template <typename C>
+        explicit in_place_stop_callback(in_place_stop_token token, C&& c)
+          : _in_place_stop_callback_base(const_cast<in_place_stop_source*>(token.source_),
+                                         &in_place_stop_callback::execute_impl),
+            f_(std::forward<C>(c)) {
+          register_callback();
+        }
+
+        in_place_stop_callback(in_place_stop_callback&&) = delete;
+
+        ~in_place_stop_callback() {
+          unregister_callback();
+        }
+
+      private:
+        static void execute_impl(_in_place_stop_callback_base* cb) noexcept {
+          std::move(static_cast<in_place_stop_callback*>(cb)->f_)();
+        }
+
+        F f_;
+      };
+
+      in_place_stop_token in_place_stop_source::get_token() const noexcept {
+        return in_place_stop_token(this);
+      }
+
+      void _in_place_stop_callback_base::register_callback() noexcept {
+        if (source_ && !source_->try_add(this)) {
+          source_ = nullptr;
+          execute();
+          callback_completed_.store(true, std::memory_order_release);
+        }
+      }
+
+      void _in_place_stop_callback_base::unregister_callback() noexcept {
+        if (source_)
+          source_->remove(this);
+      }
+
+      // Stop callback slot for an operation state. For tokens that can never
+      // be stopped it is empty and emplace() does nothing, so an op whose
+      // receiver has no stop token pays neither space nor time.
+      template <typename Token, typename F>
+      class optional_stop_callback {
+      public:
+        void emplace(const Token& token, F f) {
+          if (token.stop_possible())
+            callback_.emplace(token, std::move(f));
+        }
+
+        void reset() noexcept { callback_.reset(); }
+
+      private:
+        std::optional<stop_callback_for_t<Token, F>> callback_;
+      };
+
+      template <unstoppable_token Token, typename F>
+      class optional_stop_callback<Token, F> {
+      public:
+        void emplace(const Token&, F) noexcept {}
+
+        void reset() noexcept {}
+      };
+    }  // namespace execution
+  }    // namespace base
+}  // namespace easio
+
+#endif
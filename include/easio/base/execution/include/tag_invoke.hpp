@@ -1,6 +1,6 @@
 //
 // Copyright (c) 2021- Lee Goudan
-// Last Modified: 2021-08-25
+// Last Modified: 2026-10-19
 // Distributed under The MIT License (MIT) at https://mit-license.org/
 //
 
@@ -9,6 +9,8 @@
 #pragma once
 
 #include <concepts>
+#include <type_traits>
+#include <utility>
 
 namespace easio {
   namespace base {
@@ -19,14 +21,15 @@ namespace easio {
 
           template <typename Tag, typename... Args>
           concept has_tag_invoke = requires(Tag tag, Args&&... args) {
-            tag_invoke(std::forward(tag), std::forward(args...));
+            tag_invoke(std::move(tag), std::forward<Args>(args)...);
           };
 
           struct tag_invoke_t {
-            template <typename... Args, has_tag_invoke<Args...> Tag>
-            decltype(auto) operator()(Tag tag, Args&&... args) const
-                noexcept(noexcept(tag_invoke(std::forward(tag), std::forward(args...)))) {
-              return tag_invoke(std::forward(tag), std::forward(args...));
+            template <typename Tag, typename... Args>
+            requires has_tag_invoke<Tag, Args...>
+            constexpr decltype(auto) operator()(Tag tag, Args&&... args) const
+                noexcept(noexcept(tag_invoke(std::move(tag), std::forward<Args>(args)...))) {
+              return tag_invoke(std::move(tag), std::forward<Args>(args)...);
             }
           };
         }  // namespace impl
@@ -29,12 +29,12 @@ namespace easio {
       template <typename Service>
       friend bool has_service(execution_context &e);
 
-      execution_context();
-      ~execution_context();
+      inline execution_context();
+      inline ~execution_context();
 
     protected:
-      void shutdown();
-      void destroy();
+      inline void shutdown();
+      inline void destroy();
 
     private:
       std::shared_ptr<service_registry> service_registry_ptr_;
@@ -42,7 +42,7 @@ namespace easio {
 
     class execution_context::id : private noncopyable {
     public:
-      execution_context::id() = default;
+      id() = default;
     };
 
     class execution_context::service : private noncopyable {
@@ -72,6 +72,7 @@ namespace easio {
     template <typename Type>
     class execution_context_service : public execution_context::service {
     public:
+      using key_type = Type;
       static service_id<Type> id;
 
       execution_context_service(execution_context &e)
@@ -0,0 +1,53 @@
+#ifndef EASIO_BASE_EXECUTOR_OP_HPP
+#define EASIO_BASE_EXECUTOR_OP_HPP
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "base/operation.hpp"
+#include "base/recycling_allocator.hpp"
+#include "base/thread_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    // A posted function object. Not run if the context is destroyed first.
+    template <typename Handler>
+    class executor_op : public operation {
+    public:
+      explicit executor_op(Handler&& handler)
+        : operation(&executor_op::do_complete), handler_(std::move(handler)) {
+        set_type_name("post");
+      }
+
+    private:
+      static void do_complete(service_ptr owner, operation_ptr base,
+                              const std::error_code&, std::size_t) {
+        executor_op* op = static_cast<executor_op*>(base.get());
+        Handler handler(std::move(op->handler_));
+        base.reset();
+
+        if (owner)
+          handler();
+      }
+
+      Handler handler_;
+    };
+
+    // The op and its control block come from the executor_function_tag
+    // cache of the posting thread.
+    template <typename F>
+    operation_ptr make_executor_op(F&& f) {
+      using op_type = executor_op<std::decay_t<F>>;
+      return std::allocate_shared<op_type>(
+          recycling_allocator<op_type, thread_info::executor_function_tag>(),
+          std::decay_t<F>(std::forward<F>(f)));
+    }
+  }  // namespace base
+}  // namespace easio
+
+#endif
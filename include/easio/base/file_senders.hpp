@@ -0,0 +1,112 @@
+#ifndef EASIO_BASE_FILE_SENDERS_HPP
+#define EASIO_BASE_FILE_SENDERS_HPP
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <system_error>
+#include <type_traits>
+
+#include "base/execution/execution.hpp"
+#include "base/operation.hpp"
+#include "base/socket_senders.hpp"
+
+namespace easio {
+  namespace base {
+
+    // A file read, write or flush as a sender. Like the socket senders its
+    // operation state is the backend op, completes on a thread running the
+    // file's context and turns a receiver's stop request into set_done.
+    template <typename Service>
+    class file_sender {
+    public:
+      using implementation_type = typename Service::implementation_type;
+
+      template <template <typename...> typename Tuple, template <typename...> typename Variant>
+      using value_types = Variant<Tuple<std::size_t>>;
+
+      template <template <typename...> typename Variant>
+      using error_types = Variant<std::error_code, std::exception_ptr>;
+
+      static constexpr bool sends_done = true;
+
+      file_sender(Service& service, implementation_type& impl, file_op::op_kind kind,
+                  void* data, std::size_t size, std::uint64_t offset)
+        : service_(&service), impl_(&impl), kind_(kind), data_(data), size_(size), offset_(offset) {}
+
+      template <typename R>
+      class operation_state : public file_op {
+      public:
+        operation_state(const file_sender& s, R&& r)
+          : file_op(&operation_state::do_complete, s.kind_, s.data_, s.size_, s.offset_),
+            service_(*s.service_), impl_(*s.impl_), r_(std::move(r)) {}
+
+        operation_state(operation_state&&) = delete;
+
+        friend void tag_invoke(execution::start_t, operation_state& op) noexcept {
+          auto token = execution::get_stop_token(op.r_);
+          if (token.stop_requested()) {
+            execution::set_done(std::move(op.r_));
+            return;
+          }
+          op.on_stop_.emplace(token, cancel{&op});
+          op.service_.start_file_op(op.impl_, std::static_pointer_cast<file_op>(op.self()));
+        }
+
+      private:
+        struct cancel {
+          operation_state* op_;
+          void operator()() noexcept { op_->service_.cancel_op(op_->impl_, *op_); }
+        };
+
+        static void do_complete(service_ptr owner, operation_ptr base,
+                                const std::error_code& result, std::size_t bytes_transferred) {
+          operation_state* op = static_cast<operation_state*>(base.get());
+          base.reset();
+          op->on_stop_.reset();
+
+          std::error_code ec = Service::translate_result(result);
+          if (!owner || stopped_by_receiver(op->r_, ec)) {
+            execution::set_done(std::move(op->r_));
+          } else if (ec) {
+            execution::set_error(std::move(op->r_), ec);
+          } else {
+            try {
+              execution::set_value(std::move(op->r_), bytes_transferred);
+            } catch (...) {
+              execution::set_error(std::move(op->r_), std::current_exception());
+            }
+          }
+        }
+
+        Service& service_;
+        implementation_type& impl_;
+        R r_;
+        [[no_unique_address]] execution::optional_stop_callback<execution::stop_token_of_t<R>, cancel> on_stop_;
+      };
+
+      template <execution::receiver R>
+      friend operation_state<std::remove_cvref_t<R>> tag_invoke(
+          execution::connect_t, const file_sender& s, R&& r) {
+        return operation_state<std::remove_cvref_t<R>>(s, std::remove_cvref_t<R>(std::forward<R>(r)));
+      }
+
+      template <typename CPO>
+      friend auto tag_invoke(execution::get_completion_scheduler_t<CPO>,
+                             const file_sender& s) noexcept {
+        return s.service_->get_scheduler();
+      }
+
+    private:
+      Service* service_;
+      implementation_type* impl_;
+      file_op::op_kind kind_;
+      void* data_;
+      std::size_t size_;
+      std::uint64_t offset_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
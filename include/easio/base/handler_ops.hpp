@@ -0,0 +1,72 @@
+#ifndef EASIO_BASE_HANDLER_OPS_HPP
+#define EASIO_BASE_HANDLER_OPS_HPP
+#pragma once
+
+#include <cstddef>
+#include <system_error>
+#include <utility>
+
+#include "buffer.hpp"
+#include "base/cancellation_signal.hpp"
+#include "base/operation.hpp"
+
+namespace easio {
+  namespace base {
+
+    // A write completing to handler(ec, bytes_transferred), with what the op
+    // recorded rather than what the completion carried, since one completion
+    // may finish several queued writes. Every socket service shares it.
+    template <typename Handler>
+    class write_handler_op : public write_op {
+    public:
+      write_handler_op(const const_buffer& buffer, Handler&& handler,
+                       const cancellation_slot& slot = cancellation_slot())
+        : write_op(&write_handler_op::do_complete, buffer),
+          handler_(std::move(handler)), slot_(slot) {}
+
+    private:
+      static void do_complete(service_ptr owner, operation_ptr base,
+                              const std::error_code&, std::size_t) {
+        write_handler_op* op = static_cast<write_handler_op*>(base.get());
+        op->slot_.clear();
+        Handler handler(std::move(op->handler_));
+        std::error_code ec = op->ec_;
+        std::size_t bytes_transferred = op->bytes_transferred_;
+        base.reset();
+
+        if (owner)
+          handler(ec, bytes_transferred);
+      }
+
+      Handler handler_;
+      cancellation_slot slot_;
+    };
+
+    // A receive completing to handler(ec, bytes_transferred).
+    template <typename Handler>
+    class receive_handler_op : public receive_op {
+    public:
+      receive_handler_op(const mutable_buffer& buffer, Handler&& handler,
+                         const cancellation_slot& slot = cancellation_slot())
+        : receive_op(&receive_handler_op::do_complete, buffer),
+          handler_(std::move(handler)), slot_(slot) {}
+
+    private:
+      static void do_complete(service_ptr owner, operation_ptr base,
+                              const std::error_code& ec, std::size_t bytes_transferred) {
+        receive_handler_op* op = static_cast<receive_handler_op*>(base.get());
+        op->slot_.clear();
+        Handler handler(std::move(op->handler_));
+        base.reset();
+
+        if (owner)
+          handler(ec, bytes_transferred);
+      }
+
+      Handler handler_;
+      cancellation_slot slot_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -0,0 +1,229 @@
+#ifndef EASIO_BASE_HANDLER_TRACKING_HPP
+#define EASIO_BASE_HANDLER_TRACKING_HPP
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+#include "base/noncopyable.hpp"
+
+#if defined(EASIO_ENABLE_HANDLER_TRACKING)
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace easio {
+  namespace base {
+
+    // Per-op timeline, recorded when EASIO_ENABLE_HANDLER_TRACKING is
+    // defined: when an op is posted or issued, when its completion starts
+    // and ends, and when it is destroyed unrun, plus the time each thread
+    // spends waiting on the kernel. Each thread writes to a ring of its
+    // own, keeping the last ring_capacity events; write_chrome_trace()
+    // dumps every ring as trace-event JSON for chrome://tracing or
+    // Perfetto, with a flow arrow from each post to its completion.
+    // Without the macro every call is empty.
+    class handler_tracking {
+    public:
+#if defined(EASIO_ENABLE_HANDLER_TRACKING)
+      static const std::size_t ring_capacity = 4096;
+
+      static void post(const void* op, const char* type) noexcept {
+        record('p', op, type, 0);
+      }
+
+      static void begin(const void* op, const char* type, std::size_t bytes) noexcept {
+        record('b', op, type, bytes);
+      }
+
+      static void end(const void* op, const char* type) noexcept {
+        record('e', op, type, 0);
+      }
+
+      static void destroy(const void* op, const char* type) noexcept {
+        record('d', op, type, 0);
+      }
+
+      static void wait_begin() noexcept {
+        record('w', nullptr, "wait", 0);
+      }
+
+      static void wait_end() noexcept {
+        record('v', nullptr, "wait", 0);
+      }
+
+      // Brackets an op's completion, however it leaves.
+      class completion_scope : private noncopyable {
+      public:
+        completion_scope(const void* op, const char* type, std::size_t bytes) noexcept
+          : op_(op), type_(type) {
+          begin(op, type, bytes);
+        }
+
+        ~completion_scope() { end(op_, type_); }
+
+      private:
+        const void* op_;
+        const char* type_;
+      };
+
+      static void write_chrome_trace(std::ostream& os) {
+        os << "{\"traceEvents\":[";
+        bool first = true;
+        registry& r = registry::instance();
+        std::lock_guard<std::mutex> lock(r.mutex_);
+        for (const std::unique_ptr<ring>& g : r.rings_)
+          g->write(os, first);
+        os << "]}\n";
+      }
+
+    private:
+      // One event; seq_ is odd while the owning thread rewrites it, so a
+      // concurrent dump can skip torn entries.
+      struct event {
+        std::atomic<std::uint64_t> seq_{0};
+        std::atomic<std::int64_t> ns_{0};
+        std::atomic<const void*> op_{nullptr};
+        std::atomic<const char*> type_{nullptr};
+        std::atomic<std::uint64_t> bytes_{0};
+        std::atomic<char> phase_{0};
+      };
+
+      class ring : private noncopyable {
+      public:
+        explicit ring(std::size_t tid) : tid_(tid), head_(0), in_use_(true) {}
+
+        void push(char phase, const void* op, const char* type, std::size_t bytes) noexcept {
+          std::uint64_t n = head_.load(std::memory_order_relaxed);
+          event& e = events_[n % ring_capacity];
+          e.seq_.store(2 * n + 1, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_release);
+          e.ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+          e.op_.store(op, std::memory_order_relaxed);
+          e.type_.store(type, std::memory_order_relaxed);
+          e.bytes_.store(bytes, std::memory_order_relaxed);
+          e.phase_.store(phase, std::memory_order_relaxed);
+          e.seq_.store(2 * n + 2, std::memory_order_release);
+          head_.store(n + 1, std::memory_order_release);
+        }
+
+        void write(std::ostream& os, bool& first) const {
+          std::uint64_t head = head_.load(std::memory_order_acquire);
+          std::uint64_t n = head > ring_capacity ? head - ring_capacity : 0;
+          for (; n < head; ++n) {
+            const event& e = events_[n % ring_capacity];
+            if (e.seq_.load(std::memory_order_acquire) != 2 * n + 2)
+              continue;
+            std::int64_t ns = e.ns_.load(std::memory_order_relaxed);
+            const void* op = e.op_.load(std::memory_order_relaxed);
+            const char* type = e.type_.load(std::memory_order_relaxed);
+            std::uint64_t bytes = e.bytes_.load(std::memory_order_relaxed);
+            char phase = e.phase_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (e.seq_.load(std::memory_order_relaxed) != 2 * n + 2)
+              continue;
+            write_event(os, first, phase, ns, op, type, bytes);
+          }
+        }
+
+        std::size_t tid_;
+        std::atomic<std::uint64_t> head_;
+        std::atomic<bool> in_use_;
+
+      private:
+        void write_event(std::ostream& os, bool& first, char phase, std::int64_t ns,
+                         const void* op, const char* type, std::uint64_t bytes) const {
+          auto common = [&](const char* ph) -> std::ostream& {
+            os << (first ? "" : ",") << "\n{\"ph\":\"" << ph << "\",\"pid\":1,\"tid\":" << tid_
+               << ",\"ts\":" << ns / 1000 << '.' << (ns % 1000) / 100 << (ns % 100) / 10 << ns % 10;
+            first = false;
+            return os;
+          };
+
+          switch (phase) {
+          case 'p':
+            common("i") << ",\"s\":\"t\",\"name\":\"post " << type << "\"}";
+            common("s") << ",\"cat\":\"op\",\"name\":\"" << type << "\",\"id\":\"" << op << "\"}";
+            break;
+          case 'b':
+            common("B") << ",\"name\":\"" << type << "\",\"args\":{\"op\":\"" << op
+                        << "\",\"bytes\":" << bytes << "}}";
+            common("f") << ",\"bp\":\"e\",\"cat\":\"op\",\"name\":\"" << type << "\",\"id\":\"" << op << "\"}";
+            break;
+          case 'e':
+          case 'v':
+            common("E") << "}";
+            break;
+          case 'd':
+            common("i") << ",\"s\":\"t\",\"name\":\"destroy " << type << "\",\"args\":{\"op\":\"" << op << "\"}}";
+            break;
+          case 'w':
+            common("B") << ",\"name\":\"wait\"}";
+            break;
+          }
+        }
+
+        event events_[ring_capacity];
+      };
+
+      // Rings outlive their threads so a dump still sees them; a thread
+      // takes over the ring of one that has exited.
+      struct registry {
+        static registry& instance() {
+          static registry r;
+          return r;
+        }
+
+        ring* acquire() {
+          std::lock_guard<std::mutex> lock(mutex_);
+          for (const std::unique_ptr<ring>& g : rings_) {
+            bool expected = false;
+            if (g->in_use_.compare_exchange_strong(expected, true))
+              return g.get();
+          }
+          rings_.push_back(std::make_unique<ring>(rings_.size() + 1));
+          return rings_.back().get();
+        }
+
+        std::mutex mutex_;
+        std::vector<std::unique_ptr<ring>> rings_;
+      };
+
+      struct this_thread_ring {
+        this_thread_ring() : ring_(registry::instance().acquire()) {}
+        ~this_thread_ring() { ring_->in_use_.store(false, std::memory_order_release); }
+
+        ring* ring_;
+      };
+
+      static void record(char phase, const void* op, const char* type, std::size_t bytes) noexcept {
+        static thread_local this_thread_ring r;
+        r.ring_->push(phase, op, type, bytes);
+      }
+#else
+      class completion_scope {
+      public:
+        completion_scope(const void*, const char*, std::size_t) noexcept {}
+      };
+
+      static void post(const void*, const char*) noexcept {}
+      static void begin(const void*, const char*, std::size_t) noexcept {}
+      static void end(const void*, const char*) noexcept {}
+      static void destroy(const void*, const char*) noexcept {}
+      static void wait_begin() noexcept {}
+      static void wait_end() noexcept {}
+
+      static void write_chrome_trace(std::ostream& os) {
+        os << "{\"traceEvents\":[]}\n";
+      }
+#endif
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
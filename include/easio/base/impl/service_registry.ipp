@@ -6,7 +6,10 @@
 
 namespace easio {
 namespace base {
-service_registry::service_registry(execution_context& owner) : owner_(owner) {}
+service_registry::service_registry(execution_context& owner) : owner_(owner) {
+    for (std::size_t i = 0; i < max_service_slots; ++i)
+        slots_[i].store(nullptr, std::memory_order_relaxed);
+}
 
 void service_registry::shutdown_services() {
     context_service_ptr service_ptr = first_service_ptr_;
@@ -17,13 +20,36 @@ void service_registry::shutdown_services() {
 }
 
 void service_registry::destroy_services() {
+    for (std::size_t i = 0; i < max_service_slots; ++i)
+        slots_[i].store(nullptr, std::memory_order_release);
     while (first_service_ptr_) {
         first_service_ptr_ = first_service_ptr_->next_;
     }
 }
 
+template <typename Service>
+std::size_t service_registry::slot_index() {
+    static const std::size_t index =
+        next_slot_index_.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+void service_registry::publish(std::size_t index,
+                               execution_context::service* svc) {
+    if (index < max_service_slots)
+        slots_[index].store(svc, std::memory_order_release);
+}
+
 template <typename Service>
 Service& service_registry::use_service() {
+    // fast path: one acquire load once the service exists
+    const std::size_t index = slot_index<Service>();
+    if (index < max_service_slots) {
+        if (execution_context::service* svc =
+                slots_[index].load(std::memory_order_acquire))
+            return static_cast<Service&>(*svc);
+    }
+
     service_key key;
     init_key<Service>(key, 0);
 
@@ -31,8 +57,10 @@ Service& service_registry::use_service() {
     std::unique_lock<std::mutex> lock(mutex_);
     context_service_ptr service_ptr = first_service_ptr_;
     while (service_ptr) {
-        if (keys_match(service_ptr->key_, key))
-            return *service_ptr;
+        if (keys_match(service_ptr->key_, key)) {
+            publish(index, service_ptr.get());
+            return static_cast<Service&>(*service_ptr);
+        }
         service_ptr = service_ptr->next_;
     }
 
@@ -45,15 +73,18 @@ Service& service_registry::use_service() {
     lock.lock();
     service_ptr = first_service_ptr_;
     while (service_ptr) {
-        if (keys_match(service_ptr->key_, key))
-            return *service_ptr;
+        if (keys_match(service_ptr->key_, key)) {
+            publish(index, service_ptr.get());
+            return static_cast<Service&>(*service_ptr);
+        }
         service_ptr = service_ptr->next_;
     }
 
     // create successfully and add to registry
     new_service_ptr->next_ = first_service_ptr_;
     first_service_ptr_ = new_service_ptr;
-    return *first_service_ptr_;
+    publish(index, first_service_ptr_.get());
+    return static_cast<Service&>(*first_service_ptr_);
 }
 
 template <typename Service>
@@ -77,10 +108,16 @@ void service_registry::add_service(std::shared_ptr<Service> new_service_ptr) {
     new_service_ptr->key_ = key;
     new_service_ptr->next_ = first_service_ptr_;
     first_service_ptr_ = new_service_ptr;
+    publish(slot_index<Service>(), first_service_ptr_.get());
 }
 
 template <typename Service>
 bool service_registry::has_service() const {
+    const std::size_t index = slot_index<Service>();
+    if (index < max_service_slots &&
+        slots_[index].load(std::memory_order_acquire))
+        return true;
+
     service_key key;
     init_key<Service>(key, 0);
 
@@ -0,0 +1,25 @@
+#ifndef EASIO_BASE_IMPL_WIN_IOCP_IO_CONTEXT_IPP
+#define EASIO_BASE_IMPL_WIN_IOCP_IO_CONTEXT_IPP
+#pragma once
+
+#include "base/win_iocp_io_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    DWORD win_iocp_io_context::get_complete_status_timeout() {
+      // Bound every wait so a thread notices stop() and timer changes even
+      // if its wake-up packet was consumed by another thread.
+      return default_gqcs_timeout;
+    }
+
+    void win_iocp_io_context::update_timeout() {
+      // A thread may be blocked in GQCS with a wait computed for a later
+      // timer; wake one so it recomputes.
+      ::PostQueuedCompletionStatus(iocp_.handle, 0, wake_for_dispatch, 0);
+    }
+
+  }  // namespace base
+}  // namespace easio
+
+#endif
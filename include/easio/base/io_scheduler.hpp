@@ -0,0 +1,154 @@
+#ifndef EASIO_BASE_IO_SCHEDULER_HPP
+#define EASIO_BASE_IO_SCHEDULER_HPP
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <type_traits>
+
+#include "base/execution/execution.hpp"
+#include "base/executor_op.hpp"
+#include "base/op_queue.hpp"
+#include "base/post_priority.hpp"
+#include "base/operation.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Scheduler for a context implementation (win_iocp_io_context or
+    // scheduler). Work scheduled on it runs on whichever thread is running
+    // the context, so its forward progress guarantee is parallel.
+    template <typename Impl>
+    class io_scheduler {
+    public:
+      // Completes on a thread running the context. The operation state is
+      // the posted op itself, so scheduling allocates nothing. Completes with
+      // set_done if the context is destroyed before the op runs, or if the
+      // receiver asked to stop by then; a posted op cannot be recalled.
+      class schedule_sender {
+      public:
+        template <template <typename...> typename Tuple, template <typename...> typename Variant>
+        using value_types = Variant<Tuple<>>;
+
+        template <template <typename...> typename Variant>
+        using error_types = Variant<std::exception_ptr>;
+
+        static constexpr bool sends_done = true;
+
+        explicit schedule_sender(Impl& impl) noexcept : impl_(&impl) {}
+
+        template <typename R>
+        class operation_state : public operation {
+        public:
+          operation_state(Impl& impl, R&& r)
+            : operation(&operation_state::do_complete), impl_(impl), r_(std::move(r)) {
+            set_type_name("schedule");
+          }
+
+          operation_state(operation_state&&) = delete;
+
+          friend void tag_invoke(execution::start_t, operation_state& op) noexcept {
+            op.impl_.post_private_immediate_completion(op.self());
+          }
+
+        private:
+          static void do_complete(service_ptr owner, operation_ptr base,
+                                  const std::error_code&, std::size_t) {
+            operation_state* op = static_cast<operation_state*>(base.get());
+            base.reset();
+
+            if (!owner || execution::get_stop_token(op->r_).stop_requested()) {
+              execution::set_done(std::move(op->r_));
+            } else {
+              try {
+                execution::set_value(std::move(op->r_));
+              } catch (...) {
+                execution::set_error(std::move(op->r_), std::current_exception());
+              }
+            }
+          }
+
+          Impl& impl_;
+          R r_;
+        };
+
+        template <execution::receiver R>
+        friend operation_state<std::remove_cvref_t<R>> tag_invoke(
+            execution::connect_t, const schedule_sender& s, R&& r) {
+          return operation_state<std::remove_cvref_t<R>>(
+              *s.impl_, std::remove_cvref_t<R>(std::forward<R>(r)));
+        }
+
+        template <typename CPO>
+        friend io_scheduler tag_invoke(execution::get_completion_scheduler_t<CPO>,
+                                       const schedule_sender& s) noexcept {
+          return io_scheduler(*s.impl_);
+        }
+
+      private:
+        Impl* impl_;
+      };
+
+      explicit io_scheduler(Impl& impl) noexcept : impl_(&impl) {}
+
+      // True if the calling thread is running the context.
+      bool running_in_this_thread() const noexcept {
+        return impl_->can_dispatch();
+      }
+
+      // Runs f on a thread running the context, never inside this call.
+      template <typename F>
+      void post(F&& f) const {
+        impl_->post_private_immediate_completion(make_executor_op(std::forward<F>(f)));
+      }
+
+      // As above, in the given scheduling class.
+      template <typename F>
+      void post(F&& f, post_priority priority) const {
+        impl_->post_with_priority(make_executor_op(std::forward<F>(f)), priority);
+      }
+
+      // Posts every function object in fs, moving them out, with a single
+      // enqueue and at most one wake-up.
+      template <typename Range>
+      void post_batch(Range&& fs, post_priority priority = post_priority::normal) const {
+        op_queue ops;
+        for (auto& f : fs)
+          ops.push(make_executor_op(std::move(f)));
+        impl_->post_batch(ops, priority);
+      }
+
+      // Runs f inside this call if the calling thread is running the
+      // context, otherwise as post() does. Inline runs allocate nothing.
+      template <typename F>
+      void dispatch(F&& f) const {
+        std::decay_t<F> tmp(std::forward<F>(f));
+        if (!impl_->dispatch_inline(tmp))
+          impl_->post_private_immediate_completion(make_executor_op(std::move(tmp)));
+      }
+
+      friend schedule_sender tag_invoke(execution::schedule_t, const io_scheduler& s) noexcept {
+        return schedule_sender(*s.impl_);
+      }
+
+      friend execution::forward_progress_guarantee tag_invoke(
+          execution::get_forward_progress_guarantee_t, const io_scheduler&) noexcept {
+        return execution::forward_progress_guarantee::parallel;
+      }
+
+      friend bool operator==(const io_scheduler& a, const io_scheduler& b) noexcept {
+        return a.impl_ == b.impl_;
+      }
+
+      friend bool operator!=(const io_scheduler& a, const io_scheduler& b) noexcept {
+        return a.impl_ != b.impl_;
+      }
+
+    private:
+      Impl* impl_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
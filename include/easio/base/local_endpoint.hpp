@@ -0,0 +1,74 @@
+#ifndef EASIO_BASE_LOCAL_ENDPOINT_HPP
+#define EASIO_BASE_LOCAL_ENDPOINT_HPP
+#pragma once
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace easio {
+  namespace base {
+
+    // A Unix domain socket address. A path that starts with '\0' names
+    // the abstract namespace: nothing is created in the file system and
+    // the name goes away with the last socket bound to it.
+    template <typename Protocol>
+    class local_endpoint {
+    public:
+      using protocol_type = Protocol;
+
+      local_endpoint() noexcept : data_(), path_length_(0) {
+        data_.sun_family = AF_UNIX;
+      }
+
+      // Throws std::errc::filename_too_long if path does not fit.
+      local_endpoint(std::string_view path) : data_(), path_length_(0) {
+        data_.sun_family = AF_UNIX;
+        if (path.size() > sizeof(data_.sun_path) - 1)
+          throw std::make_error_code(std::errc::filename_too_long);
+        std::memcpy(data_.sun_path, path.data(), path.size());
+        path_length_ = path.size();
+      }
+
+      protocol_type protocol() const noexcept {
+        return protocol_type();
+      }
+
+      std::string path() const {
+        return std::string(data_.sun_path, path_length_);
+      }
+
+      bool is_abstract() const noexcept {
+        return path_length_ > 0 && data_.sun_path[0] == '\0';
+      }
+
+      sockaddr* data() noexcept { return reinterpret_cast<sockaddr*>(&data_); }
+
+      const sockaddr* data() const noexcept { return reinterpret_cast<const sockaddr*>(&data_); }
+
+      // A file system path is passed with its terminating '\0'; an abstract
+      // name is exactly its bytes.
+      std::size_t size() const noexcept {
+        return offsetof(sockaddr_un, sun_path) + path_length_ + (is_abstract() ? 0 : 1);
+      }
+
+      std::size_t capacity() const noexcept { return sizeof(data_); }
+
+    private:
+      sockaddr_un data_;
+      std::size_t path_length_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
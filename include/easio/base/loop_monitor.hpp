@@ -0,0 +1,118 @@
+#ifndef EASIO_BASE_LOOP_MONITOR_HPP
+#define EASIO_BASE_LOOP_MONITOR_HPP
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "base/noncopyable.hpp"
+
+namespace easio {
+  namespace base {
+
+    // What one thread inside run() is doing, for a watchdog to sample. The
+    // owning thread bumps the heartbeat each time round the loop and when
+    // a handler starts, and names the running op while it runs. It never
+    // reads the clock; a watchdog that sees the same heartbeat with a
+    // handler running on two samples knows the handler has run at least
+    // that long.
+    class alignas(64) loop_monitor : private noncopyable {
+    public:
+      void beat() noexcept {
+        heartbeat_.store(heartbeat_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+
+      void enter(const char* op_type) noexcept {
+        beat();
+        running_.store(op_type, std::memory_order_release);
+      }
+
+      void leave() noexcept {
+        running_.store(nullptr, std::memory_order_release);
+      }
+
+      std::uint64_t heartbeat() const noexcept {
+        return heartbeat_.load(std::memory_order_relaxed);
+      }
+
+      // The running op's type, or null between handlers.
+      const char* running() const noexcept {
+        return running_.load(std::memory_order_acquire);
+      }
+
+      // The native id of the thread that owns the monitor.
+      unsigned long thread_id() const noexcept {
+        return thread_id_.load(std::memory_order_relaxed);
+      }
+
+      bool in_use() const noexcept {
+        return in_use_.load(std::memory_order_acquire);
+      }
+
+    private:
+      friend class loop_registry;
+
+      std::atomic<std::uint64_t> heartbeat_{0};
+      std::atomic<const char*> running_{nullptr};
+      std::atomic<unsigned long> thread_id_{0};
+      std::atomic<bool> in_use_{false};
+    };
+
+    // A context's monitors, one per thread inside run(). Threads beyond
+    // max_loops go unmonitored.
+    class loop_registry : private noncopyable {
+    public:
+      static const std::size_t max_loops = 64;
+
+      loop_monitor* acquire(unsigned long thread_id) noexcept {
+        for (loop_monitor& m : loops_) {
+          bool expected = false;
+          if (!m.in_use_.load(std::memory_order_relaxed) &&
+              m.in_use_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            m.running_.store(nullptr, std::memory_order_relaxed);
+            m.thread_id_.store(thread_id, std::memory_order_relaxed);
+            m.beat();
+            return &m;
+          }
+        }
+        return nullptr;
+      }
+
+      void release(loop_monitor* m) noexcept {
+        if (m)
+          m->in_use_.store(false, std::memory_order_release);
+      }
+
+      std::size_t size() const noexcept {
+        return max_loops;
+      }
+
+      const loop_monitor& operator[](std::size_t i) const noexcept {
+        return loops_[i];
+      }
+
+    private:
+      loop_monitor loops_[max_loops];
+    };
+
+    // Names the running op on a thread's monitor, if it has one.
+    class loop_monitor_scope : private noncopyable {
+    public:
+      loop_monitor_scope(loop_monitor* m, const char* op_type) noexcept : m_(m) {
+        if (m_)
+          m_->enter(op_type);
+      }
+
+      ~loop_monitor_scope() {
+        if (m_)
+          m_->leave();
+      }
+
+    private:
+      loop_monitor* m_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef EASIO_BASE_MEMORY_SOCKET_SERVICE_HPP
+#define EASIO_BASE_MEMORY_SOCKET_SERVICE_HPP
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "buffer.hpp"
+#include "base/execution_context.hpp"
+#include "base/handler_ops.hpp"
+#include "base/io_scheduler.hpp"
+#include "base/operation.hpp"
+#include "base/pending_ops.hpp"
+#include "base/socket_ops.hpp"
+#include "base/win_iocp_io_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Sockets connected by in-process ring buffers instead of the network.
+    // Every completion is produced by the context itself, from the private
+    // queue when the peer runs on the same thread, so a memory connection
+    // exercises the whole op and queue path without a system call.
+    class memory_socket_service
+      : public execution_context_service<memory_socket_service> {
+    public:
+      static const std::size_t default_capacity = 64 * 1024;
+
+      // One direction of a connection. Writes wait for room in the ring and
+      // reads for bytes in it, each in the order they were started.
+      struct pipe {
+        std::vector<char> ring_;
+        std::size_t head_ = 0;
+        std::size_t size_ = 0;
+        std::deque<receive_op_ptr> readers_;
+        std::deque<write_op_ptr> writers_;
+        // The writing end is gone: readers see end of file once the ring
+        // is drained.
+        bool write_closed_ = false;
+        // The reading end is gone: writes fail.
+        bool read_closed_ = false;
+
+        std::size_t put(const char* data, std::size_t n) {
+          n = std::min(n, ring_.size() - size_);
+          std::size_t tail = (head_ + size_) % ring_.size();
+          std::size_t first = std::min(n, ring_.size() - tail);
+          std::memcpy(ring_.data() + tail, data, first);
+          std::memcpy(ring_.data(), data + first, n - first);
+          size_ += n;
+          return n;
+        }
+
+        std::size_t get(char* data, std::size_t n) {
+          n = std::min(n, size_);
+          std::size_t first = std::min(n, ring_.size() - head_);
+          std::memcpy(data, ring_.data() + head_, first);
+          std::memcpy(data + first, ring_.data(), n - first);
+          head_ = (head_ + n) % ring_.size();
+          size_ -= n;
+          return n;
+        }
+      };
+
+      // What the two ends of a connection share. Ends are numbered 0 and
+      // 1; end i reads pipes_[i] and writes pipes_[1 - i], and each end's
+      // ops complete on the context of the socket that started them.
+      struct channel {
+        std::mutex mutex_;
+        pipe pipes_[2];
+        win_iocp_io_context* contexts_[2] = {nullptr, nullptr};
+      };
+
+      struct implementation_type {
+        std::shared_ptr<channel> channel_;
+        int end_ = 0;
+      };
+
+      inline memory_socket_service(execution_context& ctx)
+        : execution_context_service<memory_socket_service>(ctx),
+          iocp_service_(use_service<win_iocp_io_context>(ctx)) {}
+
+      inline void shutdown() {}
+
+      io_scheduler<win_iocp_io_context> get_scheduler() const noexcept {
+        return io_scheduler<win_iocp_io_context>(iocp_service_);
+      }
+
+      inline void construct(implementation_type& impl) {
+        impl.channel_.reset();
+        impl.end_ = 0;
+      }
+
+      inline void move_construct(implementation_type& impl, implementation_type& other) {
+        impl.channel_ = std::move(other.channel_);
+        impl.end_ = other.end_;
+      }
+
+      inline bool is_open(const implementation_type& impl) const {
+        return impl.channel_ != nullptr;
+      }
+
+      // Connects two closed sockets to each other, each direction buffering
+      // up to capacity bytes. b's service may belong to another context.
+      inline void connect_pair(implementation_type& a, memory_socket_service& b_service,
+                               implementation_type& b, std::size_t capacity, std::error_code& ec) {
+        if (is_open(a) || b_service.is_open(b)) {
+          ec = std::make_error_code(std::errc::already_connected);
+          return;
+        }
+        if (capacity == 0) {
+          ec = std::make_error_code(std::errc::invalid_argument);
+          return;
+        }
+
+        std::shared_ptr<channel> c = std::make_shared<channel>();
+        c->pipes_[0].ring_.resize(capacity);
+        c->pipes_[1].ring_.resize(capacity);
+        c->contexts_[0] = &iocp_service_;
+        c->contexts_[1] = &b_service.iocp_service_;
+        a.channel_ = c;
+        a.end_ = 0;
+        b.channel_ = std::move(c);
+        b.end_ = 1;
+        ec = std::error_code();
+      }
+
+      // Fails this end's pending ops with operation_aborted. The peer's
+      // reads see end of file once they have drained what was written, and
+      // its writes fail with broken_pipe.
+      inline void close(implementation_type& impl, std::error_code& ec) {
+        ec = std::error_code();
+        if (!is_open(impl))
+          return;
+
+        channel& c = *impl.channel_;
+        {
+          std::lock_guard<std::mutex> lock(c.mutex_);
+          pipe& in = c.pipes_[impl.end_];
+          pipe& out = c.pipes_[1 - impl.end_];
+          win_iocp_io_context* own = c.contexts_[impl.end_];
+          win_iocp_io_context* peer = c.contexts_[1 - impl.end_];
+
+          in.read_closed_ = true;
+          fail_pending(*own, in.readers_, socket_ops::operation_aborted());
+          fail_pending(*peer, in.writers_, std::make_error_code(std::errc::broken_pipe));
+
+          out.write_closed_ = true;
+          fail_pending(*own, out.writers_, socket_ops::operation_aborted());
+          pump(out, *peer, *own);
+        }
+        impl.channel_.reset();
+      }
+
+      template <typename Handler>
+      void async_receive(implementation_type& impl, const mutable_buffer& buffer, Handler&& handler) {
+        using op_type = receive_handler_op<std::decay_t<Handler>>;
+        start_receive_op(impl, std::make_shared<op_type>(
+            buffer, std::decay_t<Handler>(std::forward<Handler>(handler))));
+      }
+
+      template <typename Handler>
+      void async_send(implementation_type& impl, const const_buffer& buffer, Handler&& handler) {
+        using op_type = write_handler_op<std::decay_t<Handler>>;
+        start_send_op(impl, std::make_shared<op_type>(
+            buffer, std::decay_t<Handler>(std::forward<Handler>(handler))));
+      }
+
+      // Completes with what the ring holds, up to the buffer's size, or
+      // waits for the peer to write.
+      inline void start_receive_op(implementation_type& impl, receive_op_ptr op) {
+        if (!start_pending(iocp_service_, op, is_open(impl)))
+          return;
+
+        channel& c = *impl.channel_;
+        std::lock_guard<std::mutex> lock(c.mutex_);
+        pipe& in = c.pipes_[impl.end_];
+        in.readers_.push_back(std::move(op));
+        pump(in, *c.contexts_[impl.end_], *c.contexts_[1 - impl.end_]);
+      }
+
+      // Completes once the whole buffer is in the peer's ring.
+      inline void start_send_op(implementation_type& impl, write_op_ptr op) {
+        if (!start_pending(iocp_service_, op, is_open(impl)))
+          return;
+
+        channel& c = *impl.channel_;
+        std::lock_guard<std::mutex> lock(c.mutex_);
+        pipe& out = c.pipes_[1 - impl.end_];
+        if (out.read_closed_) {
+          complete_write(iocp_service_, std::move(op), std::make_error_code(std::errc::broken_pipe));
+          return;
+        }
+        out.writers_.push_back(std::move(op));
+        pump(out, *c.contexts_[1 - impl.end_], *c.contexts_[impl.end_]);
+      }
+
+      inline void cancel_op(implementation_type& impl, operation& op) {
+        if (!is_open(impl))
+          return;
+
+        channel& c = *impl.channel_;
+        std::lock_guard<std::mutex> lock(c.mutex_);
+        cancel_pending(*c.contexts_[impl.end_], c.pipes_[impl.end_].readers_, op);
+      }
+
+      // A write that is partly in the ring fails with what it got there.
+      inline void cancel_send_op(implementation_type& impl, write_op& op) {
+        if (!is_open(impl))
+          return;
+
+        channel& c = *impl.channel_;
+        std::lock_guard<std::mutex> lock(c.mutex_);
+        cancel_pending(*c.contexts_[impl.end_], c.pipes_[1 - impl.end_].writers_, op);
+      }
+
+    private:
+      // Moves bytes from waiting writers through the ring to waiting
+      // readers until neither can make progress. Called with the channel
+      // locked; readers complete on reader_ctx and writers on writer_ctx.
+      static void pump(pipe& p, win_iocp_io_context& reader_ctx, win_iocp_io_context& writer_ctx) {
+        for (;;) {
+          bool progress = false;
+
+          while (!p.writers_.empty() && p.size_ < p.ring_.size()) {
+            write_op& w = *p.writers_.front();
+            std::size_t n = p.put(static_cast<const char*>(w.buffer_.data()), w.buffer_.size());
+            w.buffer_ = const_buffer(static_cast<const char*>(w.buffer_.data()) + n, w.buffer_.size() - n);
+            w.bytes_transferred_ += n;
+            progress = progress || n > 0;
+            if (w.buffer_.size() > 0)
+              break;
+            complete_write(writer_ctx, pop_pending(p.writers_), std::error_code());
+            progress = true;
+          }
+
+          while (!p.readers_.empty() && (p.size_ > 0 || p.write_closed_ ||
+                                         p.readers_.front()->buffer_.size() == 0)) {
+            receive_op_ptr op = pop_pending(p.readers_);
+            std::size_t n = p.get(static_cast<char*>(op->buffer_.data()), op->buffer_.size());
+            complete_receive(reader_ctx, std::move(op), std::error_code(), n);
+            progress = true;
+          }
+
+          if (!progress)
+            return;
+        }
+      }
+
+      win_iocp_io_context& iocp_service_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
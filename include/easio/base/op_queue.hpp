@@ -0,0 +1,82 @@
+#ifndef EASIO_BASE_OP_QUEUE_HPP
+#define EASIO_BASE_OP_QUEUE_HPP
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "base/noncopyable.hpp"
+#include "base/operation.hpp"
+
+namespace easio {
+  namespace base {
+
+    // A FIFO of ops linked through their next_ member, so pushing one op or
+    // splicing in a whole queue allocates nothing. The queue owns the first
+    // op and each op owns the one after it.
+    class op_queue : private noncopyable {
+    public:
+      op_queue() = default;
+
+      // Unlinks the ops one at a time; letting the chain go at once would
+      // destroy it recursively.
+      ~op_queue() {
+        while (head_)
+          pop();
+      }
+
+      bool empty() const noexcept {
+        return !head_;
+      }
+
+      std::size_t size() const noexcept {
+        return size_;
+      }
+
+      void push(operation_ptr op) {
+        operation* last = op.get();
+        if (tail_)
+          tail_->next_ = std::move(op);
+        else
+          head_ = std::move(op);
+        tail_ = last;
+        ++size_;
+      }
+
+      // Moves every op in other to the back of this queue.
+      void push(op_queue& other) {
+        if (!other.head_)
+          return;
+        if (tail_)
+          tail_->next_ = std::move(other.head_);
+        else
+          head_ = std::move(other.head_);
+        tail_ = std::exchange(other.tail_, nullptr);
+        size_ += std::exchange(other.size_, 0);
+      }
+
+      operation_ptr pop() {
+        operation_ptr op = std::move(head_);
+        head_ = std::move(op->next_);
+        if (!head_)
+          tail_ = nullptr;
+        --size_;
+        return op;
+      }
+
+      // Calls f(op) for each op, front to back.
+      template <typename F>
+      void for_each(F f) const {
+        for (operation* op = head_.get(); op; op = op->next_.get())
+          f(*op);
+      }
+
+    private:
+      operation_ptr head_;
+      operation* tail_ = nullptr;
+      std::size_t size_ = 0;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
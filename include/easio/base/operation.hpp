@@ -2,10 +2,18 @@
 #define EASIO_BASE_WIN_IOCP_OPERATION_HPP
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <system_error>
 
+#include "buffer.hpp"
+#include "base/handler_tracking.hpp"
+#include "base/socket_ops.hpp"
+
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -27,11 +35,27 @@ namespace easio {
 
       void complete(service_ptr owner, const std::error_code& ec,
                     std::size_t bytes_transferred) {
-        func_(owner, shared_from_this(), ec, bytes_transferred);
+        handler_tracking::completion_scope scope(this, type_name(), bytes_transferred);
+        (void)scope;
+        func_(owner, self(), ec, bytes_transferred);
       }
 
       void destroy() {
-        func_(nullptr, shared_from_this(), std::error_code(), 0);
+        handler_tracking::destroy(this, type_name());
+        func_(nullptr, self(), std::error_code(), 0);
+      }
+
+      // What kind of op this is, for handler tracking and the watchdog.
+      const char* type_name() const noexcept {
+        return type_name_;
+      }
+
+      // Ops embedded in another object have no shared_ptr of their own, so
+      // hand out a non-owning one. The aliasing constructor never allocates.
+      operation_ptr self() {
+        if (operation_ptr p = weak_from_this().lock())
+          return p;
+        return operation_ptr(operation_ptr(), this);
       }
 
     protected:
@@ -43,6 +67,10 @@ namespace easio {
         reset();
       }
 
+      void set_type_name(const char* type) noexcept {
+        type_name_ = type;
+      }
+
       // Prevents deletion through this type.
       //~win_iocp_operation() {
       //}
@@ -54,13 +82,30 @@ namespace easio {
         OffsetHigh = 0;
         hEvent = 0;
         ready_ = 0;
+        cancel_requested_ = 0;
+        io_handle_ = 0;
       }
 
     private:
       friend class win_iocp_io_context;
+      friend class win_iocp_socket_service;
+      friend class win_iocp_file_service;
+      friend class op_queue;
       operation_ptr next_;
+      // Holds the op alive while its OVERLAPPED is owned by the kernel.
+      operation_ptr keep_alive_;
       func_type func_;
       long ready_;
+      // Set by a cancellation that may race with the op being issued; the
+      // initiating call checks it once the op is with the kernel.
+      long cancel_requested_;
+      // The handle the op was issued on, published once it is with the
+      // kernel, so a cancellation never reads the socket or file object.
+      void* io_handle_;
+      // Set when the op was queued with its result already in the
+      // OVERLAPPED; see win_iocp_io_context::post_private_completion().
+      bool has_result_ = false;
+      const char* type_name_ = "operation";
     };
 
     using operation = win_iocp_operation;
@@ -76,12 +121,27 @@ namespace easio {
       void complete(service_ptr owner, const std::error_code& ec,
           std::size_t bytes_transferred)
       {
-        func_(owner, shared_from_this(), ec, bytes_transferred);
+        handler_tracking::completion_scope scope(this, type_name(), bytes_transferred);
+        (void)scope;
+        func_(owner, self(), ec, bytes_transferred);
       }
 
       void destroy()
       {
-        func_(0, shared_from_this(), std::error_code(), 0);
+        handler_tracking::destroy(this, type_name());
+        func_(0, self(), std::error_code(), 0);
+      }
+
+      const char* type_name() const noexcept
+      {
+        return type_name_;
+      }
+
+      operation_ptr self()
+      {
+        if (operation_ptr p = weak_from_this().lock())
+          return p;
+        return operation_ptr(operation_ptr(), this);
       }
 
     protected:
@@ -94,6 +154,11 @@ namespace easio {
       {
       }
 
+      void set_type_name(const char* type) noexcept
+      {
+        type_name_ = type;
+      }
+
       // Prevents deletion through this type.
       //~scheduler_operation()
       //{
@@ -101,9 +166,11 @@ namespace easio {
 
     private:
       friend class scheduler;
+      friend class op_queue;
       operation_ptr next_;
       func_type func_;
       unsigned int task_result_; // Passed into bytes transferred.
+      const char* type_name_ = "operation";
     };
 
     using operation = scheduler_operation;
@@ -116,18 +183,133 @@ namespace easio {
       std::error_code ec_;
 
     protected:
-      resolve_op(func_type complete_func) : operation(complete_func) {}
+      resolve_op(func_type complete_func) : operation(complete_func) {
+        set_type_name("resolve");
+      }
     };
     using resolve_op_ptr = std::shared_ptr<resolve_op>;
 
+    class timer_queue;
+
     class wait_op
       : public operation {
     public:
       std::error_code ec_;
     protected:
-      wait_op(func_type func) : operation(func) {}
+      wait_op(func_type func) : operation(func) {
+        set_type_name("wait");
+      }
+
+    private:
+      friend class timer_queue;
+      using queue_type = std::multimap<std::chrono::steady_clock::time_point, std::shared_ptr<wait_op>>;
+
+      // Set while a timer_queue holds the wait, so it can be taken out
+      // without searching: its place in the queue and its neighbours among
+      // the waits of the same timer.
+      queue_type::iterator queue_pos_;
+      const void* queued_timer_ = nullptr;
+      wait_op* prev_timer_wait_ = nullptr;
+      wait_op* next_timer_wait_ = nullptr;
+      bool queued_ = false;
     };
     using wait_op_ptr = std::shared_ptr<wait_op>;
+
+    class write_queue;
+
+    class write_op
+      : public operation {
+    public:
+      // What is left to send; advanced as partial sends complete.
+      const_buffer buffer_;
+      std::size_t bytes_transferred_;
+      std::error_code ec_;
+    protected:
+      write_op(func_type func, const const_buffer& buffer)
+        : operation(func), buffer_(buffer), bytes_transferred_(0) {
+        set_type_name("send");
+      }
+
+    private:
+      friend class win_iocp_socket_service;
+      // The queue the write joined. Set once, before queue_published_, so a
+      // cancellation on another thread can reach it without the socket.
+      std::shared_ptr<write_queue> queue_;
+      std::atomic<bool> queue_published_{false};
+    };
+    using write_op_ptr = std::shared_ptr<write_op>;
+
+    class receive_op
+      : public operation {
+    public:
+      mutable_buffer buffer_;
+    protected:
+      receive_op(func_type func, const mutable_buffer& buffer)
+        : operation(func), buffer_(buffer) {
+        set_type_name("receive");
+      }
+    };
+    using receive_op_ptr = std::shared_ptr<receive_op>;
+
+    // A read, write or flush of a file at an offset. Reads and writes go
+    // to the kernel through the OVERLAPPED, which carries the offset.
+    class file_op
+      : public operation {
+    public:
+      enum op_kind { read, write, sync };
+
+      op_kind kind_;
+      void* data_;
+      std::size_t size_;
+      std::uint64_t offset_;
+    protected:
+      file_op(func_type func, op_kind kind, void* data, std::size_t size, std::uint64_t offset)
+        : operation(func), kind_(kind), data_(data), size_(size), offset_(offset) {
+        set_type_name(kind == read ? "file_read" : kind == write ? "file_write" : "file_sync");
+      }
+    };
+    using file_op_ptr = std::shared_ptr<file_op>;
+
+    class connect_op
+      : public operation {
+    protected:
+      connect_op(func_type func) : operation(func) {
+        set_type_name("connect");
+      }
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+      ~connect_op() {
+        if (event_)
+          ::CloseHandle(event_);
+      }
+
+    private:
+      friend class win_iocp_socket_service;
+      // A local connect that did not finish at once waits for its
+      // FD_CONNECT event instead of the port; see
+      // win_iocp_socket_service::start_local_connect(). The event is closed
+      // with the op, so a cancellation may set it until then.
+      void* event_ = nullptr;
+      bool waited_ = false;
+#endif
+    };
+    using connect_op_ptr = std::shared_ptr<connect_op>;
+
+    class accept_op
+      : public operation {
+    public:
+      static const std::size_t address_length = sizeof(sockaddr_storage) + 16;
+
+      socket_ops::socket_type new_socket_;
+      // Receives the local and remote addresses of the accepted connection.
+      unsigned char addresses_[address_length * 2];
+    protected:
+      accept_op(func_type func)
+        : operation(func), new_socket_(socket_ops::invalid_socket) {
+        set_type_name("accept");
+      }
+    };
+    using accept_op_ptr = std::shared_ptr<accept_op>;
   
   }  // namespace base
 }  // namespace easio
@@ -0,0 +1,64 @@
+#ifndef EASIO_BASE_PACKET_TIMESTAMP_HPP
+#define EASIO_BASE_PACKET_TIMESTAMP_HPP
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include <windows.h>
+#endif
+
+namespace easio {
+  namespace base {
+
+    // When the network stack saw a datagram arrive or leave, on the
+    // steady_clock, so that steady_clock::now() minus it is the time the
+    // datagram spent between the kernel and the handler. Empty when the
+    // stack gave no timestamp, e.g. because timestamping is off.
+    struct packet_timestamp {
+      using clock = std::chrono::steady_clock;
+
+      clock::time_point time;
+
+      explicit operator bool() const noexcept {
+        return time != clock::time_point();
+      }
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+      // Windows stamps packets with QueryPerformanceCounter ticks, which
+      // is also what steady_clock counts.
+      static packet_timestamp from_performance_counter(std::uint64_t ticks) noexcept {
+        static const std::uint64_t frequency = [] {
+          LARGE_INTEGER f;
+          ::QueryPerformanceFrequency(&f);
+          return static_cast<std::uint64_t>(f.QuadPart);
+        }();
+
+        packet_timestamp ts;
+        if (ticks == 0 || frequency == 0)
+          return ts;
+        std::uint64_t ns = ticks / frequency * 1000000000ull +
+                           ticks % frequency * 1000000000ull / frequency;
+        ts.time = clock::time_point(std::chrono::duration_cast<clock::duration>(
+            std::chrono::nanoseconds(ns)));
+        return ts;
+      }
+#endif
+    };
+
+    // Names a datagram sent with timestamping on, so that the time it left
+    // can be looked up once the stack has stamped it, which may be after
+    // the send completes. Empty when the stack gave the datagram no id.
+    struct transmit_id {
+      std::uint32_t value = 0;
+      bool valid = false;
+
+      explicit operator bool() const noexcept {
+        return valid;
+      }
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
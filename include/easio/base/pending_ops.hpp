@@ -0,0 +1,89 @@
+#ifndef EASIO_BASE_PENDING_OPS_HPP
+#define EASIO_BASE_PENDING_OPS_HPP
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+#include "base/handler_tracking.hpp"
+#include "base/operation.hpp"
+#include "base/socket_ops.hpp"
+#include "base/win_iocp_io_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Helpers for the in-process transports (memory sockets and shared
+    // memory channels), whose receives and writes wait in deques under the
+    // transport's lock and complete through a context's private queue.
+
+    template <typename Op>
+    Op pop_pending(std::deque<Op>& q) {
+      Op op = std::move(q.front());
+      q.pop_front();
+      return op;
+    }
+
+    inline void complete_receive(win_iocp_io_context& ctx, receive_op_ptr op,
+                                 const std::error_code& ec, std::size_t bytes_transferred) {
+      ctx.post_private_completion(std::move(op), ec, bytes_transferred);
+    }
+
+    // Completes with what the write has transferred so far.
+    inline void complete_write(win_iocp_io_context& ctx, write_op_ptr op,
+                               const std::error_code& ec) {
+      op->ec_ = ec;
+      std::size_t bytes_transferred = op->bytes_transferred_;
+      ctx.post_private_completion(std::move(op), ec, bytes_transferred);
+    }
+
+    inline void complete_pending(win_iocp_io_context& ctx, receive_op_ptr op,
+                                 const std::error_code& ec) {
+      complete_receive(ctx, std::move(op), ec, 0);
+    }
+
+    inline void complete_pending(win_iocp_io_context& ctx, write_op_ptr op,
+                                 const std::error_code& ec) {
+      complete_write(ctx, std::move(op), ec);
+    }
+
+    // Counts the op as work on ctx. Fails it with bad_file_descriptor and
+    // returns false if the transport is not open.
+    template <typename Op>
+    bool start_pending(win_iocp_io_context& ctx, std::shared_ptr<Op>& op, bool open) {
+      ctx.work_started();
+      handler_tracking::post(op.get(), op->type_name());
+      if (open)
+        return true;
+      complete_pending(ctx, std::move(op), std::make_error_code(std::errc::bad_file_descriptor));
+      return false;
+    }
+
+    // Fails every op in q with ec.
+    template <typename Op>
+    void fail_pending(win_iocp_io_context& ctx, std::deque<Op>& q, const std::error_code& ec) {
+      while (!q.empty())
+        complete_pending(ctx, pop_pending(q), ec);
+    }
+
+    // Takes op out of q, if it is still there, and fails it with
+    // operation_aborted. A write keeps what it transferred before.
+    template <typename Op>
+    bool cancel_pending(win_iocp_io_context& ctx, std::deque<Op>& q, const operation& op) {
+      for (auto i = q.begin(); i != q.end(); ++i) {
+        if (i->get() == &op) {
+          Op p = std::move(*i);
+          q.erase(i);
+          complete_pending(ctx, std::move(p), socket_ops::operation_aborted());
+          return true;
+        }
+      }
+      return false;
+    }
+  }  // namespace base
+}  // namespace easio
+
+#endif
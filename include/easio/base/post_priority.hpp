@@ -0,0 +1,19 @@
+#ifndef EASIO_BASE_POST_PRIORITY_HPP
+#define EASIO_BASE_POST_PRIORITY_HPP
+#pragma once
+
+namespace easio {
+  namespace base {
+
+    // Scheduling class of a posted handler. Latency-critical handlers run
+    // ahead of I/O completions and normal posts; bulk handlers run when
+    // nothing else is ready. Both are subject to a starvation bound.
+    enum class post_priority {
+      latency_critical,
+      normal,
+      bulk
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
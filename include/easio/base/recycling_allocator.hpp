@@ -0,0 +1,52 @@
+#ifndef EASIO_BASE_RECYCLING_ALLOCATOR_HPP
+#define EASIO_BASE_RECYCLING_ALLOCATOR_HPP
+#pragma once
+
+#include <cstddef>
+
+#include "base/thread_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Standard allocator over the current thread's thread_info cache, e.g.
+    // for std::allocate_shared. Purpose picks the cache slots.
+    template <typename T, purpose Purpose = thread_info::default_tag>
+    class recycling_allocator {
+    public:
+      using value_type = T;
+
+      template <typename U>
+      struct rebind {
+        using other = recycling_allocator<U, Purpose>;
+      };
+
+      recycling_allocator() noexcept = default;
+
+      template <typename U>
+      recycling_allocator(const recycling_allocator<U, Purpose>&) noexcept {}
+
+      T* allocate(std::size_t n) {
+        return static_cast<T*>(thread_info::allocate(Purpose(),
+            thread_context::top_of_thread_call_stack(), sizeof(T) * n, alignof(T)));
+      }
+
+      void deallocate(T* p, std::size_t n) {
+        thread_info::deallocate(Purpose(), thread_context::top_of_thread_call_stack(),
+                                p, sizeof(T) * n);
+      }
+
+      template <typename U>
+      friend bool operator==(const recycling_allocator&, const recycling_allocator<U, Purpose>&) noexcept {
+        return true;
+      }
+
+      template <typename U>
+      friend bool operator!=(const recycling_allocator&, const recycling_allocator<U, Purpose>&) noexcept {
+        return false;
+      }
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -2,12 +2,14 @@
 #define EASIO_BASE_SERVICE_REGISTRY_HPP
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <mutex>
 
-#include "easio/base/execution_context.hpp"
-#include "easio/base/noncopyable.hpp"
+#include "base/execution_context.hpp"
+#include "base/noncopyable.hpp"
 
 namespace easio {
 namespace base {
@@ -42,12 +44,27 @@ class service_registry : private noncopyable {
     inline static bool keys_match(const service_key &lkey,
                                   const service_key &rkey);
 
+    // Services found through slots_ without taking mutex_. Each service
+    // type is given the next index the first time it is looked up; types
+    // past the end only use the list.
+    static const std::size_t max_service_slots = 32;
+
+    template <typename Service>
+    static std::size_t slot_index();
+
    private:
+    inline void publish(std::size_t index, execution_context::service *svc);
+
+    static inline std::atomic<std::size_t> next_slot_index_{0};
+
     mutable std::mutex mutex_;
     execution_context &owner_;
     context_service_ptr first_service_ptr_;
+    std::atomic<execution_context::service *> slots_[max_service_slots];
 };
 }  // namespace base
 }  // namespace easio
 
+#include "base/impl/service_registry.ipp"
+
 #endif
\ No newline at end of file
@@ -0,0 +1,533 @@
+#ifndef EASIO_BASE_SHM_CHANNEL_SERVICE_HPP
+#define EASIO_BASE_SHM_CHANNEL_SERVICE_HPP
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "buffer.hpp"
+#include "base/execution_context.hpp"
+#include "base/handler_ops.hpp"
+#include "base/io_scheduler.hpp"
+#include "base/operation.hpp"
+#include "base/pending_ops.hpp"
+#include "base/socket_ops.hpp"
+#include "base/win_iocp_io_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Byte streams between two processes on one machine through a pair of
+    // single-producer single-consumer rings in a named shared memory
+    // section. While both sides keep up, a transfer is a copy and a store
+    // to the ring's position with no system call. A side that finds its
+    // ring empty (or full) raises a flag and sleeps on a named event, which
+    // the other side only sets when it sees the flag.
+    class shm_channel_service
+      : public execution_context_service<shm_channel_service> {
+    public:
+      static const std::size_t default_capacity = 256 * 1024;
+      static const std::size_t cache_line_size = 64;
+
+      // One direction, in the shared section. Positions only grow; the
+      // writer owns the first line and the reader the second, so neither
+      // side's stores invalidate the line the other one writes.
+      struct ring {
+        alignas(cache_line_size) std::atomic<std::uint64_t> write_pos_;
+        std::atomic<std::uint32_t> writer_waiting_;
+        alignas(cache_line_size) std::atomic<std::uint64_t> read_pos_;
+        std::atomic<std::uint32_t> reader_waiting_;
+      };
+
+      // The start of the section, followed by the two rings' bytes. End 0
+      // is the side that created the section; end i reads rings_[i].
+      struct header {
+        std::atomic<std::uint32_t> magic_;
+        std::uint32_t capacity_;
+        std::atomic<std::uint32_t> opened_;
+        std::atomic<std::uint32_t> closed_[2];
+        ring rings_[2];
+      };
+
+      static const std::uint32_t header_magic = 0x65736d31;
+
+      // This process's side of a channel. The registered waits call back
+      // from the system thread pool, so it is shared with them.
+      struct end_state {
+        std::mutex mutex_;
+        win_iocp_io_context* ctx_ = nullptr;
+        int end_ = 0;
+        bool closed_ = false;
+        // Set when the peer broke the ring protocol; every later op fails
+        // with it.
+        std::error_code error_;
+
+        HANDLE mapping_ = 0;
+        header* header_ = nullptr;
+        std::size_t view_size_ = 0;
+        ring* in_ = nullptr;
+        ring* out_ = nullptr;
+        char* in_data_ = nullptr;
+        char* out_data_ = nullptr;
+        std::uint64_t mask_ = 0;
+
+        // What this side last saw of the peer's position, so the peer's
+        // line is only read again once the cached value runs out.
+        std::uint64_t peer_write_pos_ = 0;
+        std::uint64_t peer_read_pos_ = 0;
+
+        // data_[i] is set when rings_[i] gets bytes, space_[i] when it
+        // gets room.
+        HANDLE data_[2] = {0, 0};
+        HANDLE space_[2] = {0, 0};
+        HANDLE data_wait_ = 0;
+        HANDLE space_wait_ = 0;
+
+        std::deque<receive_op_ptr> readers_;
+        std::deque<write_op_ptr> writers_;
+      };
+
+      struct implementation_type {
+        std::shared_ptr<end_state> state_;
+      };
+
+      inline shm_channel_service(execution_context& ctx)
+        : execution_context_service<shm_channel_service>(ctx),
+          iocp_service_(use_service<win_iocp_io_context>(ctx)) {}
+
+      inline void shutdown() {}
+
+      io_scheduler<win_iocp_io_context> get_scheduler() const noexcept {
+        return io_scheduler<win_iocp_io_context>(iocp_service_);
+      }
+
+      inline void construct(implementation_type& impl) {
+        impl.state_.reset();
+      }
+
+      inline void move_construct(implementation_type& impl, implementation_type& other) {
+        impl.state_ = std::move(other.state_);
+      }
+
+      inline bool is_open(const implementation_type& impl) const {
+        return impl.state_ != nullptr;
+      }
+
+      // Creates the named section, with capacity rounded up to a power of
+      // two for each direction. Returns at once; until another process
+      // opens the section, writes fill its ring and reads wait.
+      inline void create(implementation_type& impl, const std::string& name,
+                         std::size_t capacity, std::error_code& ec) {
+        if (is_open(impl)) {
+          ec = std::make_error_code(std::errc::already_connected);
+          return;
+        }
+        if (capacity == 0 || capacity > 0x40000000) {
+          ec = std::make_error_code(std::errc::invalid_argument);
+          return;
+        }
+        std::uint64_t ring_size = cache_line_size;
+        while (ring_size < capacity)
+          ring_size <<= 1;
+
+        std::uint64_t size = data_offset() + 2 * ring_size;
+        std::shared_ptr<end_state> s = std::make_shared<end_state>();
+        s->mapping_ = ::CreateFileMappingA(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE,
+                                           static_cast<DWORD>(size >> 32),
+                                           static_cast<DWORD>(size), name.c_str());
+        if (!s->mapping_) {
+          ec = last_error();
+          return;
+        }
+        if (::GetLastError() == ERROR_ALREADY_EXISTS) {
+          release(*s);
+          ec = std::make_error_code(std::errc::address_in_use);
+          return;
+        }
+
+        ec = map(*s);
+        for (int i = 0; !ec && i < 2; ++i) {
+          s->data_[i] = ::CreateEventA(0, FALSE, FALSE, event_name(name, "data", i).c_str());
+          s->space_[i] = ::CreateEventA(0, FALSE, FALSE, event_name(name, "space", i).c_str());
+          if (!s->data_[i] || !s->space_[i])
+            ec = last_error();
+        }
+        if (ec) {
+          release(*s);
+          return;
+        }
+
+        // The section comes zeroed; the header only has to be constructed
+        // and published.
+        header* h = new (s->header_) header();
+        h->capacity_ = static_cast<std::uint32_t>(ring_size);
+        h->magic_.store(header_magic, std::memory_order_release);
+
+        start(impl, std::move(s), 0, ec);
+      }
+
+      // Opens a section another process created. Only one process may.
+      inline void open(implementation_type& impl, const std::string& name, std::error_code& ec) {
+        if (is_open(impl)) {
+          ec = std::make_error_code(std::errc::already_connected);
+          return;
+        }
+
+        std::shared_ptr<end_state> s = std::make_shared<end_state>();
+        s->mapping_ = ::OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+        if (!s->mapping_) {
+          ec = last_error();
+          return;
+        }
+
+        ec = map(*s);
+        if (!ec && s->header_->magic_.load(std::memory_order_acquire) != header_magic)
+          ec = std::make_error_code(std::errc::connection_refused);
+        if (!ec && !valid_capacity(s->header_->capacity_, s->view_size_))
+          ec = std::make_error_code(std::errc::protocol_error);
+        if (!ec && s->header_->opened_.exchange(1) != 0)
+          ec = std::make_error_code(std::errc::already_connected);
+        for (int i = 0; !ec && i < 2; ++i) {
+          s->data_[i] = ::OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE,
+                                     event_name(name, "data", i).c_str());
+          s->space_[i] = ::OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE,
+                                      event_name(name, "space", i).c_str());
+          if (!s->data_[i] || !s->space_[i])
+            ec = last_error();
+        }
+        if (ec) {
+          release(*s);
+          return;
+        }
+
+        start(impl, std::move(s), 1, ec);
+      }
+
+      // Fails this side's pending ops with operation_aborted. The peer's
+      // reads see end of file once they have drained what was written, and
+      // its writes fail with broken_pipe.
+      inline void close(implementation_type& impl, std::error_code& ec) {
+        ec = std::error_code();
+        if (!is_open(impl))
+          return;
+
+        std::shared_ptr<end_state> s = std::move(impl.state_);
+        {
+          std::lock_guard<std::mutex> lock(s->mutex_);
+          s->closed_ = true;
+          fail_pending(*s->ctx_, s->readers_, socket_ops::operation_aborted());
+          fail_pending(*s->ctx_, s->writers_, socket_ops::operation_aborted());
+          publish_closed(*s);
+        }
+
+        // Waits for callbacks already running, which find closed_ set.
+        ::UnregisterWaitEx(s->data_wait_, INVALID_HANDLE_VALUE);
+        ::UnregisterWaitEx(s->space_wait_, INVALID_HANDLE_VALUE);
+        s->data_wait_ = s->space_wait_ = 0;
+        release(*s);
+      }
+
+      template <typename Handler>
+      void async_receive(implementation_type& impl, const mutable_buffer& buffer, Handler&& handler) {
+        using op_type = receive_handler_op<std::decay_t<Handler>>;
+        start_receive_op(impl, std::make_shared<op_type>(
+            buffer, std::decay_t<Handler>(std::forward<Handler>(handler))));
+      }
+
+      template <typename Handler>
+      void async_send(implementation_type& impl, const const_buffer& buffer, Handler&& handler) {
+        using op_type = write_handler_op<std::decay_t<Handler>>;
+        start_send_op(impl, std::make_shared<op_type>(
+            buffer, std::decay_t<Handler>(std::forward<Handler>(handler))));
+      }
+
+      // Completes with what the ring holds, up to the buffer's size, or
+      // waits for the peer to write.
+      inline void start_receive_op(implementation_type& impl, receive_op_ptr op) {
+        if (!start_pending(iocp_service_, op, is_open(impl)))
+          return;
+
+        end_state& s = *impl.state_;
+        std::lock_guard<std::mutex> lock(s.mutex_);
+        s.readers_.push_back(std::move(op));
+        pump(s);
+      }
+
+      // Completes once the whole buffer is in the ring.
+      inline void start_send_op(implementation_type& impl, write_op_ptr op) {
+        if (!start_pending(iocp_service_, op, is_open(impl)))
+          return;
+
+        end_state& s = *impl.state_;
+        std::lock_guard<std::mutex> lock(s.mutex_);
+        s.writers_.push_back(std::move(op));
+        pump(s);
+      }
+
+      inline void cancel_op(implementation_type& impl, operation& op) {
+        if (!is_open(impl))
+          return;
+
+        end_state& s = *impl.state_;
+        std::lock_guard<std::mutex> lock(s.mutex_);
+        cancel_pending(*s.ctx_, s.readers_, op);
+      }
+
+      // A write that is partly in the ring fails with what it got there.
+      inline void cancel_send_op(implementation_type& impl, write_op& op) {
+        if (!is_open(impl))
+          return;
+
+        end_state& s = *impl.state_;
+        std::lock_guard<std::mutex> lock(s.mutex_);
+        cancel_pending(*s.ctx_, s.writers_, op);
+      }
+
+    private:
+      static std::size_t data_offset() noexcept {
+        return (sizeof(header) + cache_line_size - 1) & ~(cache_line_size - 1);
+      }
+
+      static std::string event_name(const std::string& name, const char* kind, int i) {
+        return name + "." + kind + static_cast<char>('0' + i);
+      }
+
+      static std::error_code last_error() {
+        return std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+      }
+
+      static std::error_code map(end_state& s) {
+        void* view = ::MapViewOfFile(s.mapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        if (!view)
+          return last_error();
+        s.header_ = static_cast<header*>(view);
+
+        MEMORY_BASIC_INFORMATION info;
+        if (::VirtualQuery(view, &info, sizeof(info)) == 0)
+          return last_error();
+        s.view_size_ = info.RegionSize;
+        return std::error_code();
+      }
+
+      // The section belongs to another process, so the capacity in its
+      // header is only used once it is one create() could have written and
+      // both rings fit in the view.
+      static bool valid_capacity(std::uint32_t capacity, std::size_t view_size) {
+        return capacity >= cache_line_size && capacity <= 0x40000000
+               && (capacity & (capacity - 1)) == 0
+               && view_size >= data_offset()
+               && (view_size - data_offset()) / 2 >= capacity;
+      }
+
+      // Closes whatever create() or open() got as far as acquiring.
+      static void release(end_state& s) {
+        for (int i = 0; i < 2; ++i) {
+          if (s.data_[i])
+            ::CloseHandle(s.data_[i]);
+          if (s.space_[i])
+            ::CloseHandle(s.space_[i]);
+          s.data_[i] = s.space_[i] = 0;
+        }
+        if (s.header_)
+          ::UnmapViewOfFile(s.header_);
+        if (s.mapping_)
+          ::CloseHandle(s.mapping_);
+        s.header_ = nullptr;
+        s.mapping_ = 0;
+      }
+
+      inline void start(implementation_type& impl, std::shared_ptr<end_state> s, int end,
+                        std::error_code& ec) {
+        header& h = *s->header_;
+        char* data = reinterpret_cast<char*>(s->header_) + data_offset();
+        s->ctx_ = &iocp_service_;
+        s->end_ = end;
+        s->mask_ = h.capacity_ - 1;
+        s->in_ = &h.rings_[end];
+        s->out_ = &h.rings_[1 - end];
+        s->in_data_ = data + end * static_cast<std::size_t>(h.capacity_);
+        s->out_data_ = data + (1 - end) * static_cast<std::size_t>(h.capacity_);
+        s->peer_write_pos_ = s->in_->write_pos_.load(std::memory_order_acquire);
+        s->peer_read_pos_ = s->out_->read_pos_.load(std::memory_order_acquire);
+
+        // Waits on the auto-reset events stay registered until close, so
+        // a wakeup costs a thread pool callback and nothing to re-arm.
+        if (!::RegisterWaitForSingleObject(&s->data_wait_, s->data_[end], &on_signal, s.get(),
+                                           INFINITE, WT_EXECUTEDEFAULT)
+            || !::RegisterWaitForSingleObject(&s->space_wait_, s->space_[1 - end], &on_signal,
+                                              s.get(), INFINITE, WT_EXECUTEDEFAULT)) {
+          ec = last_error();
+          if (s->data_wait_)
+            ::UnregisterWaitEx(s->data_wait_, INVALID_HANDLE_VALUE);
+          release(*s);
+          return;
+        }
+
+        impl.state_ = std::move(s);
+        ec = std::error_code();
+      }
+
+      static void CALLBACK on_signal(PVOID param, BOOLEAN) {
+        end_state& s = *static_cast<end_state*>(param);
+        std::lock_guard<std::mutex> lock(s.mutex_);
+        if (!s.closed_)
+          pump(s);
+      }
+
+      // Tells the peer this side is gone and wakes it if it waits.
+      static void publish_closed(end_state& s) {
+        s.header_->closed_[s.end_].store(1, std::memory_order_seq_cst);
+        ::SetEvent(s.data_[1 - s.end_]);
+        ::SetEvent(s.space_[s.end_]);
+      }
+
+      // A position in the section is out of range: a reader ahead of its
+      // writer, or a writer more than the capacity ahead of its reader. The
+      // rings can no longer be trusted, so every op fails with
+      // protocol_error and the peer is told this side has closed. The
+      // handles stay until close().
+      static void fail_protocol(end_state& s) {
+        s.error_ = std::make_error_code(std::errc::protocol_error);
+        fail_pending(*s.ctx_, s.readers_, s.error_);
+        fail_pending(*s.ctx_, s.writers_, s.error_);
+        publish_closed(s);
+      }
+
+      static bool peer_closed(const end_state& s) {
+        return s.header_->closed_[1 - s.end_].load(std::memory_order_acquire) != 0;
+      }
+
+      // Moves bytes from waiting writers into the outgoing ring and from
+      // the incoming ring to waiting readers, then, for a side that still
+      // has ops waiting, raises its flag and checks the ring once more so
+      // that a position published meanwhile is not missed. The positions
+      // and flags are stored and loaded seq_cst for that check. Called
+      // with s.mutex_ locked.
+      static void pump(end_state& s) {
+        if (s.error_) {
+          fail_pending(*s.ctx_, s.readers_, s.error_);
+          fail_pending(*s.ctx_, s.writers_, s.error_);
+          return;
+        }
+
+        std::uint64_t capacity = s.mask_ + 1;
+        for (;;) {
+          bool progress = false;
+
+          while (!s.writers_.empty()) {
+            if (peer_closed(s)) {
+              fail_pending(*s.ctx_, s.writers_, std::make_error_code(std::errc::broken_pipe));
+              progress = true;
+              break;
+            }
+
+            std::uint64_t pos = s.out_->write_pos_.load(std::memory_order_relaxed);
+            if (pos - s.peer_read_pos_ == capacity)
+              s.peer_read_pos_ = s.out_->read_pos_.load(std::memory_order_acquire);
+            if (pos - s.peer_read_pos_ > capacity) {
+              fail_protocol(s);
+              return;
+            }
+            std::uint64_t room = capacity - (pos - s.peer_read_pos_);
+            write_op& w = *s.writers_.front();
+            std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(room, w.buffer_.size()));
+            if (n == 0 && w.buffer_.size() > 0)
+              break;
+
+            copy_in(s.out_data_, pos & s.mask_, capacity, static_cast<const char*>(w.buffer_.data()), n);
+            s.out_->write_pos_.store(pos + n, std::memory_order_seq_cst);
+            if (s.out_->reader_waiting_.load(std::memory_order_seq_cst))
+              ::SetEvent(s.data_[1 - s.end_]);
+
+            w.buffer_ = const_buffer(static_cast<const char*>(w.buffer_.data()) + n, w.buffer_.size() - n);
+            w.bytes_transferred_ += n;
+            progress = true;
+            if (w.buffer_.size() > 0)
+              continue;
+            complete_write(*s.ctx_, pop_pending(s.writers_), std::error_code());
+          }
+
+          while (!s.readers_.empty()) {
+            receive_op& r = *s.readers_.front();
+            std::uint64_t pos = s.in_->read_pos_.load(std::memory_order_relaxed);
+            if (s.peer_write_pos_ == pos)
+              s.peer_write_pos_ = s.in_->write_pos_.load(std::memory_order_acquire);
+            if (s.peer_write_pos_ == pos && r.buffer_.size() > 0) {
+              // The peer's last write comes before its closed flag.
+              if (!peer_closed(s))
+                break;
+              s.peer_write_pos_ = s.in_->write_pos_.load(std::memory_order_acquire);
+              if (s.peer_write_pos_ == pos) {
+                complete_receive(*s.ctx_, pop_pending(s.readers_), std::error_code(), 0);
+                progress = true;
+                continue;
+              }
+            }
+
+            if (s.peer_write_pos_ - pos > capacity) {
+              fail_protocol(s);
+              return;
+            }
+            std::size_t n = static_cast<std::size_t>(
+                std::min<std::uint64_t>(s.peer_write_pos_ - pos, r.buffer_.size()));
+            copy_out(static_cast<char*>(r.buffer_.data()), s.in_data_, pos & s.mask_, capacity, n);
+            s.in_->read_pos_.store(pos + n, std::memory_order_seq_cst);
+            if (s.in_->writer_waiting_.load(std::memory_order_seq_cst))
+              ::SetEvent(s.space_[s.end_]);
+            complete_receive(*s.ctx_, pop_pending(s.readers_), std::error_code(), n);
+            progress = true;
+          }
+
+          if (progress)
+            continue;
+
+          bool retry = false;
+          if (!s.writers_.empty()) {
+            s.out_->writer_waiting_.store(1, std::memory_order_seq_cst);
+            retry = s.out_->read_pos_.load(std::memory_order_seq_cst) != s.peer_read_pos_
+                    || peer_closed(s);
+          } else if (s.out_->writer_waiting_.load(std::memory_order_relaxed)) {
+            s.out_->writer_waiting_.store(0, std::memory_order_relaxed);
+          }
+          if (!s.readers_.empty()) {
+            s.in_->reader_waiting_.store(1, std::memory_order_seq_cst);
+            retry = retry || s.in_->write_pos_.load(std::memory_order_seq_cst) != s.peer_write_pos_
+                    || peer_closed(s);
+          } else if (s.in_->reader_waiting_.load(std::memory_order_relaxed)) {
+            s.in_->reader_waiting_.store(0, std::memory_order_relaxed);
+          }
+          if (!retry)
+            return;
+        }
+      }
+
+      static void copy_in(char* ring_data, std::uint64_t at, std::uint64_t capacity,
+                          const char* data, std::size_t n) {
+        std::size_t first = static_cast<std::size_t>(std::min<std::uint64_t>(n, capacity - at));
+        std::memcpy(ring_data + at, data, first);
+        std::memcpy(ring_data, data + first, n - first);
+      }
+
+      static void copy_out(char* data, const char* ring_data, std::uint64_t at,
+                           std::uint64_t capacity, std::size_t n) {
+        std::size_t first = static_cast<std::size_t>(std::min<std::uint64_t>(n, capacity - at));
+        std::memcpy(data, ring_data + at, first);
+        std::memcpy(data + first, ring_data, n - first);
+      }
+
+      win_iocp_io_context& iocp_service_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef EASIO_BASE_SOCKET_OPS_HPP
+#define EASIO_BASE_SOCKET_OPS_HPP
+#pragma once
+
+#include <cstddef>
+#include <system_error>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace easio {
+  namespace base {
+    namespace socket_ops {
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+      using socket_type = SOCKET;
+      using buf = WSABUF;
+      // What another process needs to open its own handle to a socket.
+      using protocol_info = WSAPROTOCOL_INFOW;
+      const socket_type invalid_socket = INVALID_SOCKET;
+      const int socket_error_retval = SOCKET_ERROR;
+
+      inline void init_buf(buf& b, const void* data, std::size_t size) {
+        b.buf = static_cast<char*>(const_cast<void*>(data));
+        b.len = static_cast<ULONG>(size);
+      }
+
+      inline std::error_code last_error() {
+        return std::error_code(::WSAGetLastError(), std::system_category());
+      }
+
+      inline std::error_code operation_aborted() {
+        return std::error_code(ERROR_OPERATION_ABORTED, std::system_category());
+      }
+#else
+      using socket_type = int;
+      using buf = ::iovec;
+      const socket_type invalid_socket = -1;
+      const int socket_error_retval = -1;
+
+      inline void init_buf(buf& b, const void* data, std::size_t size) {
+        b.iov_base = const_cast<void*>(data);
+        b.iov_len = size;
+      }
+
+      inline std::error_code last_error() {
+        return std::error_code(errno, std::system_category());
+      }
+
+      inline std::error_code operation_aborted() {
+        return std::error_code(ECANCELED, std::system_category());
+      }
+#endif
+
+      inline int close(socket_type s, std::error_code& ec) {
+        if (s == invalid_socket) {
+          ec = std::make_error_code(std::errc::bad_file_descriptor);
+          return socket_error_retval;
+        }
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+        int result = ::closesocket(s);
+#else
+        int result = ::close(s);
+#endif
+        ec = result == 0 ? std::error_code() : last_error();
+        return result;
+      }
+
+    }  // namespace socket_ops
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -0,0 +1,402 @@
+#ifndef EASIO_BASE_SOCKET_SENDERS_HPP
+#define EASIO_BASE_SOCKET_SENDERS_HPP
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <type_traits>
+
+#include "buffer.hpp"
+#include "base/execution/execution.hpp"
+#include "base/operation.hpp"
+#include "base/socket_ops.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Senders for socket I/O. connect() returns an operation state that is
+    // itself the backend op (OVERLAPPED included), so it lives in storage the
+    // caller owns and starting it allocates nothing. The op hands the
+    // backend a non-owning operation_ptr; the caller keeps the state alive
+    // until the receiver is signalled, as every operation state requires.
+    //
+    // All of them complete on a thread running the socket's context, which
+    // get_completion_scheduler reports, and with set_done if the context is
+    // destroyed first.
+    //
+    // If the receiver's stop token can be stopped, a stop request cancels
+    // just this op (CancelIoEx on its OVERLAPPED) and the op completes with
+    // set_done. With never_stop_token the stop callback compiles away.
+
+    // True if the op failed because its receiver asked it to stop.
+    template <typename R>
+    bool stopped_by_receiver(const R& r, const std::error_code& ec) {
+      return ec == socket_ops::operation_aborted() &&
+             execution::get_stop_token(r).stop_requested();
+    }
+    template <typename Service>
+    class read_some_sender {
+    public:
+      using implementation_type = typename Service::implementation_type;
+
+      template <template <typename...> typename Tuple, template <typename...> typename Variant>
+      using value_types = Variant<Tuple<std::size_t>>;
+
+      template <template <typename...> typename Variant>
+      using error_types = Variant<std::error_code, std::exception_ptr>;
+
+      static constexpr bool sends_done = true;
+
+      read_some_sender(Service& service, implementation_type& impl, const mutable_buffer& buffer)
+        : service_(&service), impl_(&impl), buffer_(buffer) {}
+
+      template <typename R>
+      class operation_state : public receive_op {
+      public:
+        operation_state(Service& service, implementation_type& impl,
+                        const mutable_buffer& buffer, R&& r)
+          : receive_op(&operation_state::do_complete, buffer),
+            service_(service), impl_(impl), r_(std::move(r)) {}
+
+        operation_state(operation_state&&) = delete;
+
+        friend void tag_invoke(execution::start_t, operation_state& op) noexcept {
+          auto token = execution::get_stop_token(op.r_);
+          if (token.stop_requested()) {
+            execution::set_done(std::move(op.r_));
+            return;
+          }
+          op.on_stop_.emplace(token, cancel{&op});
+          op.service_.start_receive_op(op.impl_, std::static_pointer_cast<receive_op>(op.self()));
+        }
+
+      private:
+        struct cancel {
+          operation_state* op_;
+          void operator()() noexcept { op_->service_.cancel_op(op_->impl_, *op_); }
+        };
+
+        static void do_complete(service_ptr owner, operation_ptr base,
+                                const std::error_code& ec, std::size_t bytes_transferred) {
+          operation_state* op = static_cast<operation_state*>(base.get());
+          base.reset();
+          op->on_stop_.reset();
+
+          if (!owner || stopped_by_receiver(op->r_, ec)) {
+            execution::set_done(std::move(op->r_));
+          } else if (ec) {
+            execution::set_error(std::move(op->r_), ec);
+          } else {
+            try {
+              execution::set_value(std::move(op->r_), bytes_transferred);
+            } catch (...) {
+              execution::set_error(std::move(op->r_), std::current_exception());
+            }
+          }
+        }
+
+        Service& service_;
+        implementation_type& impl_;
+        R r_;
+        [[no_unique_address]] execution::optional_stop_callback<execution::stop_token_of_t<R>, cancel> on_stop_;
+      };
+
+      template <execution::receiver R>
+      friend operation_state<std::remove_cvref_t<R>> tag_invoke(
+          execution::connect_t, const read_some_sender& s, R&& r) {
+        return operation_state<std::remove_cvref_t<R>>(
+            *s.service_, *s.impl_, s.buffer_, std::remove_cvref_t<R>(std::forward<R>(r)));
+      }
+
+      template <typename CPO>
+      friend auto tag_invoke(execution::get_completion_scheduler_t<CPO>,
+                             const read_some_sender& s) noexcept {
+        return s.service_->get_scheduler();
+      }
+
+    private:
+      Service* service_;
+      implementation_type* impl_;
+      mutable_buffer buffer_;
+    };
+
+    // Goes through the socket's write queue, so it may share a gather send
+    // with other writes and completes once the whole buffer is sent.
+    template <typename Service>
+    class write_sender {
+    public:
+      using implementation_type = typename Service::implementation_type;
+
+      template <template <typename...> typename Tuple, template <typename...> typename Variant>
+      using value_types = Variant<Tuple<std::size_t>>;
+
+      template <template <typename...> typename Variant>
+      using error_types = Variant<std::error_code, std::exception_ptr>;
+
+      static constexpr bool sends_done = true;
+
+      write_sender(Service& service, implementation_type& impl, const const_buffer& buffer)
+        : service_(&service), impl_(&impl), buffer_(buffer) {}
+
+      template <typename R>
+      class operation_state : public write_op {
+      public:
+        operation_state(Service& service, implementation_type& impl,
+                        const const_buffer& buffer, R&& r)
+          : write_op(&operation_state::do_complete, buffer),
+            service_(service), impl_(impl), r_(std::move(r)) {}
+
+        operation_state(operation_state&&) = delete;
+
+        friend void tag_invoke(execution::start_t, operation_state& op) noexcept {
+          auto token = execution::get_stop_token(op.r_);
+          if (token.stop_requested()) {
+            execution::set_done(std::move(op.r_));
+            return;
+          }
+          op.on_stop_.emplace(token, cancel{&op});
+          op.service_.start_send_op(op.impl_, std::static_pointer_cast<write_op>(op.self()));
+        }
+
+      private:
+        struct cancel {
+          operation_state* op_;
+          void operator()() noexcept { op_->service_.cancel_send_op(op_->impl_, *op_); }
+        };
+
+        static void do_complete(service_ptr owner, operation_ptr base,
+                                const std::error_code&, std::size_t) {
+          operation_state* op = static_cast<operation_state*>(base.get());
+          base.reset();
+          op->on_stop_.reset();
+
+          if (!owner || stopped_by_receiver(op->r_, op->ec_)) {
+            execution::set_done(std::move(op->r_));
+          } else if (op->ec_) {
+            execution::set_error(std::move(op->r_), op->ec_);
+          } else {
+            try {
+              execution::set_value(std::move(op->r_), op->bytes_transferred_);
+            } catch (...) {
+              execution::set_error(std::move(op->r_), std::current_exception());
+            }
+          }
+        }
+
+        Service& service_;
+        implementation_type& impl_;
+        R r_;
+        [[no_unique_address]] execution::optional_stop_callback<execution::stop_token_of_t<R>, cancel> on_stop_;
+      };
+
+      template <execution::receiver R>
+      friend operation_state<std::remove_cvref_t<R>> tag_invoke(
+          execution::connect_t, const write_sender& s, R&& r) {
+        return operation_state<std::remove_cvref_t<R>>(
+            *s.service_, *s.impl_, s.buffer_, std::remove_cvref_t<R>(std::forward<R>(r)));
+      }
+
+      template <typename CPO>
+      friend auto tag_invoke(execution::get_completion_scheduler_t<CPO>,
+                             const write_sender& s) noexcept {
+        return s.service_->get_scheduler();
+      }
+
+    private:
+      Service* service_;
+      implementation_type* impl_;
+      const_buffer buffer_;
+    };
+
+    // Completes with no values once the connection is assigned to the peer.
+    template <typename Service>
+    class accept_sender {
+    public:
+      using implementation_type = typename Service::implementation_type;
+
+      template <template <typename...> typename Tuple, template <typename...> typename Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template <template <typename...> typename Variant>
+      using error_types = Variant<std::error_code, std::exception_ptr>;
+
+      static constexpr bool sends_done = true;
+
+      accept_sender(Service& service, implementation_type& impl, implementation_type& peer)
+        : service_(&service), impl_(&impl), peer_(&peer) {}
+
+      template <typename R>
+      class operation_state : public accept_op {
+      public:
+        operation_state(Service& service, implementation_type& impl,
+                        implementation_type& peer, R&& r)
+          : accept_op(&operation_state::do_complete),
+            service_(service), impl_(impl), peer_(peer), r_(std::move(r)) {}
+
+        operation_state(operation_state&&) = delete;
+
+        friend void tag_invoke(execution::start_t, operation_state& op) noexcept {
+          auto token = execution::get_stop_token(op.r_);
+          if (token.stop_requested()) {
+            execution::set_done(std::move(op.r_));
+            return;
+          }
+          op.on_stop_.emplace(token, cancel{&op});
+          op.service_.start_accept_op(op.impl_, std::static_pointer_cast<accept_op>(op.self()));
+        }
+
+      private:
+        struct cancel {
+          operation_state* op_;
+          void operator()() noexcept { op_->service_.cancel_op(op_->impl_, *op_); }
+        };
+
+        static void do_complete(service_ptr owner, operation_ptr base,
+                                const std::error_code& result_ec, std::size_t) {
+          operation_state* op = static_cast<operation_state*>(base.get());
+          base.reset();
+          op->on_stop_.reset();
+
+          std::error_code ec = owner ? result_ec
+              : std::make_error_code(std::errc::operation_canceled);
+          op->service_.complete_accept(op->impl_, op->peer_, *op, ec);
+
+          if (!owner || stopped_by_receiver(op->r_, ec)) {
+            execution::set_done(std::move(op->r_));
+          } else if (ec) {
+            execution::set_error(std::move(op->r_), ec);
+          } else {
+            try {
+              execution::set_value(std::move(op->r_));
+            } catch (...) {
+              execution::set_error(std::move(op->r_), std::current_exception());
+            }
+          }
+        }
+
+        Service& service_;
+        implementation_type& impl_;
+        implementation_type& peer_;
+        R r_;
+        [[no_unique_address]] execution::optional_stop_callback<execution::stop_token_of_t<R>, cancel> on_stop_;
+      };
+
+      template <execution::receiver R>
+      friend operation_state<std::remove_cvref_t<R>> tag_invoke(
+          execution::connect_t, const accept_sender& s, R&& r) {
+        return operation_state<std::remove_cvref_t<R>>(
+            *s.service_, *s.impl_, *s.peer_, std::remove_cvref_t<R>(std::forward<R>(r)));
+      }
+
+      template <typename CPO>
+      friend auto tag_invoke(execution::get_completion_scheduler_t<CPO>,
+                             const accept_sender& s) noexcept {
+        return s.service_->get_scheduler();
+      }
+
+    private:
+      Service* service_;
+      implementation_type* impl_;
+      implementation_type* peer_;
+    };
+
+    // Opens the socket for the endpoint's protocol first if it is closed.
+    template <typename Service, typename Endpoint>
+    class connect_sender {
+    public:
+      using implementation_type = typename Service::implementation_type;
+
+      template <template <typename...> typename Tuple, template <typename...> typename Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template <template <typename...> typename Variant>
+      using error_types = Variant<std::error_code, std::exception_ptr>;
+
+      static constexpr bool sends_done = true;
+
+      connect_sender(Service& service, implementation_type& impl, const Endpoint& endpoint)
+        : service_(&service), impl_(&impl), endpoint_(endpoint) {}
+
+      template <typename R>
+      class operation_state : public connect_op {
+      public:
+        operation_state(Service& service, implementation_type& impl,
+                        const Endpoint& endpoint, R&& r)
+          : connect_op(&operation_state::do_complete),
+            service_(service), impl_(impl), endpoint_(endpoint), r_(std::move(r)) {}
+
+        operation_state(operation_state&&) = delete;
+
+        friend void tag_invoke(execution::start_t, operation_state& op) noexcept {
+          auto token = execution::get_stop_token(op.r_);
+          if (token.stop_requested()) {
+            execution::set_done(std::move(op.r_));
+            return;
+          }
+          op.on_stop_.emplace(token, cancel{&op});
+          op.service_.start_connect_op(op.impl_, std::static_pointer_cast<connect_op>(op.self()),
+                                       op.endpoint_.data(), op.endpoint_.size());
+        }
+
+      private:
+        struct cancel {
+          operation_state* op_;
+          void operator()() noexcept { op_->service_.cancel_op(op_->impl_, *op_); }
+        };
+
+        static void do_complete(service_ptr owner, operation_ptr base,
+                                const std::error_code& result_ec, std::size_t) {
+          operation_state* op = static_cast<operation_state*>(base.get());
+          base.reset();
+          op->on_stop_.reset();
+
+          if (!owner) {
+            execution::set_done(std::move(op->r_));
+            return;
+          }
+
+          std::error_code ec = result_ec;
+          op->service_.complete_connect(op->impl_, *op, ec);
+          if (stopped_by_receiver(op->r_, ec)) {
+            execution::set_done(std::move(op->r_));
+          } else if (ec) {
+            execution::set_error(std::move(op->r_), ec);
+          } else {
+            try {
+              execution::set_value(std::move(op->r_));
+            } catch (...) {
+              execution::set_error(std::move(op->r_), std::current_exception());
+            }
+          }
+        }
+
+        Service& service_;
+        implementation_type& impl_;
+        Endpoint endpoint_;
+        R r_;
+        [[no_unique_address]] execution::optional_stop_callback<execution::stop_token_of_t<R>, cancel> on_stop_;
+      };
+
+      template <execution::receiver R>
+      friend operation_state<std::remove_cvref_t<R>> tag_invoke(
+          execution::connect_t, const connect_sender& s, R&& r) {
+        return operation_state<std::remove_cvref_t<R>>(
+            *s.service_, *s.impl_, s.endpoint_, std::remove_cvref_t<R>(std::forward<R>(r)));
+      }
+
+      template <typename CPO>
+      friend auto tag_invoke(execution::get_completion_scheduler_t<CPO>,
+                             const connect_sender& s) noexcept {
+        return s.service_->get_scheduler();
+      }
+
+    private:
+      Service* service_;
+      implementation_type* impl_;
+      Endpoint endpoint_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef EASIO_BASE_STRAND_IMPL_HPP
+#define EASIO_BASE_STRAND_IMPL_HPP
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "base/call_stack.hpp"
+#include "base/noncopyable.hpp"
+#include "base/thread_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    // A handler queued on a strand. Nodes form an intrusive list linked
+    // by the producers, so queueing needs no allocation beyond the node.
+    class strand_node {
+    public:
+      void invoke() {
+        func_(this, true);
+      }
+
+      void destroy() {
+        func_(this, false);
+      }
+
+    protected:
+      using func_type = void (*)(strand_node*, bool);
+
+      explicit strand_node(func_type func) noexcept : next_(nullptr), func_(func) {}
+
+      ~strand_node() = default;
+
+    private:
+      friend class strand_impl;
+
+      std::atomic<strand_node*> next_;
+      func_type func_;
+    };
+
+    template <typename Handler>
+    class strand_handler_node : public strand_node {
+    public:
+      template <typename H>
+      static strand_node* create(H&& h) {
+        void* p = thread_info::allocate(thread_info::executor_function_tag(),
+                                        thread_context::top_of_thread_call_stack(),
+                                        sizeof(strand_handler_node), alignof(strand_handler_node));
+        try {
+          return new (p) strand_handler_node(std::forward<H>(h));
+        } catch (...) {
+          thread_info::deallocate(thread_info::executor_function_tag(),
+                                  thread_context::top_of_thread_call_stack(), p,
+                                  sizeof(strand_handler_node));
+          throw;
+        }
+      }
+
+    private:
+      template <typename H>
+      explicit strand_handler_node(H&& h)
+        : strand_node(&strand_handler_node::do_complete), handler_(std::forward<H>(h)) {}
+
+      static void do_complete(strand_node* base, bool invoke) {
+        strand_handler_node* n = static_cast<strand_handler_node*>(base);
+        if (invoke) {
+          n->handler_();
+          return;
+        }
+        n->~strand_handler_node();
+        thread_info::deallocate(thread_info::executor_function_tag(),
+                                thread_context::top_of_thread_call_stack(), n,
+                                sizeof(strand_handler_node));
+      }
+
+      Handler handler_;
+    };
+
+    // The state of one strand: the tail of its queue, and nothing else, so
+    // an idle strand costs one pointer. Null means idle. Queueing a handler
+    // is a single exchange on the tail; whoever swaps out null owns the
+    // strand and schedules a run starting at its own node, and everyone
+    // else links behind the node they swapped out. A run executes handlers
+    // in order on one thread and releases the strand by swinging the tail
+    // back to null.
+    //
+    // The strand must outlive every handler queued on it.
+    class strand_impl : private noncopyable {
+    public:
+      // Handlers run back to back before a run yields to the context.
+      static const std::size_t max_batch = 64;
+
+      strand_impl() noexcept : tail_(nullptr) {}
+
+      // Returns true if the caller now owns the strand and must schedule a
+      // run starting at n.
+      bool enqueue(strand_node* n) noexcept {
+        strand_node* prev = tail_.exchange(n, std::memory_order_acq_rel);
+        if (!prev)
+          return true;
+        prev->next_.store(n, std::memory_order_release);
+        return false;
+      }
+
+      // True if the calling thread is inside a run of this strand.
+      bool running_in_this_thread() const noexcept {
+        return strand_call_stack::top_if(const_cast<strand_impl*>(this)) != nullptr;
+      }
+
+      // Executes up to max_batch handlers starting at head. Returns the
+      // node to resume from, or null once the strand is released. If a
+      // handler throws, head is updated to the resume point first.
+      strand_node* run(strand_node*& head) {
+        strand_call_stack::context ctx(this);
+        for (std::size_t i = 0; i < max_batch; ++i) {
+          strand_node* n = head;
+          release_on_exit on_exit = { this, &head };
+          n->invoke();
+          on_exit.head_ = nullptr;
+          head = next(n);
+          n->destroy();
+          if (!head)
+            return nullptr;
+        }
+        return head;
+      }
+
+      // Destroys handlers from head onward without running them, for a run
+      // abandoned because its context went away. Like a run, it releases
+      // the strand at the last node, and waits for a producer that has
+      // swapped a node out of the tail to link its own, so tail_ never
+      // points at a freed node.
+      void abandon(strand_node* head) noexcept {
+        while (head) {
+          strand_node* n = head;
+          head = next(n);
+          n->destroy();
+        }
+      }
+
+    private:
+      using strand_call_stack = call_stack<strand_impl>;
+
+      // Returns n's successor, or null if n was the last node and the
+      // strand has been released. A producer may have swapped n out of the
+      // tail without having linked its node yet; wait for the link.
+      strand_node* next(strand_node* n) noexcept {
+        strand_node* next = n->next_.load(std::memory_order_acquire);
+        if (next)
+          return next;
+
+        strand_node* expected = n;
+        if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel))
+          return nullptr;
+
+        while (!(next = n->next_.load(std::memory_order_acquire)))
+          std::this_thread::yield();
+        return next;
+      }
+
+      // Keeps the strand owned when a handler throws: head moves past the
+      // handler so the caller can schedule the rest.
+      struct release_on_exit {
+        ~release_on_exit() {
+          if (head_) {
+            strand_node* n = *head_;
+            *head_ = impl_->next(n);
+            n->destroy();
+          }
+        }
+
+        strand_impl* impl_;
+        strand_node** head_;
+      };
+
+      std::atomic<strand_node*> tail_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -5,10 +5,14 @@
 #include <exception>
 #include <limits>
 #include <concepts>
+#include <utility>
 
 #include "base/call_stack.hpp"
+#include "base/context_metrics.hpp"
 
-#if !defined(WIN32) && !defined(_WIN32) && !defined(__WIN32__)
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include <malloc.h>
+#else
 #include <cstdlib>
 #endif
 inline void* aligned_new(std::size_t align, std::size_t size) {
@@ -96,8 +100,12 @@ namespace easio {
       static const int max_mem_index = parallel_group_tag::end_mem_index;
       static const int chunk_size = 4;
 
+      // Handlers dispatched inline deeper than this are posted instead, so
+      // a chain of dispatches cannot exhaust the stack.
+      static const int max_dispatch_depth = 16;
+
       thread_info()
-          : has_pending_exception_(0) {
+          : has_pending_exception_(0), dispatch_depth_(0), metrics_(nullptr) {
         for (int i = 0; i < max_mem_index; ++i)
           reusable_memory_[i] = nullptr;
       }
@@ -129,6 +137,8 @@ namespace easio {
                   reinterpret_cast<std::size_t>(pointer) % align == 0) {
                 this_thread->reusable_memory_[mem_index] = 0;
                 mem[size] = mem[0];
+                if (this_thread->metrics_)
+                  this_thread->metrics_->on_allocation(true);
                 return pointer;
               }
             }
@@ -142,6 +152,9 @@ namespace easio {
               break;
             }
           }
+
+          if (this_thread->metrics_)
+            this_thread->metrics_->on_allocation(false);
         }
 
         void* const pointer = aligned_new(align, chunks* chunk_size + 1);
@@ -192,10 +205,42 @@ namespace easio {
         }
       }
 
+      // Runs f now if this_thread is set and has not reached
+      // max_dispatch_depth of nested inline dispatches. Returns false,
+      // leaving f untouched, if it has to be posted instead.
+      template <typename F>
+      static bool dispatch_inline(thread_info* this_thread, F&& f) {
+        if (!this_thread || this_thread->dispatch_depth_ >= max_dispatch_depth)
+          return false;
+
+        ++this_thread->dispatch_depth_;
+        dispatch_depth_guard guard = { this_thread };
+        (void)guard;
+        std::forward<F>(f)();
+        return true;
+      }
+
+      // Where this thread's counters go, or null if nobody is counting.
+      metrics_slot* metrics() const noexcept {
+        return metrics_;
+      }
+
+      void set_metrics(metrics_slot* slot) noexcept {
+        metrics_ = slot;
+      }
+
     private:
+      struct dispatch_depth_guard {
+        ~dispatch_depth_guard() { _t->dispatch_depth_--; }
+
+        thread_info* _t;
+      };
+
       void* reusable_memory_[max_mem_index];
       int has_pending_exception_;
       std::exception_ptr pending_exception_;
+      int dispatch_depth_;
+      metrics_slot* metrics_;
     };
 
     class thread_context {
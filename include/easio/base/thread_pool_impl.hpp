@@ -0,0 +1,174 @@
+#ifndef EASIO_BASE_THREAD_POOL_IMPL_HPP
+#define EASIO_BASE_THREAD_POOL_IMPL_HPP
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/execution_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    // A unit of work queued on a thread_pool_impl. It is embedded in an
+    // operation state, so queueing allocates nothing. run_ is called once,
+    // with abandoned set if the pool stopped before the task got a thread.
+    struct pool_task {
+      pool_task* next_ = nullptr;
+      void (*run_)(pool_task*, bool abandoned) noexcept = nullptr;
+    };
+
+    // Fixed set of threads taking tasks from one queue, for blocking or
+    // CPU-heavy work that must stay off the threads running an io_context.
+    class thread_pool_impl
+      : public execution_context_service<thread_pool_impl> {
+    public:
+      inline thread_pool_impl(execution_context& ctx, std::size_t threads)
+        : execution_context_service<thread_pool_impl>(ctx) {
+        if (threads == 0)
+          threads = 1;
+        threads_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+          threads_.emplace_back([this] { run(); });
+      }
+
+      inline void shutdown() {
+        stop();
+        join();
+      }
+
+      std::size_t thread_count() const noexcept {
+        return threads_.size();
+      }
+
+      // True if the calling thread is one of this pool's.
+      bool running_in_this_thread() const noexcept {
+        return current_pool() == this;
+      }
+
+      // Queues t. After stop() it is abandoned at once, on this thread.
+      inline void post(pool_task* t) {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!stopped_) {
+            push(t);
+            cv_.notify_one();
+            return;
+          }
+        }
+        t->run_(t, true);
+      }
+
+      // Queues n tasks linked through next_, waking up to n threads.
+      inline void post_list(pool_task* first, pool_task* last, std::size_t n) {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!stopped_) {
+            if (tail_)
+              tail_->next_ = first;
+            else
+              head_ = first;
+            tail_ = last;
+            last->next_ = nullptr;
+            if (n >= threads_.size())
+              cv_.notify_all();
+            else
+              while (n--)
+                cv_.notify_one();
+            return;
+          }
+        }
+        while (first) {
+          pool_task* next = first->next_;
+          first->run_(first, true);
+          first = next;
+        }
+      }
+
+      // Threads leave as soon as their current task is done; whatever is
+      // still queued is abandoned by join().
+      inline void stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        cv_.notify_all();
+      }
+
+      // Threads leave once the queue is empty, rather than waiting for more.
+      // Returns when they have all left; must not be called from one of them.
+      inline void join() {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          joining_ = true;
+          cv_.notify_all();
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(join_mutex_);
+          for (std::thread& t : threads_)
+            if (t.joinable())
+              t.join();
+        }
+
+        pool_task* t;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stopped_ = true;
+          t = head_;
+          head_ = tail_ = nullptr;
+        }
+        while (t) {
+          pool_task* next = t->next_;
+          t->run_(t, true);
+          t = next;
+        }
+      }
+
+    private:
+      static const thread_pool_impl*& current_pool() noexcept {
+        thread_local const thread_pool_impl* pool = nullptr;
+        return pool;
+      }
+
+      void push(pool_task* t) {
+        t->next_ = nullptr;
+        if (tail_)
+          tail_->next_ = t;
+        else
+          head_ = t;
+        tail_ = t;
+      }
+
+      inline void run() {
+        current_pool() = this;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+          cv_.wait(lock, [this] { return stopped_ || head_ || joining_; });
+          if (stopped_ || !head_)
+            return;
+
+          pool_task* t = head_;
+          head_ = t->next_;
+          if (!head_)
+            tail_ = nullptr;
+          lock.unlock();
+          t->run_(t, false);
+          lock.lock();
+        }
+      }
+
+      std::mutex mutex_;
+      std::mutex join_mutex_;
+      std::condition_variable cv_;
+      pool_task* head_ = nullptr;
+      pool_task* tail_ = nullptr;
+      bool stopped_ = false;
+      bool joining_ = false;
+      std::vector<std::thread> threads_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
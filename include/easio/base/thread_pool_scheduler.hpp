@@ -0,0 +1,313 @@
+#ifndef EASIO_BASE_THREAD_POOL_SCHEDULER_HPP
+#define EASIO_BASE_THREAD_POOL_SCHEDULER_HPP
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "base/execution/execution.hpp"
+#include "base/thread_pool_impl.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Scheduler for a thread_pool_impl. Work scheduled on it runs on one of
+    // the pool's threads, and bulk() on a sender that completes there
+    // spreads its calls over all of them.
+    class thread_pool_scheduler {
+    public:
+      // Completes on a pool thread. The operation state is the queued task
+      // itself, so scheduling allocates nothing. Completes with set_done if
+      // the pool stops before the task runs, or if the receiver asked to
+      // stop by then.
+      class schedule_sender {
+      public:
+        template <template <typename...> typename Tuple, template <typename...> typename Variant>
+        using value_types = Variant<Tuple<>>;
+
+        template <template <typename...> typename Variant>
+        using error_types = Variant<std::exception_ptr>;
+
+        static constexpr bool sends_done = true;
+
+        explicit schedule_sender(thread_pool_impl& pool) noexcept : pool_(&pool) {}
+
+        template <typename R>
+        class operation_state : private pool_task {
+        public:
+          operation_state(thread_pool_impl& pool, R&& r)
+            : pool_(pool), r_(std::move(r)) {
+            run_ = &operation_state::do_run;
+          }
+
+          operation_state(operation_state&&) = delete;
+
+          friend void tag_invoke(execution::start_t, operation_state& op) noexcept {
+            op.pool_.post(&op);
+          }
+
+        private:
+          static void do_run(pool_task* t, bool abandoned) noexcept {
+            operation_state* op = static_cast<operation_state*>(t);
+            if (abandoned || execution::get_stop_token(op->r_).stop_requested()) {
+              execution::set_done(std::move(op->r_));
+            } else {
+              try {
+                execution::set_value(std::move(op->r_));
+              } catch (...) {
+                execution::set_error(std::move(op->r_), std::current_exception());
+              }
+            }
+          }
+
+          thread_pool_impl& pool_;
+          R r_;
+        };
+
+        template <execution::receiver R>
+        friend operation_state<std::remove_cvref_t<R>> tag_invoke(
+            execution::connect_t, const schedule_sender& s, R&& r) {
+          return operation_state<std::remove_cvref_t<R>>(
+              *s.pool_, std::remove_cvref_t<R>(std::forward<R>(r)));
+        }
+
+        template <typename CPO>
+        friend thread_pool_scheduler tag_invoke(execution::get_completion_scheduler_t<CPO>,
+                                                const schedule_sender& s) noexcept {
+          return thread_pool_scheduler(*s.pool_);
+        }
+
+      private:
+        thread_pool_impl* pool_;
+      };
+
+      // bulk(s, shape, f) for a sender s that completes on the pool. The
+      // index range is cut into one chunk per thread; the thread that
+      // completed s runs the first and the others are queued together. The
+      // values are sent on from whichever thread finishes the last chunk,
+      // or the first exception thrown by f once every chunk has finished.
+      template <typename S, typename Shape, typename F>
+      class bulk_sender {
+      public:
+        template <template <typename...> typename Tuple, template <typename...> typename Variant>
+        using value_types = execution::value_types_of_t<S, Tuple, Variant>;
+
+        template <template <typename...> typename Variant>
+        using error_types = execution::error_types_of_t<
+            S, execution::_adaptors::_append_unique<Variant, std::exception_ptr>::template apply>;
+
+        static constexpr bool sends_done = execution::sender_traits<S>::sends_done;
+
+        template <typename S2, typename F2>
+        bulk_sender(thread_pool_impl& pool, S2&& s, Shape shape, F2&& f)
+          : pool_(&pool), s_(std::forward<S2>(s)), shape_(shape), f_(std::forward<F2>(f)) {}
+
+        template <typename R>
+        class operation_state;
+
+        template <typename R>
+        struct receiver {
+          operation_state<R>* op_;
+
+          template <typename... As>
+          friend void tag_invoke(execution::set_value_t, receiver&& self, As&&... as) noexcept {
+            self.op_->set_value(std::forward<As>(as)...);
+          }
+
+          template <typename E>
+          friend void tag_invoke(execution::set_error_t, receiver&& self, E&& e) noexcept {
+            execution::set_error(std::move(self.op_->r_), std::forward<E>(e));
+          }
+
+          friend void tag_invoke(execution::set_done_t, receiver&& self) noexcept {
+            execution::set_done(std::move(self.op_->r_));
+          }
+
+          friend auto tag_invoke(execution::get_stop_token_t, const receiver& self) noexcept {
+            return execution::get_stop_token(self.op_->r_);
+          }
+        };
+
+        template <typename R>
+        class operation_state {
+        public:
+          template <typename R2>
+          operation_state(thread_pool_impl& pool, S&& s, Shape shape, F&& f, R2&& r)
+            : pool_(pool), shape_(shape), f_(std::move(f)), r_(std::forward<R2>(r)),
+              child_op_(execution::connect(std::move(s), receiver<R>{this})) {}
+
+          operation_state(operation_state&&) = delete;
+
+          friend void tag_invoke(execution::start_t, operation_state& op) noexcept {
+            execution::start(op.child_op_);
+          }
+
+          using values_type = execution::value_types_of_t<
+              S, execution::_adaptors::_decayed_tuple, execution::_adaptors::_monostate_variant>;
+
+          struct chunk : pool_task {
+            operation_state* op_;
+            Shape begin_;
+            Shape end_;
+          };
+
+          template <typename... As>
+          void set_value(As&&... as) noexcept {
+            std::size_t n = 0;
+            try {
+              values_.template emplace<execution::_adaptors::_decayed_tuple<As...>>(std::forward<As>(as)...);
+              n = static_cast<std::size_t>(std::max<Shape>(shape_, 0));
+              n = std::min(n, pool_.thread_count());
+              if (n > 0)
+                chunks_.reset(new chunk[n]);
+            } catch (...) {
+              execution::set_error(std::move(r_), std::current_exception());
+              return;
+            }
+
+            if (n == 0) {
+              finish();
+              return;
+            }
+
+            // Chunk sizes differ by at most one.
+            Shape per = static_cast<Shape>(shape_ / static_cast<Shape>(n));
+            Shape extra = static_cast<Shape>(shape_ % static_cast<Shape>(n));
+            Shape begin = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+              chunk& c = chunks_[i];
+              c.run_ = &operation_state::run_chunk;
+              c.op_ = this;
+              c.begin_ = begin;
+              c.end_ = static_cast<Shape>(begin + per + (static_cast<Shape>(i) < extra ? 1 : 0));
+              c.next_ = i + 1 < n ? &chunks_[i + 1] : nullptr;
+              begin = c.end_;
+            }
+            remaining_.store(n, std::memory_order_relaxed);
+
+            if (n > 1)
+              pool_.post_list(&chunks_[1], &chunks_[n - 1], n - 1);
+            run_chunk(&chunks_[0], false);
+          }
+
+          // An abandoned chunk still runs, on the thread abandoning it, so
+          // that f sees every index and the values are sent on.
+          static void run_chunk(pool_task* t, bool) noexcept {
+            chunk* c = static_cast<chunk*>(t);
+            operation_state* op = c->op_;
+            try {
+              std::visit([&]<typename T>(T& values) {
+                if constexpr (!std::is_same_v<T, std::monostate>) {
+                  std::apply([&](auto&... as) {
+                    for (Shape i = c->begin_; i < c->end_; ++i)
+                      std::invoke(op->f_, i, as...);
+                  }, values);
+                }
+              }, op->values_);
+            } catch (...) {
+              if (!op->failed_.exchange(true, std::memory_order_relaxed))
+                op->error_ = std::current_exception();
+            }
+
+            if (op->remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+              op->finish();
+          }
+
+          void finish() noexcept {
+            chunks_.reset();
+            if (failed_.load(std::memory_order_relaxed)) {
+              execution::set_error(std::move(r_), std::move(error_));
+              return;
+            }
+
+            std::visit([this]<typename T>(T& values) {
+              if constexpr (!std::is_same_v<T, std::monostate>) {
+                std::apply([this](auto&... as) {
+                  try {
+                    execution::set_value(std::move(r_), std::move(as)...);
+                  } catch (...) {
+                    execution::set_error(std::move(r_), std::current_exception());
+                  }
+                }, values);
+              }
+            }, values_);
+          }
+
+          thread_pool_impl& pool_;
+          Shape shape_;
+          F f_;
+          R r_;
+          values_type values_;
+          std::unique_ptr<chunk[]> chunks_;
+          std::atomic<std::size_t> remaining_{0};
+          std::atomic<bool> failed_{false};
+          std::exception_ptr error_;
+          execution::connect_result_t<S, receiver<R>> child_op_;
+        };
+
+        template <execution::receiver R>
+        friend operation_state<std::remove_cvref_t<R>> tag_invoke(
+            execution::connect_t, bulk_sender&& s, R&& r) {
+          return operation_state<std::remove_cvref_t<R>>(
+              *s.pool_, std::move(s.s_), s.shape_, std::move(s.f_), std::forward<R>(r));
+        }
+
+        template <typename CPO>
+        friend thread_pool_scheduler tag_invoke(execution::get_completion_scheduler_t<CPO>,
+                                                const bulk_sender& s) noexcept {
+          return thread_pool_scheduler(*s.pool_);
+        }
+
+      private:
+        thread_pool_impl* pool_;
+        S s_;
+        Shape shape_;
+        F f_;
+      };
+
+      explicit thread_pool_scheduler(thread_pool_impl& pool) noexcept : pool_(&pool) {}
+
+      // True if the calling thread is one of the pool's.
+      bool running_in_this_thread() const noexcept {
+        return pool_->running_in_this_thread();
+      }
+
+      friend schedule_sender tag_invoke(execution::schedule_t, const thread_pool_scheduler& s) noexcept {
+        return schedule_sender(*s.pool_);
+      }
+
+      template <execution::sender S, std::integral Shape, typename F>
+      friend bulk_sender<std::remove_cvref_t<S>, Shape, std::decay_t<F>> tag_invoke(
+          execution::bulk_t, const thread_pool_scheduler& sch, S&& s, Shape shape, F&& f) {
+        return bulk_sender<std::remove_cvref_t<S>, Shape, std::decay_t<F>>(
+            *sch.pool_, std::forward<S>(s), shape, std::forward<F>(f));
+      }
+
+      friend execution::forward_progress_guarantee tag_invoke(
+          execution::get_forward_progress_guarantee_t, const thread_pool_scheduler&) noexcept {
+        return execution::forward_progress_guarantee::parallel;
+      }
+
+      friend bool operator==(const thread_pool_scheduler& a, const thread_pool_scheduler& b) noexcept {
+        return a.pool_ == b.pool_;
+      }
+
+      friend bool operator!=(const thread_pool_scheduler& a, const thread_pool_scheduler& b) noexcept {
+        return a.pool_ != b.pool_;
+      }
+
+    private:
+      thread_pool_impl* pool_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef EASIO_BASE_TIMER_QUEUE_HPP
+#define EASIO_BASE_TIMER_QUEUE_HPP
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <queue>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+#include "base/noncopyable.hpp"
+#include "base/operation.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Pending timer waits ordered by expiry. Each wait records where it
+    // sits and is linked to the other waits of the timer that started it,
+    // so cancelling a wait or a timer never searches the queue. Not thread
+    // safe; the owning context serialises access.
+    class timer_queue : private noncopyable {
+    public:
+      using clock_type = std::chrono::steady_clock;
+      using time_point = clock_type::time_point;
+
+      // Returns true if the wait is now the earliest one, in which case the
+      // context has to shorten any wait already in progress.
+      inline bool enqueue_timer(const time_point& expiry, const void* timer, wait_op_ptr op) {
+        wait_op* w = op.get();
+        auto it = timers_.emplace(expiry, std::move(op));
+        w->queue_pos_ = it;
+        w->queued_timer_ = timer;
+        w->queued_ = true;
+
+        wait_op*& head = by_timer_[timer];
+        w->prev_timer_wait_ = nullptr;
+        w->next_timer_wait_ = head;
+        if (head)
+          head->prev_timer_wait_ = w;
+        head = w;
+
+        return it == timers_.begin();
+      }
+
+      inline bool empty() const {
+        return timers_.empty();
+      }
+
+      // The earliest expiry, or time_point::max() if nothing is queued.
+      inline time_point earliest() const {
+        return timers_.empty() ? time_point::max() : timers_.begin()->first;
+      }
+
+      // Milliseconds until the earliest expiry, capped at max_msec.
+      inline long wait_duration_msec(long max_msec) const {
+        if (timers_.empty())
+          return max_msec;
+
+        auto d = std::chrono::ceil<std::chrono::milliseconds>(
+            timers_.begin()->first - clock_type::now()).count();
+        if (d <= 0)
+          return 0;
+        return d < max_msec ? static_cast<long>(d) : max_msec;
+      }
+
+      inline void get_ready_timers(std::queue<operation_ptr>& ops) {
+        const time_point now = clock_type::now();
+        while (!timers_.empty() && timers_.begin()->first <= now)
+          ops.push(remove(*timers_.begin()->second));
+      }
+
+      inline void get_all_timers(std::queue<operation_ptr>& ops) {
+        for (auto& t : timers_) {
+          t.second->queued_ = false;
+          ops.push(std::move(t.second));
+        }
+        timers_.clear();
+        by_timer_.clear();
+      }
+
+      // Moves the timer's waits to ops with ec set and returns how many.
+      inline std::size_t cancel_timer(const void* timer, const std::error_code& ec,
+                                      std::queue<operation_ptr>& ops) {
+        auto it = by_timer_.find(timer);
+        if (it == by_timer_.end())
+          return 0;
+
+        std::size_t n = 0;
+        wait_op* w = it->second;
+        by_timer_.erase(it);
+        while (w) {
+          wait_op* next = w->next_timer_wait_;
+          w->ec_ = ec;
+          w->queued_ = false;
+          ops.push(std::move(w->queue_pos_->second));
+          timers_.erase(w->queue_pos_);
+          w = next;
+          ++n;
+        }
+        return n;
+      }
+
+      // Moves a single wait to ops with ec set. Returns false if it is not
+      // queued, e.g. because it already expired.
+      inline bool cancel_timer_op(wait_op& op, const std::error_code& ec,
+                                  std::queue<operation_ptr>& ops) {
+        if (!op.queued_)
+          return false;
+
+        op.ec_ = ec;
+        ops.push(remove(op));
+        return true;
+      }
+
+    private:
+      // Takes a queued wait out of the queue and its timer's list.
+      inline wait_op_ptr remove(wait_op& op) {
+        if (op.next_timer_wait_)
+          op.next_timer_wait_->prev_timer_wait_ = op.prev_timer_wait_;
+        if (op.prev_timer_wait_) {
+          op.prev_timer_wait_->next_timer_wait_ = op.next_timer_wait_;
+        } else if (op.next_timer_wait_) {
+          by_timer_[op.queued_timer_] = op.next_timer_wait_;
+        } else {
+          by_timer_.erase(op.queued_timer_);
+        }
+
+        op.queued_ = false;
+        wait_op_ptr p = std::move(op.queue_pos_->second);
+        timers_.erase(op.queue_pos_);
+        return p;
+      }
+
+      std::multimap<time_point, wait_op_ptr> timers_;
+      std::unordered_map<const void*, wait_op*> by_timer_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef EASIO_BASE_WAIT_SENDER_HPP
+#define EASIO_BASE_WAIT_SENDER_HPP
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <type_traits>
+
+#include "base/execution/execution.hpp"
+#include "base/io_scheduler.hpp"
+#include "base/operation.hpp"
+#include "base/socket_ops.hpp"
+#include "base/timer_queue.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Completes with no values once the expiry has passed, or with an
+    // operation_aborted error if the timer is cancelled first. A stop
+    // request from the receiver removes just this wait and completes it
+    // with set_done. Like the socket senders, the operation state is the
+    // backend op.
+    template <typename Impl>
+    class wait_sender {
+    public:
+      template <template <typename...> typename Tuple, template <typename...> typename Variant>
+      using value_types = Variant<Tuple<>>;
+
+      template <template <typename...> typename Variant>
+      using error_types = Variant<std::error_code, std::exception_ptr>;
+
+      static constexpr bool sends_done = true;
+
+      wait_sender(Impl& impl, const void* timer, const timer_queue::time_point& expiry)
+        : impl_(&impl), timer_(timer), expiry_(expiry) {}
+
+      template <typename R>
+      class operation_state : public wait_op {
+      public:
+        operation_state(Impl& impl, const void* timer,
+                        const timer_queue::time_point& expiry, R&& r)
+          : wait_op(&operation_state::do_complete),
+            impl_(impl), timer_(timer), expiry_(expiry), r_(std::move(r)) {}
+
+        operation_state(operation_state&&) = delete;
+
+        friend void tag_invoke(execution::start_t, operation_state& op) noexcept {
+          auto token = execution::get_stop_token(op.r_);
+          if (token.stop_requested()) {
+            execution::set_done(std::move(op.r_));
+            return;
+          }
+          op.on_stop_.emplace(token, cancel{&op});
+          op.impl_.schedule_timer(op.expiry_, op.timer_,
+                                  std::static_pointer_cast<wait_op>(op.self()));
+        }
+
+      private:
+        struct cancel {
+          operation_state* op_;
+          void operator()() noexcept { op_->impl_.cancel_timer_op(*op_); }
+        };
+
+        static void do_complete(service_ptr owner, operation_ptr base,
+                                const std::error_code&, std::size_t) {
+          operation_state* op = static_cast<operation_state*>(base.get());
+          base.reset();
+          op->on_stop_.reset();
+
+          if (!owner || (op->ec_ == socket_ops::operation_aborted() &&
+                         execution::get_stop_token(op->r_).stop_requested())) {
+            execution::set_done(std::move(op->r_));
+          } else if (op->ec_) {
+            execution::set_error(std::move(op->r_), op->ec_);
+          } else {
+            try {
+              execution::set_value(std::move(op->r_));
+            } catch (...) {
+              execution::set_error(std::move(op->r_), std::current_exception());
+            }
+          }
+        }
+
+        Impl& impl_;
+        const void* timer_;
+        timer_queue::time_point expiry_;
+        R r_;
+        [[no_unique_address]] execution::optional_stop_callback<execution::stop_token_of_t<R>, cancel> on_stop_;
+      };
+
+      template <execution::receiver R>
+      friend operation_state<std::remove_cvref_t<R>> tag_invoke(
+          execution::connect_t, const wait_sender& s, R&& r) {
+        return operation_state<std::remove_cvref_t<R>>(
+            *s.impl_, s.timer_, s.expiry_, std::remove_cvref_t<R>(std::forward<R>(r)));
+      }
+
+      template <typename CPO>
+      friend io_scheduler<Impl> tag_invoke(execution::get_completion_scheduler_t<CPO>,
+                                           const wait_sender& s) noexcept {
+        return io_scheduler<Impl>(*s.impl_);
+      }
+
+    private:
+      Impl* impl_;
+      const void* timer_;
+      timer_queue::time_point expiry_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
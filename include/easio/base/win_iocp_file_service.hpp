@@ -0,0 +1,304 @@
+#ifndef EASIO_BASE_WIN_IOCP_FILE_SERVICE_HPP
+#define EASIO_BASE_WIN_IOCP_FILE_SERVICE_HPP
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "base/blocking_pool.hpp"
+#include "base/execution_context.hpp"
+#include "base/handler_tracking.hpp"
+#include "base/io_scheduler.hpp"
+#include "base/operation.hpp"
+#include "base/socket_ops.hpp"
+#include "base/win_iocp_io_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Regular files opened for overlapped I/O and registered with the
+    // port, so reads and writes at an offset complete like socket ops and
+    // never block a thread running the context. Flushing has no overlapped
+    // form; it runs on a small pool of blocking threads that hand the
+    // result back through the port.
+    class win_iocp_file_service
+      : public execution_context_service<win_iocp_file_service> {
+    public:
+      // Threads the pool may start for flushes. More flushes queue.
+      static const std::size_t max_blocking_threads = 4;
+
+      // Bits for open(); one of read_only, write_only or read_write.
+      enum open_flags : unsigned {
+        read_only = 1,
+        write_only = 2,
+        read_write = 4,
+        // Creates the file if it does not exist.
+        create = 8,
+        // With create, fails if the file exists.
+        exclusive = 16,
+        // Cuts an existing file to zero bytes.
+        truncate = 32
+      };
+
+      template <typename Handler>
+      class file_handler_op : public file_op {
+      public:
+        file_handler_op(op_kind kind, void* data, std::size_t size, std::uint64_t offset,
+                        Handler&& handler)
+          : file_op(&file_handler_op::do_complete, kind, data, size, offset),
+            handler_(std::move(handler)) {}
+
+      private:
+        static void do_complete(service_ptr owner, operation_ptr base,
+                                const std::error_code& ec, std::size_t bytes_transferred) {
+          file_handler_op* op = static_cast<file_handler_op*>(base.get());
+          Handler handler(std::move(op->handler_));
+          base.reset();
+
+          if (owner)
+            handler(translate_result(ec), bytes_transferred);
+        }
+
+        Handler handler_;
+      };
+
+      struct implementation_type {
+        HANDLE handle_;
+      };
+
+      inline win_iocp_file_service(execution_context& ctx)
+        : execution_context_service<win_iocp_file_service>(ctx),
+          iocp_service_(use_service<win_iocp_io_context>(ctx)),
+          pool_(max_blocking_threads) {}
+
+      // Flushes still queued fail with operation_aborted; the port's own
+      // shutdown, which comes after this one, then destroys them.
+      inline void shutdown() {
+        pool_.shutdown();
+      }
+
+      io_scheduler<win_iocp_io_context> get_scheduler() const noexcept {
+        return io_scheduler<win_iocp_io_context>(iocp_service_);
+      }
+
+      inline void construct(implementation_type& impl) {
+        impl.handle_ = INVALID_HANDLE_VALUE;
+      }
+
+      // The handle stays registered with the port, so both files must
+      // belong to this service.
+      inline void move_construct(implementation_type& impl, implementation_type& other) {
+        impl.handle_ = other.handle_;
+        other.handle_ = INVALID_HANDLE_VALUE;
+      }
+
+      inline bool is_open(const implementation_type& impl) const {
+        return impl.handle_ != INVALID_HANDLE_VALUE;
+      }
+
+      inline HANDLE native_handle(const implementation_type& impl) const {
+        return impl.handle_;
+      }
+
+      inline void open(implementation_type& impl, const std::string& path, unsigned flags,
+                       std::error_code& ec) {
+        if (is_open(impl)) {
+          ec = std::make_error_code(std::errc::already_connected);
+          return;
+        }
+
+        DWORD access = 0;
+        if (flags & (read_only | read_write))
+          access |= GENERIC_READ;
+        if (flags & (write_only | read_write))
+          access |= GENERIC_WRITE;
+
+        DWORD disposition = OPEN_EXISTING;
+        if ((flags & create) && (flags & exclusive))
+          disposition = CREATE_NEW;
+        else if ((flags & create) && (flags & truncate))
+          disposition = CREATE_ALWAYS;
+        else if (flags & create)
+          disposition = OPEN_ALWAYS;
+        else if (flags & truncate)
+          disposition = TRUNCATE_EXISTING;
+
+        HANDLE handle = ::CreateFileA(path.c_str(), access,
+                                      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                      0, disposition, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, 0);
+        if (handle == INVALID_HANDLE_VALUE) {
+          ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+          return;
+        }
+
+        assign(impl, handle, ec);
+        if (ec)
+          ::CloseHandle(handle);
+      }
+
+      // handle must have been opened with FILE_FLAG_OVERLAPPED.
+      inline void assign(implementation_type& impl, HANDLE handle, std::error_code& ec) {
+        if (is_open(impl)) {
+          ec = std::make_error_code(std::errc::already_connected);
+          return;
+        }
+
+        if (iocp_service_.register_handle(handle, ec))
+          return;
+        impl.handle_ = handle;
+      }
+
+      // Reads and writes in flight complete with operation_aborted. A flush
+      // already running finishes on its own.
+      inline void close(implementation_type& impl, std::error_code& ec) {
+        ec = std::error_code();
+        if (!is_open(impl))
+          return;
+
+        if (!::CloseHandle(impl.handle_))
+          ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+        impl.handle_ = INVALID_HANDLE_VALUE;
+      }
+
+      inline std::uint64_t size(const implementation_type& impl, std::error_code& ec) const {
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(impl.handle_, &size)) {
+          ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+          return 0;
+        }
+        ec = std::error_code();
+        return static_cast<std::uint64_t>(size.QuadPart);
+      }
+
+      template <typename Handler>
+      void async_read_at(implementation_type& impl, std::uint64_t offset,
+                         const mutable_buffer& buffer, Handler&& handler) {
+        start_file_op(impl, make_op(file_op::read, buffer.data(), buffer.size(), offset,
+                                    std::forward<Handler>(handler)));
+      }
+
+      template <typename Handler>
+      void async_write_at(implementation_type& impl, std::uint64_t offset,
+                          const const_buffer& buffer, Handler&& handler) {
+        start_file_op(impl, make_op(file_op::write, const_cast<void*>(buffer.data()),
+                                    buffer.size(), offset, std::forward<Handler>(handler)));
+      }
+
+      template <typename Handler>
+      void async_fsync(implementation_type& impl, Handler&& handler) {
+        start_file_op(impl, make_op(file_op::sync, nullptr, 0, 0, std::forward<Handler>(handler)));
+      }
+
+      // A read or write of more than 4 GiB less one byte transfers that
+      // much; the handler gets the count, as with any short transfer.
+      inline void start_file_op(implementation_type& impl, file_op_ptr op) {
+        iocp_service_.work_started();
+        handler_tracking::post(op.get(), op->type_name());
+
+        if (!is_open(impl)) {
+          iocp_service_.on_completion(op, std::make_error_code(std::errc::bad_file_descriptor));
+          return;
+        }
+
+        // The flush gets its own handle, so a close() while it waits in the
+        // pool cannot leave it with one that is gone or reused.
+        if (op->kind_ == file_op::sync) {
+          HANDLE handle = 0;
+          HANDLE process = ::GetCurrentProcess();
+          if (!::DuplicateHandle(process, impl.handle_, process, &handle, 0, FALSE,
+                                 DUPLICATE_SAME_ACCESS)) {
+            iocp_service_.on_completion(op, ::GetLastError());
+            return;
+          }
+          post_sync(handle, std::move(op));
+          return;
+        }
+
+        op->Offset = static_cast<DWORD>(op->offset_);
+        op->OffsetHigh = static_cast<DWORD>(op->offset_ >> 32);
+        DWORD size = static_cast<DWORD>(std::min<std::size_t>(op->size_, 0xFFFFFFFEu));
+        iocp_service_.on_submit(op);
+        BOOL result = op->kind_ == file_op::read
+            ? ::ReadFile(impl.handle_, op->data_, size, 0, op.get())
+            : ::WriteFile(impl.handle_, op->data_, size, 0, op.get());
+        DWORD last_error = ::GetLastError();
+        if (!result && last_error != ERROR_IO_PENDING) {
+          iocp_service_.on_completion(op, last_error, 0);
+          return;
+        }
+
+        // Issued, or done already with its completion on the way. The handle
+        // is published for cancel_op(), which may run on another thread.
+        ::InterlockedExchangePointer(&op->io_handle_, impl.handle_);
+        if (::InterlockedExchangeAdd(&op->cancel_requested_, 0) != 0)
+          ::CancelIoEx(impl.handle_, op.get());
+        iocp_service_.on_pending(op);
+      }
+
+      // A flush cannot be cancelled once it is queued. Goes through the op
+      // only, so close() may run at the same time.
+      inline void cancel_op(implementation_type&, operation& op) {
+        ::InterlockedExchange(&op.cancel_requested_, 1);
+        if (void* handle = ::InterlockedCompareExchangePointer(&op.io_handle_, 0, 0))
+          ::CancelIoEx(handle, &op);
+      }
+
+      // Reading at or past the end of the file is not an error: it reads
+      // zero bytes, as at the end of a stream.
+      static std::error_code translate_result(const std::error_code& ec) {
+        if (ec.value() == ERROR_HANDLE_EOF && ec.category() == std::system_category())
+          return std::error_code();
+        return ec;
+      }
+
+    private:
+      struct sync_task : pool_task {
+        win_iocp_file_service* service_;
+        HANDLE handle_;
+        file_op_ptr op_;
+      };
+
+      template <typename Handler>
+      static file_op_ptr make_op(file_op::op_kind kind, void* data, std::size_t size,
+                                 std::uint64_t offset, Handler&& handler) {
+        using op_type = file_handler_op<std::decay_t<Handler>>;
+        return std::make_shared<op_type>(kind, data, size, offset,
+                                         std::decay_t<Handler>(std::forward<Handler>(handler)));
+      }
+
+      inline void post_sync(HANDLE handle, file_op_ptr op) {
+        sync_task* task = new sync_task;
+        task->run_ = &run_sync;
+        task->service_ = this;
+        task->handle_ = handle;
+        task->op_ = std::move(op);
+        pool_.post(task);
+      }
+
+      // Runs on a pool thread, or on the thread stopping the pool for a
+      // flush that never got one.
+      static void run_sync(pool_task* base, bool abandoned) noexcept {
+        std::unique_ptr<sync_task> task(static_cast<sync_task*>(base));
+        std::error_code ec = socket_ops::operation_aborted();
+        if (!abandoned) {
+          ec = std::error_code();
+          if (!::FlushFileBuffers(task->handle_))
+            ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+        }
+        ::CloseHandle(task->handle_);
+        task->service_->iocp_service_.on_completion(std::move(task->op_), ec);
+      }
+
+      win_iocp_io_context& iocp_service_;
+
+      blocking_pool pool_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -2,12 +2,22 @@
 #define EASIO_BASE_WIN_IOCP_IO_CONTEXT_HPP
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <thread>
 #include <queue>
+#include <system_error>
+#include <utility>
 
+#include "base/context_metrics.hpp"
 #include "base/execution_context.hpp"
+#include "base/loop_monitor.hpp"
+#include "base/op_queue.hpp"
 #include "base/operation.hpp"
+#include "base/post_priority.hpp"
 #include "base/thread_context.hpp"
+#include "base/timer_queue.hpp"
 
 namespace easio {
   namespace base {
@@ -18,7 +28,9 @@ namespace easio {
       inline win_iocp_io_context(execution_context& ctx, int concurrency_hint = -1, bool own_thread = true)
         : execution_context_service<win_iocp_io_context>(ctx),
           outstanding_work_(0), stopped_(0), stop_event_posted_(0), shutdown_(0),
-          get_queue_compl_stat_timeout_(get_complete_status_timeout()), concurrency_hint_(concurrency_hint) {
+          get_queue_compl_stat_timeout_(get_complete_status_timeout()), dispatch_required_(0),
+          priority_pending_(0), high_streak_(0), bulk_skips_(0), normal_run_(0),
+          concurrency_hint_(concurrency_hint) {
       
         iocp_.handle = ::CreateIoCompletionPort((HANDLE)-1, 0, 0, static_cast<DWORD>(concurrency_hint_ >= 0 ? concurrency_hint_ : DWORD(~0)));
         if(!iocp_.handle) {
@@ -51,10 +63,26 @@ namespace easio {
           ::InterlockedDecrement(&outstanding_work_);
         }
 
+        {
+          std::lock_guard<std::mutex> lock(timer_mutex_);
+          timer_queue_.get_all_timers(completed_ops_);
+          update_earliest_timer();
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(priority_mutex_);
+          for (op_queue& q : priority_ops_)
+            while (!q.empty())
+              completed_ops_.push(q.pop());
+          ::InterlockedExchange(&priority_pending_, 0);
+        }
+
         while(::InterlockedExchangeAdd(&outstanding_work_, 0) > 0) {
           if (!completed_ops_.empty()) {
-            while (operation_ptr op = completed_ops_.front()) {
+            while (!completed_ops_.empty()) {
+              operation_ptr op = std::move(completed_ops_.front());
               completed_ops_.pop();
+              op->keep_alive_.reset();
               ::InterlockedDecrement(&outstanding_work_);
               op->destroy();
             }
@@ -65,8 +93,9 @@ namespace easio {
             ::GetQueuedCompletionStatus(iocp_.handle, &bytes_transferred,
                 &completion_key, &overlapped, get_queue_compl_stat_timeout_);
             if (overlapped) {
+              operation_ptr op = std::move(static_cast<operation*>(overlapped)->keep_alive_);
               ::InterlockedDecrement(&outstanding_work_);
-              static_cast<operation*>(overlapped)->destroy();
+              op->destroy();
             }
           }
         }
@@ -92,7 +121,7 @@ namespace easio {
           return 0;
         }
 
-        thread_info this_thread;
+        iocp_thread_info this_thread(this);
         thread_call_stack::context ctx(this, this_thread);
         size_t n = 0;
         while (do_one(INFINITE, this_thread, ec))
@@ -108,7 +137,7 @@ namespace easio {
           return 0;
         }
 
-        thread_info this_thread;
+        iocp_thread_info this_thread(this);
         thread_call_stack::context ctx(this, this_thread);
 
         return do_one(INFINITE, this_thread, ec);
@@ -121,7 +150,7 @@ namespace easio {
           return 0;
         }
 
-        thread_info this_thread;
+        iocp_thread_info this_thread(this);
         thread_call_stack::context ctx(this, this_thread);
 
         return do_one(usec < 0 ? INFINITE : ((usec - 1) / 1000 + 1), this_thread, ec);
@@ -148,7 +177,16 @@ namespace easio {
           stop();
       }
 
-      inline bool can_dispatch() { return thread_call_stack::contains(this) != 0; }
+      // Only the innermost run() on this thread counts, which keeps the
+      // check O(1). A handler of a nested run() of another context posts.
+      inline bool can_dispatch() { return thread_call_stack::top_if(this) != 0; }
+
+      // Runs f now if the calling thread is running this context and the
+      // dispatch depth allows it. Returns false if f has to be posted.
+      template <typename F>
+      bool dispatch_inline(F&& f) {
+        return thread_info::dispatch_inline(thread_call_stack::top_if(this), std::forward<F>(f));
+      }
 
       inline void capture_current_exception() {
         if (thread_info* this_thread = thread_call_stack::contains(this))
@@ -156,12 +194,20 @@ namespace easio {
       }
 
       void post_immediate_completion(operation_ptr op, bool) {
+        handler_tracking::post(op.get(), op->type_name());
         work_started();
         post_deferred_completion(op);
       }
 
+      // Called before an op's OVERLAPPED is handed to the kernel or posted to
+      // the port, so the op outlives the caller's reference to it.
+      inline void on_submit(const operation_ptr& op) {
+        op->keep_alive_ = op;
+      }
+
       inline void post_deferred_completion(operation_ptr op) {
         op->ready_ = 1;
+        on_submit(op);
 
         if (!::PostQueuedCompletionStatus(iocp_.handle, 0, 0, op.get())) {
           std::lock_guard<std::mutex> lock(dispatch_mutex_);
@@ -171,33 +217,124 @@ namespace easio {
       }
 
       inline void post_deferred_completions(std::queue<operation_ptr>& ops) {
-        while (operation_ptr op = ops.front()) {
+        while (!ops.empty()) {
+          operation_ptr op = std::move(ops.front());
           ops.pop();
           op->ready_ = 1;
+          on_submit(op);
 
           if (!::PostQueuedCompletionStatus(iocp_.handle, 0, 0, op.get())) {
-              std::lock_guard<std::mutex> lock(dispatch_mutex_);
-              completed_ops_.push(op);
-              completed_ops_.push(ops);
-              ::InterlockedExchange(&dispatch_required_, 1);
+            std::lock_guard<std::mutex> lock(dispatch_mutex_);
+            completed_ops_.push(op);
+            while (!ops.empty()) {
+              completed_ops_.push(std::move(ops.front()));
+              ops.pop();
+            }
+            ::InterlockedExchange(&dispatch_required_, 1);
           }
         }
       }
 
+      // From a handler running on this context, the op goes to the
+      // thread's private queue and its work is counted without an
+      // interlocked operation; see work_cleanup. Otherwise it is posted.
       void post_private_immediate_completion(operation_ptr op) {
+        if (iocp_thread_info* this_thread = private_thread()) {
+          handler_tracking::post(op.get(), op->type_name());
+          ++this_thread->private_outstanding_work_;
+          this_thread->private_op_queue_.push(std::move(op));
+          return;
+        }
         post_immediate_completion(op, false);
       }
 
+      // Completes an op that is not I/O on any handle, e.g. a memory
+      // socket's, with the given result. From a handler running on this
+      // context the op goes to the thread's private queue and no system
+      // call is made; otherwise it goes through the port as on_completion()
+      // does. Its work must already be counted.
+      void post_private_completion(operation_ptr op, const std::error_code& ec,
+                                   std::size_t bytes_transferred) {
+        if (iocp_thread_info* this_thread = private_thread()) {
+          op->Internal = reinterpret_cast<ULONG_PTR>(&ec.category());
+          op->Offset = ec.value();
+          op->OffsetHigh = static_cast<DWORD>(bytes_transferred);
+          op->has_result_ = true;
+          this_thread->private_op_queue_.push(std::move(op));
+          return;
+        }
+        on_completion(op, ec, static_cast<DWORD>(bytes_transferred));
+      }
+
       void post_private_deferred_completion(operation_ptr op) {
+        if (iocp_thread_info* this_thread = private_thread()) {
+          this_thread->private_op_queue_.push(std::move(op));
+          return;
+        }
         post_deferred_completion(op);
       }
 
+      // Queues op in its priority class; see take_priority_op(). Normal
+      // priority is an ordinary post. Only the first op to enter an empty
+      // class wakes a thread; the thread that runs it picks up the rest.
+      void post_with_priority(operation_ptr op, post_priority priority) {
+        if (priority == post_priority::normal) {
+          post_private_immediate_completion(op);
+          return;
+        }
+
+        handler_tracking::post(op.get(), op->type_name());
+        work_started();
+        bool wake;
+        {
+          std::lock_guard<std::mutex> lock(priority_mutex_);
+          op_queue& q = priority_ops_[priority_index(priority)];
+          wake = q.empty();
+          q.push(std::move(op));
+          ::InterlockedIncrement(&priority_pending_);
+        }
+        if (wake)
+          ::PostQueuedCompletionStatus(iocp_.handle, 0, wake_for_dispatch, 0);
+      }
+
+      // Queues every op in ops, which is left empty, with one constant-time
+      // splice under the lock, one interlocked work update and at most one
+      // wake-up. Normal ops bypass the port here and run in bounded runs
+      // between polls of it; see take_priority_op().
+      void post_batch(op_queue& ops, post_priority priority) {
+        if (ops.empty())
+          return;
+
+        ops.for_each([](operation& op) { handler_tracking::post(&op, op.type_name()); });
+        long n = static_cast<long>(ops.size());
+        ::InterlockedExchangeAdd(&outstanding_work_, n);
+        bool wake;
+        {
+          std::lock_guard<std::mutex> lock(priority_mutex_);
+          op_queue& q = priority_ops_[priority_index(priority)];
+          wake = q.empty();
+          q.push(ops);
+          ::InterlockedExchangeAdd(&priority_pending_, n);
+        }
+        if (wake)
+          ::PostQueuedCompletionStatus(iocp_.handle, 0, wake_for_dispatch, 0);
+      }
+
+      // Handlers waiting in a class's queue. Single normal posts go through
+      // the port with I/O completions and are not counted.
+      std::size_t queue_depth(post_priority priority) const {
+        std::lock_guard<std::mutex> lock(priority_mutex_);
+        return priority_ops_[priority_index(priority)].size();
+      }
+
       void do_dispatch(operation_ptr op) {
-        post_immediate_completion(op, false);
+        if (!dispatch_inline([&] { op->complete(service_ptr(service_ptr(), this), std::error_code(), 0); }))
+          post_immediate_completion(op, false);
       }
 
       inline void abandon_operations(std::queue<operation_ptr>& ops) {
-        while (operation_ptr op = ops.front()) {
+        while (!ops.empty()) {
+          operation_ptr op = std::move(ops.front());
           ops.pop();
           ::InterlockedDecrement(&outstanding_work_);
           op->destroy();
@@ -216,8 +353,9 @@ namespace easio {
 
       inline void on_completion(operation_ptr op, DWORD last_error = 0, DWORD bytes_transferred = 0) {
         op->ready_ = 1;
+        on_submit(op);
 
-        op->Internal = reinterpret_cast<ulong_ptr_t>(&std::system_category());
+        op->Internal = reinterpret_cast<ULONG_PTR>(&std::system_category());
         op->Offset = last_error;
         op->OffsetHigh = bytes_transferred;
 
@@ -230,8 +368,9 @@ namespace easio {
 
       inline void on_completion(operation_ptr op, const std::error_code& ec, DWORD bytes_transferred = 0) {
         op->ready_ = 1;
+        on_submit(op);
 
-        op->Internal = reinterpret_cast<ulong_ptr_t>(&ec.category());
+        op->Internal = reinterpret_cast<ULONG_PTR>(&ec.category());
         op->Offset = ec.value();
         op->OffsetHigh = bytes_transferred;
 
@@ -242,50 +381,401 @@ namespace easio {
         }
       }
 
+      // Queues a wait that completes once expiry has passed. timer identifies
+      // the waits for cancel_timer().
+      inline void schedule_timer(const timer_queue::time_point& expiry,
+                                 const void* timer, wait_op_ptr op) {
+        if (::InterlockedExchangeAdd(&shutdown_, 0) != 0) {
+          post_immediate_completion(op, false);
+          return;
+        }
+
+        handler_tracking::post(op.get(), op->type_name());
+        work_started();
+        bool earliest;
+        {
+          std::lock_guard<std::mutex> lock(timer_mutex_);
+          // A cancel_timer_op() that ran before the wait was queued.
+          if (::InterlockedExchangeAdd(&op->cancel_requested_, 0) != 0) {
+            op->ec_ = std::error_code(ERROR_OPERATION_ABORTED, std::system_category());
+            post_deferred_completion(op);
+            return;
+          }
+          earliest = timer_queue_.enqueue_timer(expiry, timer, std::move(op));
+          update_earliest_timer();
+        }
+        if (earliest)
+          update_timeout();
+      }
+
+      // Completes the timer's pending waits with operation_aborted and
+      // returns how many there were.
+      inline std::size_t cancel_timer(const void* timer) {
+        if (::InterlockedExchangeAdd(&shutdown_, 0) != 0)
+          return 0;
+
+        std::queue<operation_ptr> ops;
+        std::size_t n;
+        {
+          std::lock_guard<std::mutex> lock(timer_mutex_);
+          n = timer_queue_.cancel_timer(timer,
+              std::error_code(ERROR_OPERATION_ABORTED, std::system_category()), ops);
+          update_earliest_timer();
+        }
+        post_deferred_completions(ops);
+        return n;
+      }
+
+      // Completes one pending wait with operation_aborted. Safe to call
+      // before schedule_timer() for the same op has run.
+      inline void cancel_timer_op(wait_op& op) {
+        ::InterlockedExchange(&op.cancel_requested_, 1);
+        if (::InterlockedExchangeAdd(&shutdown_, 0) != 0)
+          return;
+
+        std::queue<operation_ptr> ops;
+        {
+          std::lock_guard<std::mutex> lock(timer_mutex_);
+          timer_queue_.cancel_timer_op(op,
+              std::error_code(ERROR_OPERATION_ABORTED, std::system_category()), ops);
+          update_earliest_timer();
+        }
+        post_deferred_completions(ops);
+      }
+
       int concurrency_hint() const { return concurrency_hint_; }
 
+      // One monitor per thread inside run(), for a watchdog.
+      const loop_registry& loops() const { return loops_; }
+
+      // Sums every thread's counters. The queue depth covers the queues
+      // outside the port; what waits in the port itself cannot be seen.
+      context_metrics metrics() {
+        context_metrics m;
+        metrics_.collect(m);
+        m.taken_at = context_metrics::clock::now();
+        m.outstanding_work = ::InterlockedExchangeAdd(&outstanding_work_, 0);
+        std::lock_guard<std::mutex> lock(priority_mutex_);
+        for (const op_queue& q : priority_ops_)
+          m.queue_depth += q.size();
+        return m;
+      }
+
     private:
+      // State of a thread inside run(). Ops its handlers post to this
+      // context wait in private_op_queue_; anything left when run() returns
+      // goes to the port for the other threads.
+      struct iocp_thread_info : thread_info {
+        explicit iocp_thread_info(win_iocp_io_context* owner)
+          : owner_(owner), private_outstanding_work_(0), private_run_count_(0),
+            loop_(owner_->loops_.acquire(::GetCurrentThreadId())) {
+          set_metrics(owner_->metrics_.acquire());
+        }
+
+        ~iocp_thread_info() {
+          if (!private_op_queue_.empty())
+            owner_->post_deferred_completions(private_op_queue_);
+          owner_->metrics_.release(metrics());
+          owner_->loops_.release(loop_);
+        }
+
+        win_iocp_io_context* owner_;
+        std::queue<operation_ptr> private_op_queue_;
+        long private_outstanding_work_;
+        int private_run_count_;
+        loop_monitor* loop_;
+      };
 
-      inline size_t do_one(DWORD msec, thread_info& this_thread, std::error_code& ec) {
+      iocp_thread_info* private_thread() {
+        return static_cast<iocp_thread_info*>(thread_call_stack::top_if(this));
+      }
+
+      inline size_t run_private_op(iocp_thread_info& this_thread, std::error_code& ec) {
+        operation_ptr op = std::move(this_thread.private_op_queue_.front());
+        this_thread.private_op_queue_.pop();
+        return run_queued_op(std::move(op), this_thread, ec);
+      }
+
+      // Runs an op that was queued outside the port; its work is already
+      // counted.
+      inline size_t run_queued_op(operation_ptr op, iocp_thread_info& this_thread, std::error_code& ec) {
+        ec = std::error_code();
+        work_cleanup on_exit = { this, &this_thread };
+        (void)on_exit;
+        handler_timer timer(this_thread.metrics());
+        (void)timer;
+        loop_monitor_scope running(this_thread.loop_, op->type_name());
+        (void)running;
+
+        std::error_code result_ec;
+        std::size_t bytes_transferred = 0;
+        if (op->has_result_)
+          take_result(*op, result_ec, bytes_transferred);
+        op->complete(service_ptr(service_ptr(), this), result_ec, bytes_transferred);
+        return 1;
+      }
+
+      // Reads back a result stored in the OVERLAPPED by on_completion() or
+      // post_private_completion().
+      static void take_result(operation& op, std::error_code& ec, std::size_t& bytes_transferred) {
+        op.has_result_ = false;
+        ec = std::error_code(static_cast<int>(op.Offset),
+                             *reinterpret_cast<std::error_category*>(op.Internal));
+        bytes_transferred = op.OffsetHigh;
+      }
+
+      inline size_t do_one(DWORD msec, iocp_thread_info& this_thread, std::error_code& ec) {
         while(true) {
+          if (this_thread.loop_)
+            this_thread.loop_->beat();
+
           if (::InterlockedCompareExchange(&dispatch_required_, 0, 1) == 1) {
             std::lock_guard<std::mutex> lock(dispatch_mutex_);
 
             post_deferred_completions(completed_ops_);
           }
 
+          // Priority ops come first; see take_priority_op().
+          bool poll = false;
+          if (::InterlockedExchangeAdd(&priority_pending_, 0) != 0) {
+            if (::InterlockedExchangeAdd(&stopped_, 0) != 0) {
+              ec = std::error_code();
+              return 0;
+            }
+
+            if (operation_ptr op = take_priority_op(false))
+              return run_queued_op(std::move(op), this_thread, ec);
+
+            // Whatever is left waits for the port to be found empty.
+            poll = true;
+          }
+
+          // Private ops only exist here when this is the only thread (see
+          // work_cleanup), so they run without going through the port. After
+          // private_poll_interval of them in a row the port is polled once,
+          // so a handler that keeps posting cannot starve I/O completions.
+          if (!this_thread.private_op_queue_.empty()) {
+            if (::InterlockedExchangeAdd(&stopped_, 0) != 0) {
+              ec = std::error_code();
+              return 0;
+            }
+
+            if (this_thread.private_run_count_ < private_poll_interval) {
+              ++this_thread.private_run_count_;
+              return run_private_op(this_thread, ec);
+            }
+
+            this_thread.private_run_count_ = 0;
+            poll = true;
+          }
+
+          // Expired waits go through the port like any other completion. The
+          // timer lock is only taken once the earliest wait has expired.
+          DWORD timeout = msec < get_queue_compl_stat_timeout_ ? msec : get_queue_compl_stat_timeout_;
+          bool timer_bounded = false;
+          timer_queue::clock_type::rep earliest = earliest_timer_.load(std::memory_order_acquire);
+          if (earliest != no_timers) {
+            long timer_wait;
+            timer_queue::time_point expiry{timer_queue::clock_type::duration(earliest)};
+            timer_queue::time_point now = timer_queue::clock_type::now();
+            if (expiry <= now) {
+              std::queue<operation_ptr> ready;
+              {
+                std::lock_guard<std::mutex> lock(timer_mutex_);
+                timer_queue_.get_ready_timers(ready);
+                update_earliest_timer();
+                timer_wait = timer_queue_.wait_duration_msec(static_cast<long>(max_timeout_msec));
+              }
+              post_deferred_completions(ready);
+            } else {
+              auto d = std::chrono::ceil<std::chrono::milliseconds>(expiry - now).count();
+              timer_wait = d < max_timeout_msec ? static_cast<long>(d) : static_cast<long>(max_timeout_msec);
+            }
+            if (static_cast<DWORD>(timer_wait) < timeout) {
+              timeout = static_cast<DWORD>(timer_wait);
+              timer_bounded = true;
+            }
+          }
+          if (poll)
+            timeout = 0;
+
           DWORD bytes_transferred = 0;
-          dword_ptr_t completion_key = 0;
+          DWORD_PTR completion_key = 0;
           LPOVERLAPPED overlapped = 0;
-          ::SetLastError(0);
-          bool ok = ::GetQueuedCompletionStatus(iocp_.handle,
-              &bytes_transferred, &completion_key, &overlapped,
-              msec < gqcs_timeout_ ? msec : gqcs_timeout_);
-          DWORD last_error = ::GetLastError();
+          bool ok;
+          DWORD last_error;
+          {
+            blocked_timer timer(this_thread.metrics());
+            (void)timer;
+            handler_tracking::wait_begin();
+            ::SetLastError(0);
+            ok = ::GetQueuedCompletionStatus(iocp_.handle,
+                &bytes_transferred, &completion_key, &overlapped, timeout);
+            last_error = ::GetLastError();
+            handler_tracking::wait_end();
+          }
           
           if (overlapped) {
             operation* op = static_cast<operation*>(overlapped);
             std::error_code result_ec(last_error, std::system_category());
+
+            // A completion from the port ends a run of normal ops; a wake-up
+            // packet does not.
+            if (poll)
+              end_normal_run();
             
-            if (completion_key == overlapped_contains_result) {
-              result_ec = std::error_code(static_cast<int>(op->Offset), *reinterpret_cast<std::error_category*>(op->Internal));
-              bytes_transferred = op->OffsetHigh;
+            // A private completion handed to the port by another thread
+            // arrives without the key but with its result.
+            if (completion_key == overlapped_contains_result || op->has_result_) {
+              std::size_t n = 0;
+              take_result(*op, result_ec, n);
+              bytes_transferred = static_cast<DWORD>(n);
             } else {
-              op->Internal = reinterpret_cast<ulong_ptr_t>(&result_ec.category());
+              op->Internal = reinterpret_cast<ULONG_PTR>(&result_ec.category());
               op->Offset = result_ec.value();
               op->OffsetHigh = bytes_transferred;
             }
+
+            // The op is only dispatched once its initiating call has returned.
+            // Until then on_pending() still needs the OVERLAPPED and will post
+            // the op again.
+            if (::InterlockedCompareExchange(&op->ready_, 1, 0) == 1) {
+              operation_ptr op_ptr = std::move(op->keep_alive_);
+              ec = std::error_code();
+              work_cleanup on_exit = { this, &this_thread };
+              (void)on_exit;
+              handler_timer timer(this_thread.metrics());
+              (void)timer;
+              loop_monitor_scope running(this_thread.loop_, op_ptr->type_name());
+              (void)running;
+
+              op_ptr->complete(service_ptr(service_ptr(), this), result_ec, bytes_transferred);
+              return 1;
+            }
+          } else if (!ok) {
+            if (last_error != WAIT_TIMEOUT) {
+              ec = std::error_code(last_error, std::system_category());
+              return 0;
+            }
+
+            if (poll && !this_thread.private_op_queue_.empty())
+              return run_private_op(this_thread, ec);
+
+            if (poll) {
+              if (operation_ptr op = take_priority_op(true))
+                return run_queued_op(std::move(op), this_thread, ec);
+              continue;
+            }
+
+            // An infinite wait only gives up for a real handler or a stop, and
+            // a wait cut short by a timer goes round again to fire it.
+            if (msec == INFINITE || timer_bounded)
+              continue;
+
+            ec = std::error_code();
+            return 0;
+          } else if (completion_key == wake_for_dispatch) {
+            // Woken to dispatch completed_ops_ or to pick up an earlier timer;
+            // both are handled at the top of the loop.
+            if (metrics_slot* slot = this_thread.metrics())
+              slot->on_wakeup();
+          } else {
+            ::InterlockedExchange(&stop_event_posted_, 0);
+
+            // Leftover stop events from an earlier run() are ignored.
+            if (::InterlockedExchangeAdd(&stopped_, 0) != 0) {
+              // Pass the stop on to the next thread blocked in GQCS.
+              if (::InterlockedExchange(&stop_event_posted_, 1) == 0) {
+                if (!::PostQueuedCompletionStatus(iocp_.handle, 0, 0, 0)) {
+                  ec = std::error_code(::GetLastError(), std::system_category());
+                  return 0;
+                }
+              }
+
+              ec = std::error_code();
+              return 0;
+            }
+          }
+        }
+      }
+
+      static std::size_t priority_index(post_priority priority) {
+        return static_cast<std::size_t>(priority);
+      }
+
+      // Picks the next queued op, or null to let the port go first.
+      // Latency-critical ops win until priority_starvation_bound of them
+      // have run in a row. Normal ops run private_poll_interval at a time
+      // until the port delivers a completion or is found idle, so a batch
+      // costs a poll per run rather than one per op. Bulk ops run
+      // once the port is found idle, or after being passed over
+      // priority_starvation_bound times.
+      inline operation_ptr take_priority_op(bool port_idle) {
+        std::lock_guard<std::mutex> lock(priority_mutex_);
+        op_queue& high = priority_ops_[priority_index(post_priority::latency_critical)];
+        op_queue& normal = priority_ops_[priority_index(post_priority::normal)];
+        op_queue& bulk = priority_ops_[priority_index(post_priority::bulk)];
+
+        op_queue* q = nullptr;
+        if (port_idle) {
+          q = !high.empty() ? &high : !normal.empty() ? &normal : !bulk.empty() ? &bulk : nullptr;
+          high_streak_ = 0;
+          normal_run_ = 0;
+        } else if (!bulk.empty() && ++bulk_skips_ >= priority_starvation_bound) {
+          q = &bulk;
+        } else if (!high.empty() && high_streak_ < priority_starvation_bound) {
+          q = &high;
+          ++high_streak_;
+        } else if (!normal.empty() && normal_run_ < private_poll_interval) {
+          q = &normal;
+          ++normal_run_;
+        } else {
+          high_streak_ = 0;
         }
+
+        if (!q)
+          return operation_ptr();
+        if (q == &bulk)
+          bulk_skips_ = 0;
+
+        operation_ptr op = q->pop();
+        ::InterlockedDecrement(&priority_pending_);
+        return op;
+      }
+
+      inline void end_normal_run() {
+        std::lock_guard<std::mutex> lock(priority_mutex_);
+        normal_run_ = 0;
       }
 
       inline static DWORD get_complete_status_timeout();
 
       inline void update_timeout();
 
-      struct work_finished_on_block_exit {
-        ~work_finished_on_block_exit() { _c->work_finished(); }
+      // Called with timer_mutex_ held after the timer queue changes.
+      void update_earliest_timer() {
+        earliest_timer_.store(timer_queue_.earliest().time_since_epoch().count(),
+                              std::memory_order_release);
+      }
+
+      // Runs when a handler returns. Settles the handler's own work and
+      // the work it posted privately in one interlocked operation. With
+      // more than one thread the private ops are then handed to the port;
+      // with a concurrency hint of 1 they stay for do_one() to run.
+      struct work_cleanup {
+        ~work_cleanup() {
+          if (_t->private_outstanding_work_ > 1)
+            ::InterlockedExchangeAdd(&_c->outstanding_work_, _t->private_outstanding_work_ - 1);
+          else if (_t->private_outstanding_work_ < 1)
+            _c->work_finished();
+          _t->private_outstanding_work_ = 0;
+
+          if (_c->concurrency_hint_ != 1 && !_t->private_op_queue_.empty())
+            _c->post_deferred_completions(_t->private_op_queue_);
+        }
 
         win_iocp_io_context* _c;
+        iocp_thread_info* _t;
       };
 
       struct auto_handle {
@@ -310,6 +800,8 @@ namespace easio {
       static const int max_timeout_usec = max_timeout_msec * 1000;
       static const int wake_for_dispatch = 1;
       static const int overlapped_contains_result = 2;
+      static const int private_poll_interval = 64;
+      static const int priority_starvation_bound = 16;
 
       const DWORD get_queue_compl_stat_timeout_;
 
@@ -317,7 +809,26 @@ namespace easio {
       std::mutex dispatch_mutex_;
       
       std::queue<operation_ptr> completed_ops_;
+
+      std::mutex timer_mutex_;
+      timer_queue timer_queue_;
+      // The queue's earliest expiry, or no_timers, so run() need not take
+      // timer_mutex_ while nothing is due.
+      std::atomic<timer_queue::clock_type::rep> earliest_timer_{no_timers};
+      static constexpr timer_queue::clock_type::rep no_timers =
+          timer_queue::time_point::max().time_since_epoch().count();
+
+      // Ops queued outside the port, one queue per post_priority, so they
+      // can be taken out of order.
+      mutable std::mutex priority_mutex_;
+      op_queue priority_ops_[3];
+      long priority_pending_;
+      int high_streak_;
+      int bulk_skips_;
+      int normal_run_;
       const int concurrency_hint_;
+      metrics_registry metrics_;
+      loop_registry loops_;
       std::unique_ptr<std::thread> thread_;
       
     };
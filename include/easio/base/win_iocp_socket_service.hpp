@@ -0,0 +1,1002 @@
+#ifndef EASIO_BASE_WIN_IOCP_SOCKET_SERVICE_HPP
+#define EASIO_BASE_WIN_IOCP_SOCKET_SERVICE_HPP
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "buffer.hpp"
+#include "base/cancellation_signal.hpp"
+#include "base/execution_context.hpp"
+#include "base/handler_ops.hpp"
+#include "base/io_scheduler.hpp"
+#include "base/operation.hpp"
+#include "base/packet_timestamp.hpp"
+#include "base/socket_ops.hpp"
+#include "base/thread_context.hpp"
+#include "base/win_iocp_io_context.hpp"
+#include "base/write_queue.hpp"
+
+#include <afunix.h>
+#include <mstcpip.h>
+#include <mswsock.h>
+
+namespace easio {
+  namespace base {
+
+    class win_iocp_socket_service
+      : public execution_context_service<win_iocp_socket_service> {
+    public:
+      // The write queue doubles as the op for its in-flight gather send, so a
+      // batch completing after the socket is gone still finds its queue.
+      class send_queue
+        : public operation,
+          public write_queue {
+      public:
+        send_queue(win_iocp_socket_service& service, socket_ops::socket_type socket)
+          : operation(&send_queue::do_complete), service_(service), socket_(socket) {
+          set_type_name("send_batch");
+        }
+
+        using operation::reset;
+
+      private:
+        friend class win_iocp_socket_service;
+
+        static void do_complete(service_ptr owner, operation_ptr base,
+                                const std::error_code& ec, std::size_t bytes_transferred) {
+          send_queue* q = static_cast<send_queue*>(base.get());
+          std::queue<operation_ptr> completed;
+          bool more = q->write_queue::complete(ec, bytes_transferred, completed);
+          if (!owner) {
+            q->service_.iocp_service_.abandon_operations(completed);
+            return;
+          }
+
+          q->service_.iocp_service_.post_deferred_completions(completed);
+          if (more)
+            q->service_.start_send_batch(*q);
+        }
+
+        win_iocp_socket_service& service_;
+        socket_ops::socket_type socket_;
+        // Held by each datagram send, from reading its transmit id to
+        // WSASendTo, so the id read is the one the stack gives it.
+        std::mutex send_to_mutex_;
+      };
+
+      // A datagram receive. The sender's address, and the control data that
+      // carries the kernel's receive timestamp when one was asked for, are
+      // written into the op, which outlives the I/O.
+      class receive_from_op : public receive_op {
+      public:
+        sockaddr_storage addr_;
+        int addr_len_;
+        DWORD flags_;
+        bool want_timestamp_;
+        WSABUF buf_;
+        WSAMSG msg_;
+        char control_[WSA_CMSG_SPACE(sizeof(UINT64))];
+
+        std::size_t address_length() const {
+          return static_cast<std::size_t>(want_timestamp_ ? msg_.namelen : addr_len_);
+        }
+
+        packet_timestamp timestamp() {
+          for (WSACMSGHDR* c = WSA_CMSG_FIRSTHDR(&msg_); c; c = WSA_CMSG_NXTHDR(&msg_, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_TIMESTAMP) {
+              UINT64 ticks = 0;
+              std::memcpy(&ticks, WSA_CMSG_DATA(c), sizeof(ticks));
+              return packet_timestamp::from_performance_counter(ticks);
+            }
+          }
+          return packet_timestamp();
+        }
+
+      protected:
+        receive_from_op(func_type func, const mutable_buffer& buffer, bool want_timestamp)
+          : receive_op(func, buffer), addr_(), addr_len_(sizeof(addr_)), flags_(0),
+            want_timestamp_(want_timestamp), buf_(), msg_() {
+          set_type_name("receive_from");
+        }
+      };
+      using receive_from_op_ptr = std::shared_ptr<receive_from_op>;
+
+      // A datagram send. With a transmit id wanted, the id the stack gives
+      // the datagram is read before it is sent; see transmit_timestamp().
+      class send_to_op : public operation {
+      public:
+        const_buffer buffer_;
+        sockaddr_storage addr_;
+        int addr_len_;
+        bool want_id_;
+        transmit_id id_;
+
+      protected:
+        send_to_op(func_type func, const const_buffer& buffer, const sockaddr* addr,
+                   std::size_t addr_len, bool want_id)
+          : operation(func), buffer_(buffer), addr_(),
+            addr_len_(static_cast<int>(std::min(addr_len, sizeof(addr_)))),
+            want_id_(want_id) {
+          std::memcpy(&addr_, addr, static_cast<std::size_t>(addr_len_));
+          set_type_name("send_to");
+        }
+      };
+      using send_to_op_ptr = std::shared_ptr<send_to_op>;
+
+      // Handlers that also take a packet_timestamp get the kernel's
+      // timestamp for the datagram; the others are called as
+      // handler(ec, bytes_transferred) and cost nothing extra.
+      template <typename Handler>
+      static constexpr bool wants_timestamp =
+          std::is_invocable_v<Handler&, const std::error_code&, std::size_t, const packet_timestamp&>;
+
+      // Send handlers that also take a transmit_id get the datagram's id,
+      // to look its timestamp up with later.
+      template <typename Handler>
+      static constexpr bool wants_transmit_id =
+          std::is_invocable_v<Handler&, const std::error_code&, std::size_t, const transmit_id&>;
+
+      template <typename Handler, typename Endpoint>
+      class receive_from_handler_op : public receive_from_op {
+      public:
+        receive_from_handler_op(const mutable_buffer& buffer, Endpoint& sender, Handler&& handler,
+                                const cancellation_slot& slot = cancellation_slot())
+          : receive_from_op(&receive_from_handler_op::do_complete, buffer, wants_timestamp<Handler>),
+            sender_(sender), handler_(std::move(handler)), slot_(slot) {}
+
+      private:
+        static void do_complete(service_ptr owner, operation_ptr base,
+                                const std::error_code& ec, std::size_t bytes_transferred) {
+          receive_from_handler_op* op = static_cast<receive_from_handler_op*>(base.get());
+          op->slot_.clear();
+          if (owner && !ec)
+            std::memcpy(op->sender_.data(), &op->addr_,
+                        std::min(op->address_length(), op->sender_.capacity()));
+          packet_timestamp ts;
+          if constexpr (wants_timestamp<Handler>) {
+            if (owner && !ec)
+              ts = op->timestamp();
+          }
+          Handler handler(std::move(op->handler_));
+          base.reset();
+
+          if (owner) {
+            if constexpr (wants_timestamp<Handler>) {
+              record_receive_delay(ts);
+              handler(ec, bytes_transferred, ts);
+            } else {
+              handler(ec, bytes_transferred);
+            }
+          }
+        }
+
+        Endpoint& sender_;
+        Handler handler_;
+        cancellation_slot slot_;
+      };
+
+      template <typename Handler>
+      class send_to_handler_op : public send_to_op {
+      public:
+        send_to_handler_op(const const_buffer& buffer, const sockaddr* addr, std::size_t addr_len,
+                           Handler&& handler)
+          : send_to_op(&send_to_handler_op::do_complete, buffer, addr, addr_len,
+                       wants_transmit_id<Handler>),
+            handler_(std::move(handler)) {}
+
+      private:
+        static void do_complete(service_ptr owner, operation_ptr base,
+                                const std::error_code& ec, std::size_t bytes_transferred) {
+          send_to_handler_op* op = static_cast<send_to_handler_op*>(base.get());
+          transmit_id id = op->id_;
+          Handler handler(std::move(op->handler_));
+          base.reset();
+
+          if (owner) {
+            if constexpr (wants_transmit_id<Handler>)
+              handler(ec, bytes_transferred, id);
+            else
+              handler(ec, bytes_transferred);
+          }
+        }
+
+        Handler handler_;
+      };
+
+      struct implementation_type {
+        implementation_type()
+          : socket_(socket_ops::invalid_socket), family_(0), connect_event_(0) {}
+
+        socket_ops::socket_type socket_;
+        int family_;
+        std::shared_ptr<send_queue> send_queue_;
+        // The event of a local connect in progress, which close() sets.
+        HANDLE connect_event_;
+      };
+
+      // Installed in a cancellation slot to pull a queued write.
+      struct cancel_send {
+        win_iocp_socket_service* service_;
+        write_op* op_;
+
+        void operator()() {
+          service_->cancel_send_op(*op_);
+        }
+      };
+
+      // Installed in a cancellation slot to abort a receive.
+      struct cancel_receive {
+        operation* op_;
+
+        void operator()() {
+          cancel_op(*op_);
+        }
+      };
+
+      inline win_iocp_socket_service(execution_context& ctx)
+        : execution_context_service<win_iocp_socket_service>(ctx),
+          iocp_service_(use_service<win_iocp_io_context>(ctx)) {
+        WSADATA wsa_data;
+        int result = ::WSAStartup(MAKEWORD(2, 2), &wsa_data);
+        if (result != 0)
+          throw std::error_code(result, std::system_category());
+      }
+
+      inline ~win_iocp_socket_service() {
+        ::WSACleanup();
+      }
+
+      // Local connects still waiting fail with operation_aborted; the
+      // port's own shutdown, which comes after this one, then destroys them.
+      inline void shutdown() {
+        std::list<local_connect> left;
+        {
+          std::lock_guard<std::mutex> lock(local_connects_mutex_);
+          left.swap(local_connects_);
+        }
+        for (local_connect& c : left) {
+          ::UnregisterWaitEx(c.wait_, INVALID_HANDLE_VALUE);
+          iocp_service_.on_completion(std::move(c.op_), socket_ops::operation_aborted());
+        }
+      }
+
+      // Every socket op completes on a thread running this context.
+      io_scheduler<win_iocp_io_context> get_scheduler() const noexcept {
+        return io_scheduler<win_iocp_io_context>(iocp_service_);
+      }
+
+      inline void construct(implementation_type& impl) {
+        impl.socket_ = socket_ops::invalid_socket;
+        impl.family_ = 0;
+      }
+
+      inline bool is_open(const implementation_type& impl) const {
+        return impl.socket_ != socket_ops::invalid_socket;
+      }
+
+      inline void open(implementation_type& impl, int family, int type,
+                       int protocol, std::error_code& ec) {
+        if (is_open(impl)) {
+          ec = std::make_error_code(std::errc::already_connected);
+          return;
+        }
+
+        socket_ops::socket_type native = open_native(family, type, protocol, ec);
+        if (ec)
+          return;
+
+        assign(impl, family, native, ec);
+        if (ec) {
+          std::error_code ignored;
+          socket_ops::close(native, ignored);
+        }
+      }
+
+      inline void bind(implementation_type& impl, const sockaddr* addr,
+                       std::size_t addrlen, std::error_code& ec) {
+        if (::bind(impl.socket_, addr, static_cast<int>(addrlen)) != 0)
+          ec = socket_ops::last_error();
+        else
+          ec = std::error_code();
+      }
+
+      inline void listen(implementation_type& impl, int backlog, std::error_code& ec) {
+        if (::listen(impl.socket_, backlog) != 0)
+          ec = socket_ops::last_error();
+        else
+          ec = std::error_code();
+      }
+
+      inline void assign(implementation_type& impl, int family,
+                         socket_ops::socket_type native, std::error_code& ec) {
+        if (is_open(impl)) {
+          ec = std::make_error_code(std::errc::already_connected);
+          return;
+        }
+
+        if (iocp_service_.register_handle(reinterpret_cast<HANDLE>(native), ec))
+          return;
+
+        impl.socket_ = native;
+        impl.family_ = family;
+        impl.send_queue_ = std::make_shared<send_queue>(*this, native);
+      }
+
+      inline void close(implementation_type& impl, std::error_code& ec) {
+        if (!is_open(impl)) {
+          ec = std::error_code();
+          return;
+        }
+
+        std::queue<operation_ptr> aborted;
+        impl.send_queue_->close(
+            std::error_code(ERROR_OPERATION_ABORTED, std::system_category()), aborted);
+        iocp_service_.post_deferred_completions(aborted);
+        impl.send_queue_.reset();
+
+        if (impl.connect_event_) {
+          ::SetEvent(impl.connect_event_);
+          impl.connect_event_ = 0;
+        }
+
+        // Closing the socket cancels the in-flight batch, which then completes
+        // with operation_aborted through the port.
+        socket_ops::close(impl.socket_, ec);
+        impl.socket_ = socket_ops::invalid_socket;
+        impl.family_ = 0;
+      }
+
+      inline socket_ops::socket_type native_handle(const implementation_type& impl) const {
+        return impl.socket_;
+      }
+
+      // The handle stays registered with the port, so both sockets must
+      // belong to this service.
+      inline void move_construct(implementation_type& impl, implementation_type& other) {
+        impl.socket_ = std::exchange(other.socket_, socket_ops::invalid_socket);
+        impl.family_ = std::exchange(other.family_, 0);
+        impl.send_queue_ = std::move(other.send_queue_);
+        impl.connect_event_ = std::exchange(other.connect_event_, HANDLE(0));
+      }
+
+      inline void move_assign(implementation_type& impl, implementation_type& other) {
+        std::error_code ignored;
+        close(impl, ignored);
+        move_construct(impl, other);
+      }
+
+      template <typename Handler>
+      void async_send(implementation_type& impl, const const_buffer& buffer, Handler&& handler) {
+        using op_type = write_handler_op<std::decay_t<Handler>>;
+        std::shared_ptr<op_type> op =
+            std::make_shared<op_type>(buffer, std::decay_t<Handler>(std::forward<Handler>(handler)));
+        start_send_op(impl, op);
+      }
+
+      // As above. Emitting the slot's signal fails the write with
+      // operation_aborted if it has not been handed to WSASend yet.
+      template <typename Handler>
+      void async_send(implementation_type& impl, const const_buffer& buffer, Handler&& handler,
+                      cancellation_slot slot) {
+        using op_type = write_handler_op<std::decay_t<Handler>>;
+        std::shared_ptr<op_type> op = std::make_shared<op_type>(
+            buffer, std::decay_t<Handler>(std::forward<Handler>(handler)), slot);
+        if (slot.is_connected())
+          slot.template emplace<cancel_send>(this, op.get());
+        start_send_op(impl, op);
+      }
+
+      template <typename Handler>
+      void async_receive(implementation_type& impl, const mutable_buffer& buffer, Handler&& handler) {
+        using op_type = receive_handler_op<std::decay_t<Handler>>;
+        start_receive_op(impl, std::make_shared<op_type>(
+            buffer, std::decay_t<Handler>(std::forward<Handler>(handler))));
+      }
+
+      // As above. Emitting the slot's signal aborts the receive, which then
+      // completes with operation_aborted.
+      template <typename Handler>
+      void async_receive(implementation_type& impl, const mutable_buffer& buffer, Handler&& handler,
+                         cancellation_slot slot) {
+        using op_type = receive_handler_op<std::decay_t<Handler>>;
+        std::shared_ptr<op_type> op = std::make_shared<op_type>(
+            buffer, std::decay_t<Handler>(std::forward<Handler>(handler)), slot);
+        if (slot.is_connected())
+          slot.template emplace<cancel_receive>(op.get());
+        start_receive_op(impl, op);
+      }
+
+      // Queues the write behind any send already in flight. Writes queued
+      // meanwhile leave together in the next WSASend.
+      inline void start_send_op(implementation_type& impl, write_op_ptr op) {
+        iocp_service_.work_started();
+        handler_tracking::post(op.get(), op->type_name());
+
+        if (!is_open(impl)) {
+          op->ec_ = std::make_error_code(std::errc::bad_file_descriptor);
+          iocp_service_.post_deferred_completion(op);
+          return;
+        }
+
+        // Published before the request is checked, so that either this
+        // call or cancel_send_op() pulls a write cancelled meanwhile. The
+        // queue gets its own reference: the batch may complete the write
+        // before the check below, and op keeps it alive until then.
+        op->queue_ = impl.send_queue_;
+        op->queue_published_.store(true);
+        if (impl.send_queue_->enqueue(op))
+          start_send_batch(*impl.send_queue_);
+        if (::InterlockedExchangeAdd(&op->cancel_requested_, 0) != 0)
+          cancel_send_op(*op);
+      }
+
+      // Cancels an outstanding receive, accept or connect, which then
+      // completes with operation_aborted. May run on any thread, and before
+      // the op has been issued; it only touches the op, never the socket.
+      inline void cancel_op(implementation_type&, operation& op) {
+        cancel_op(op);
+      }
+
+      static void cancel_op(operation& op) {
+        ::InterlockedExchange(&op.cancel_requested_, 1);
+        if (void* handle = ::InterlockedCompareExchangePointer(&op.io_handle_, 0, 0))
+          ::CancelIoEx(handle, &op);
+      }
+
+      // A local connect also wakes its wait, which then completes it.
+      inline void cancel_op(implementation_type&, connect_op& op) {
+        cancel_op(static_cast<operation&>(op));
+        if (void* event = ::InterlockedCompareExchangePointer(&op.event_, 0, 0))
+          ::SetEvent(event);
+      }
+
+      // Fails a write that is still queued behind the in-flight batch. Like
+      // cancel_op() it goes through the op, so close() or a move of the
+      // socket may run at the same time.
+      inline void cancel_send_op(implementation_type&, write_op& op) {
+        cancel_send_op(op);
+      }
+
+      inline void cancel_send_op(write_op& op) {
+        ::InterlockedExchange(&op.cancel_requested_, 1);
+        if (!op.queue_published_.load())
+          return;
+
+        std::queue<operation_ptr> aborted;
+        if (op.queue_->cancel(&op, socket_ops::operation_aborted(), aborted))
+          iocp_service_.post_deferred_completions(aborted);
+      }
+
+      inline void start_receive_op(implementation_type& impl, receive_op_ptr op) {
+        iocp_service_.work_started();
+        handler_tracking::post(op.get(), op->type_name());
+
+        if (!is_open(impl)) {
+          iocp_service_.on_completion(op, std::make_error_code(std::errc::bad_file_descriptor));
+          return;
+        }
+
+        socket_ops::buf b;
+        socket_ops::init_buf(b, op->buffer_.data(), op->buffer_.size());
+        DWORD bytes_transferred = 0;
+        DWORD flags = 0;
+        iocp_service_.on_submit(op);
+        int result = ::WSARecv(impl.socket_, &b, 1, &bytes_transferred, &flags, op.get(), 0);
+        DWORD last_error = ::WSAGetLastError();
+        if (result != 0 && last_error != WSA_IO_PENDING)
+          iocp_service_.on_completion(op, last_error, bytes_transferred);
+        else
+          on_issued(impl, op);
+      }
+
+      // The accepted socket is created up front, as AcceptEx requires, and
+      // handed to the peer by complete_accept().
+      inline void start_accept_op(implementation_type& impl, accept_op_ptr op) {
+        iocp_service_.work_started();
+        handler_tracking::post(op.get(), op->type_name());
+
+        std::error_code ec;
+        LPFN_ACCEPTEX accept_ex = get_accept_ex(impl, ec);
+        if (!ec)
+          op->new_socket_ = open_native(impl.family_, SOCK_STREAM, stream_protocol(impl.family_), ec);
+        if (ec) {
+          iocp_service_.on_completion(op, ec);
+          return;
+        }
+
+        DWORD bytes_transferred = 0;
+        iocp_service_.on_submit(op);
+        BOOL result = accept_ex(impl.socket_, op->new_socket_, op->addresses_, 0,
+                                static_cast<DWORD>(accept_op::address_length),
+                                static_cast<DWORD>(accept_op::address_length),
+                                &bytes_transferred, op.get());
+        DWORD last_error = ::WSAGetLastError();
+        if (!result && last_error != WSA_IO_PENDING)
+          iocp_service_.on_completion(op, last_error, bytes_transferred);
+        else
+          on_issued(impl, op);
+      }
+
+      inline void complete_accept(implementation_type& impl, implementation_type& peer,
+                                  accept_op& op, std::error_code& ec) {
+        if (!ec && ::setsockopt(op.new_socket_, SOL_SOCKET, SO_UPDATE_ACCEPT_CONTEXT,
+                                reinterpret_cast<const char*>(&impl.socket_),
+                                sizeof(impl.socket_)) != 0)
+          ec = socket_ops::last_error();
+
+        if (!ec)
+          assign(peer, impl.family_, op.new_socket_, ec);
+
+        if (ec && op.new_socket_ != socket_ops::invalid_socket) {
+          std::error_code ignored;
+          socket_ops::close(op.new_socket_, ignored);
+        }
+        op.new_socket_ = socket_ops::invalid_socket;
+      }
+
+      inline void start_connect_op(implementation_type& impl, connect_op_ptr op,
+                                   const sockaddr* addr, std::size_t addrlen) {
+        iocp_service_.work_started();
+        handler_tracking::post(op.get(), op->type_name());
+
+        std::error_code ec;
+        if (!is_open(impl))
+          open(impl, addr->sa_family, SOCK_STREAM, stream_protocol(addr->sa_family), ec);
+
+        if (!ec && impl.family_ == AF_UNIX) {
+          start_local_connect(impl, std::move(op), addr, addrlen);
+          return;
+        }
+
+        // ConnectEx only accepts a bound socket.
+        if (!ec) {
+          sockaddr_storage any = {};
+          any.ss_family = static_cast<ADDRESS_FAMILY>(impl.family_);
+          int any_len = impl.family_ == AF_INET ? sizeof(sockaddr_in) : sizeof(sockaddr_in6);
+          if (::bind(impl.socket_, reinterpret_cast<const sockaddr*>(&any), any_len) != 0 &&
+              ::WSAGetLastError() != WSAEINVAL)
+            ec = socket_ops::last_error();
+        }
+
+        LPFN_CONNECTEX connect_ex = ec ? nullptr : get_connect_ex(impl, ec);
+        if (ec) {
+          iocp_service_.on_completion(op, ec);
+          return;
+        }
+
+        iocp_service_.on_submit(op);
+        BOOL result = connect_ex(impl.socket_, addr, static_cast<int>(addrlen), 0, 0, 0, op.get());
+        DWORD last_error = ::WSAGetLastError();
+        if (!result && last_error != WSA_IO_PENDING)
+          iocp_service_.on_completion(op, last_error, 0);
+        else
+          on_issued(impl, op);
+      }
+
+      inline void complete_connect(implementation_type& impl, connect_op& op, std::error_code& ec) {
+        if (op.waited_) {
+          op.waited_ = false;
+          complete_local_connect(impl, op, ec);
+          return;
+        }
+        if (impl.family_ == AF_UNIX)
+          return;
+        if (!ec && ::setsockopt(impl.socket_, SOL_SOCKET, SO_UPDATE_CONNECT_CONTEXT, 0, 0) != 0)
+          ec = socket_ops::last_error();
+      }
+
+      // How many transmit timestamps the stack keeps for a socket before
+      // dropping the oldest.
+      static const USHORT max_tx_timestamps = 64;
+
+      // Asks the stack to timestamp the socket's datagrams as they arrive
+      // and leave. Needs Windows 10 version 2004 or later; the stack only
+      // timestamps UDP.
+      inline void enable_timestamps(implementation_type& impl, std::error_code& ec) {
+        TIMESTAMPING_CONFIG config = {};
+        config.Flags = TIMESTAMPING_FLAG_RX | TIMESTAMPING_FLAG_TX;
+        config.TxTimestampsBuffered = max_tx_timestamps;
+        DWORD bytes = 0;
+        if (::WSAIoctl(impl.socket_, SIO_TIMESTAMPING, &config, sizeof(config), 0, 0, &bytes, 0, 0) != 0)
+          ec = socket_ops::last_error();
+        else
+          ec = std::error_code();
+      }
+
+      // When the datagram named by id left, from the stack's transmit
+      // timestamps. The stack may stamp a datagram after its send has
+      // completed; until then this fails with would_block and can be
+      // asked again. Only the last max_tx_timestamps are kept.
+      inline packet_timestamp transmit_timestamp(const implementation_type& impl, const transmit_id& id,
+                                                 std::error_code& ec) {
+        if (!id) {
+          ec = std::make_error_code(std::errc::invalid_argument);
+          return packet_timestamp();
+        }
+
+        UINT32 value = id.value;
+        UINT64 ticks = 0;
+        DWORD bytes = 0;
+        if (::WSAIoctl(impl.socket_, SIO_GET_TX_TIMESTAMP, &value, sizeof(value),
+                       &ticks, sizeof(ticks), &bytes, 0, 0) != 0) {
+          ec = socket_ops::last_error();
+          return packet_timestamp();
+        }
+        ec = std::error_code();
+        return packet_timestamp::from_performance_counter(ticks);
+      }
+
+      // Fills info with what process_id needs to open its own handle to
+      // the socket's connection, for handing it to another process over
+      // any channel. The socket here stays open and usable.
+      inline void duplicate(const implementation_type& impl, unsigned long process_id,
+                            WSAPROTOCOL_INFOW& info, std::error_code& ec) {
+        if (::WSADuplicateSocketW(impl.socket_, process_id, &info) != 0)
+          ec = socket_ops::last_error();
+        else
+          ec = std::error_code();
+      }
+
+      // Opens a socket that another process duplicated for this one.
+      inline void open_duplicate(implementation_type& impl, const WSAPROTOCOL_INFOW& info,
+                                 std::error_code& ec) {
+        if (is_open(impl)) {
+          ec = std::make_error_code(std::errc::already_connected);
+          return;
+        }
+
+        socket_ops::socket_type native = ::WSASocketW(
+            FROM_PROTOCOL_INFO, FROM_PROTOCOL_INFO, FROM_PROTOCOL_INFO,
+            const_cast<WSAPROTOCOL_INFOW*>(&info), 0, WSA_FLAG_OVERLAPPED);
+        if (native == socket_ops::invalid_socket) {
+          ec = socket_ops::last_error();
+          return;
+        }
+
+        assign(impl, info.iAddressFamily, native, ec);
+        if (ec) {
+          std::error_code ignored;
+          socket_ops::close(native, ignored);
+        }
+      }
+
+      template <typename Handler, typename Endpoint>
+      void async_receive_from(implementation_type& impl, const mutable_buffer& buffer,
+                              Endpoint& sender, Handler&& handler) {
+        using op_type = receive_from_handler_op<std::decay_t<Handler>, Endpoint>;
+        start_receive_from_op(impl, std::make_shared<op_type>(
+            buffer, sender, std::decay_t<Handler>(std::forward<Handler>(handler))));
+      }
+
+      template <typename Handler, typename Endpoint>
+      void async_receive_from(implementation_type& impl, const mutable_buffer& buffer,
+                              Endpoint& sender, Handler&& handler, cancellation_slot slot) {
+        using op_type = receive_from_handler_op<std::decay_t<Handler>, Endpoint>;
+        std::shared_ptr<op_type> op = std::make_shared<op_type>(
+            buffer, sender, std::decay_t<Handler>(std::forward<Handler>(handler)), slot);
+        if (slot.is_connected())
+          slot.template emplace<cancel_receive>(op.get());
+        start_receive_from_op(impl, op);
+      }
+
+      template <typename Handler>
+      void async_send_to(implementation_type& impl, const const_buffer& buffer,
+                         const sockaddr* addr, std::size_t addr_len, Handler&& handler) {
+        using op_type = send_to_handler_op<std::decay_t<Handler>>;
+        start_send_to_op(impl, std::make_shared<op_type>(
+            buffer, addr, addr_len, std::decay_t<Handler>(std::forward<Handler>(handler))));
+      }
+
+      // A timestamped receive goes through WSARecvMsg, whose control data
+      // carries the timestamp; a plain one through WSARecvFrom.
+      inline void start_receive_from_op(implementation_type& impl, receive_from_op_ptr op) {
+        iocp_service_.work_started();
+        handler_tracking::post(op.get(), op->type_name());
+
+        std::error_code ec;
+        if (!is_open(impl))
+          ec = std::make_error_code(std::errc::bad_file_descriptor);
+        LPFN_WSARECVMSG recv_msg = ec || !op->want_timestamp_ ? nullptr : get_recv_msg(impl, ec);
+        if (ec) {
+          iocp_service_.on_completion(op, ec);
+          return;
+        }
+
+        socket_ops::init_buf(op->buf_, op->buffer_.data(), op->buffer_.size());
+        DWORD bytes_transferred = 0;
+        int result;
+        iocp_service_.on_submit(op);
+        if (recv_msg) {
+          op->msg_.name = reinterpret_cast<LPSOCKADDR>(&op->addr_);
+          op->msg_.namelen = sizeof(op->addr_);
+          op->msg_.lpBuffers = &op->buf_;
+          op->msg_.dwBufferCount = 1;
+          op->msg_.Control.buf = op->control_;
+          op->msg_.Control.len = sizeof(op->control_);
+          op->msg_.dwFlags = 0;
+          result = recv_msg(impl.socket_, &op->msg_, &bytes_transferred, op.get(), 0);
+        } else {
+          result = ::WSARecvFrom(impl.socket_, &op->buf_, 1, &bytes_transferred, &op->flags_,
+                                 reinterpret_cast<sockaddr*>(&op->addr_), &op->addr_len_,
+                                 op.get(), 0);
+        }
+        DWORD last_error = ::WSAGetLastError();
+        if (result != 0 && last_error != WSA_IO_PENDING)
+          iocp_service_.on_completion(op, last_error, bytes_transferred);
+        else
+          on_issued(impl, op);
+      }
+
+      // Datagrams are sent one WSASendTo each, outside the stream write
+      // queue.
+      inline void start_send_to_op(implementation_type& impl, send_to_op_ptr op) {
+        iocp_service_.work_started();
+        handler_tracking::post(op.get(), op->type_name());
+
+        if (!is_open(impl)) {
+          iocp_service_.on_completion(op, std::make_error_code(std::errc::bad_file_descriptor));
+          return;
+        }
+
+        // The stack numbers datagrams in the order they are sent, so a send
+        // from another thread must not slip between reading the id and
+        // sending; every send on the socket takes the lock.
+        std::unique_lock<std::mutex> id_lock(impl.send_queue_->send_to_mutex_);
+        if (op->want_id_) {
+          UINT32 value = 0;
+          int len = sizeof(value);
+          op->id_.valid = ::getsockopt(impl.socket_, SOL_SOCKET, SO_TIMESTAMP_ID,
+                                       reinterpret_cast<char*>(&value), &len) == 0;
+          op->id_.value = value;
+        }
+
+        socket_ops::buf b;
+        socket_ops::init_buf(b, op->buffer_.data(), op->buffer_.size());
+        DWORD bytes_transferred = 0;
+        iocp_service_.on_submit(op);
+        int result = ::WSASendTo(impl.socket_, &b, 1, &bytes_transferred, 0,
+                                 reinterpret_cast<const sockaddr*>(&op->addr_), op->addr_len_,
+                                 op.get(), 0);
+        DWORD last_error = ::WSAGetLastError();
+        id_lock.unlock();
+        if (result != 0 && last_error != WSA_IO_PENDING)
+          iocp_service_.on_completion(op, last_error, bytes_transferred);
+        else
+          on_issued(impl, op);
+      }
+
+    private:
+      // Feeds the kernel-to-handler delay of a timestamped datagram into
+      // the metrics of the thread about to run its handler.
+      static void record_receive_delay(const packet_timestamp& ts) {
+        if (!ts)
+          return;
+        thread_info* this_thread = thread_context::top_of_thread_call_stack();
+        if (this_thread && this_thread->metrics())
+          this_thread->metrics()->on_receive_delay(packet_timestamp::clock::now() - ts.time);
+      }
+
+      // The op is now with the kernel. Publishes the handle for cancel_op()
+      // and picks up a cancel_op() that ran while the op was being issued,
+      // which CancelIoEx could not have found.
+      inline void on_issued(implementation_type& impl, const operation_ptr& op) {
+        HANDLE handle = reinterpret_cast<HANDLE>(impl.socket_);
+        ::InterlockedExchangePointer(&op->io_handle_, handle);
+        if (::InterlockedExchangeAdd(&op->cancel_requested_, 0) != 0)
+          ::CancelIoEx(handle, op.get());
+        iocp_service_.on_pending(op);
+      }
+
+      inline static socket_ops::socket_type open_native(int family, int type, int protocol,
+                                                        std::error_code& ec) {
+        socket_ops::socket_type native =
+            ::WSASocketW(family, type, protocol, 0, 0, WSA_FLAG_OVERLAPPED);
+        ec = native == socket_ops::invalid_socket ? socket_ops::last_error() : std::error_code();
+        return native;
+      }
+
+      // AF_UNIX stream sockets take protocol 0.
+      static int stream_protocol(int family) noexcept {
+        return family == AF_UNIX ? 0 : IPPROTO_TCP;
+      }
+
+      // Extension pointers come from the socket's provider, so they are
+      // cached per address family. Families without a slot look them up
+      // on every call.
+      enum cached_family { cached_inet, cached_inet6, cached_unix, cached_families };
+      using extension_cache = std::atomic<void*>[cached_families];
+
+      static std::size_t cache_slot(int family) noexcept {
+        switch (family) {
+        case AF_INET: return cached_inet;
+        case AF_INET6: return cached_inet6;
+        case AF_UNIX: return cached_unix;
+        default: return cached_families;
+        }
+      }
+
+      // A local connect waiting for its event. Whoever takes it out of
+      // local_connects_ completes it: the wait's callback or shutdown().
+      struct local_connect {
+        win_iocp_socket_service* service_;
+        connect_op_ptr op_;
+        HANDLE wait_;
+      };
+
+      // ConnectEx does not take AF_UNIX sockets, and a blocking connect()
+      // waits while the listener's backlog is full. So the socket connects
+      // non-blocking, and a wait registered with the system thread pool
+      // posts the op once its FD_CONNECT event is set; no thread is held
+      // meanwhile. A cancellation or close() sets the event early.
+      inline void start_local_connect(implementation_type& impl, connect_op_ptr op,
+                                      const sockaddr* addr, std::size_t addrlen) {
+        HANDLE event = ::WSACreateEvent();
+        if (event == WSA_INVALID_EVENT) {
+          iocp_service_.on_completion(std::move(op), socket_ops::last_error());
+          return;
+        }
+
+        std::error_code ec;
+        bool pending = false;
+        if (::WSAEventSelect(impl.socket_, event, FD_CONNECT) != 0)
+          ec = socket_ops::last_error();
+        else if (::connect(impl.socket_, addr, static_cast<int>(addrlen)) != 0) {
+          if (::WSAGetLastError() == WSAEWOULDBLOCK)
+            pending = true;
+          else
+            ec = socket_ops::last_error();
+        }
+
+        // From here on the event belongs to the op, and is published for
+        // cancel_op() before the wait can see it set.
+        if (pending) {
+          op->waited_ = true;
+          impl.connect_event_ = event;
+          ::InterlockedExchangePointer(&op->event_, event);
+          if (::InterlockedExchangeAdd(&op->cancel_requested_, 0) != 0)
+            ::SetEvent(event);
+
+          std::lock_guard<std::mutex> lock(local_connects_mutex_);
+          auto c = local_connects_.insert(local_connects_.end(), local_connect{this, op, 0});
+          if (!::RegisterWaitForSingleObject(&c->wait_, event, &on_local_connect, &*c,
+                                             INFINITE, WT_EXECUTEONLYONCE)) {
+            ec = socket_ops::last_error();
+            local_connects_.erase(c);
+            op->waited_ = false;
+            impl.connect_event_ = 0;
+            pending = false;
+          }
+        } else {
+          ::CloseHandle(event);
+        }
+
+        if (!pending) {
+          restore_blocking(impl);
+          iocp_service_.on_completion(std::move(op), ec);
+        }
+      }
+
+      // Posts the op; complete_local_connect() reads the result on the
+      // thread that owns the socket.
+      static void CALLBACK on_local_connect(PVOID param, BOOLEAN) {
+        local_connect* c = static_cast<local_connect*>(param);
+        win_iocp_socket_service& service = *c->service_;
+        connect_op_ptr op;
+        {
+          std::lock_guard<std::mutex> lock(service.local_connects_mutex_);
+          auto i = std::find_if(service.local_connects_.begin(), service.local_connects_.end(),
+                                [c](const local_connect& l) { return &l == c; });
+          if (i == service.local_connects_.end())
+            return;
+          ::UnregisterWait(i->wait_);
+          op = std::move(i->op_);
+          service.local_connects_.erase(i);
+        }
+        service.iocp_service_.on_completion(std::move(op), std::error_code());
+      }
+
+      // A socket closed, or closed and reopened, while the connect waited
+      // no longer has the connect's event.
+      inline void complete_local_connect(implementation_type& impl, connect_op& op,
+                                         std::error_code& ec) {
+        bool current = impl.connect_event_ != 0 && impl.connect_event_ == op.event_;
+        if (current)
+          impl.connect_event_ = 0;
+        if (!ec && (!current || ::InterlockedExchangeAdd(&op.cancel_requested_, 0) != 0))
+          ec = socket_ops::operation_aborted();
+        if (!current)
+          return;
+
+        WSANETWORKEVENTS events = {};
+        if (!ec && ::WSAEnumNetworkEvents(impl.socket_, 0, &events) != 0)
+          ec = socket_ops::last_error();
+        else if (!ec && !(events.lNetworkEvents & FD_CONNECT))
+          ec = socket_ops::operation_aborted();
+        else if (!ec && events.iErrorCode[FD_CONNECT_BIT] != 0)
+          ec = std::error_code(events.iErrorCode[FD_CONNECT_BIT], std::system_category());
+        restore_blocking(impl);
+      }
+
+      // Undoes the event selection, which also made the socket non-blocking.
+      static void restore_blocking(implementation_type& impl) {
+        ::WSAEventSelect(impl.socket_, 0, 0);
+        u_long non_blocking = 0;
+        ::ioctlsocket(impl.socket_, FIONBIO, &non_blocking);
+      }
+
+      template <typename Function>
+      Function load_extension(implementation_type& impl, extension_cache& cache,
+                              GUID guid, std::error_code& ec) {
+        std::size_t slot = cache_slot(impl.family_);
+        void* fn = slot < cached_families ? cache[slot].load(std::memory_order_acquire) : nullptr;
+        if (!fn) {
+          DWORD bytes = 0;
+          if (::WSAIoctl(impl.socket_, SIO_GET_EXTENSION_FUNCTION_POINTER, &guid, sizeof(guid),
+                         &fn, sizeof(fn), &bytes, 0, 0) != 0) {
+            ec = socket_ops::last_error();
+            return nullptr;
+          }
+          if (slot < cached_families)
+            cache[slot].store(fn, std::memory_order_release);
+        }
+        ec = std::error_code();
+        return reinterpret_cast<Function>(fn);
+      }
+
+      inline LPFN_ACCEPTEX get_accept_ex(implementation_type& impl, std::error_code& ec) {
+        GUID guid = WSAID_ACCEPTEX;
+        return load_extension<LPFN_ACCEPTEX>(impl, accept_ex_, guid, ec);
+      }
+
+      inline LPFN_CONNECTEX get_connect_ex(implementation_type& impl, std::error_code& ec) {
+        GUID guid = WSAID_CONNECTEX;
+        return load_extension<LPFN_CONNECTEX>(impl, connect_ex_, guid, ec);
+      }
+
+      inline LPFN_WSARECVMSG get_recv_msg(implementation_type& impl, std::error_code& ec) {
+        GUID guid = WSAID_WSARECVMSG;
+        return load_extension<LPFN_WSARECVMSG>(impl, recv_msg_, guid, ec);
+      }
+
+      inline void start_send_batch(send_queue& q) {
+        socket_ops::buf bufs[write_queue::max_batch_buffers];
+        std::size_t count = q.prepare(bufs);
+        if (count == 0)
+          return;
+
+        operation_ptr op = q.self();
+        q.reset();
+        iocp_service_.work_started();
+        iocp_service_.on_submit(op);
+
+        DWORD bytes_transferred = 0;
+        int result = ::WSASend(q.socket_, bufs, static_cast<DWORD>(count),
+                               &bytes_transferred, 0, op.get(), 0);
+        DWORD last_error = ::WSAGetLastError();
+        if (result != 0 && last_error != WSA_IO_PENDING)
+          iocp_service_.on_completion(op, last_error, bytes_transferred);
+        else
+          iocp_service_.on_pending(op);
+      }
+
+      win_iocp_io_context& iocp_service_;
+      extension_cache accept_ex_ = {};
+      extension_cache connect_ex_ = {};
+      extension_cache recv_msg_ = {};
+
+      std::mutex local_connects_mutex_;
+      std::list<local_connect> local_connects_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef EASIO_BASE_WRITE_QUEUE_HPP
+#define EASIO_BASE_WRITE_QUEUE_HPP
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <queue>
+
+#include "base/noncopyable.hpp"
+#include "base/operation.hpp"
+#include "base/socket_ops.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Per-socket queue of pending writes. Only one gather send is in flight
+    // at a time; writes issued meanwhile wait here and go out together in the
+    // next batch. Each op completes once all of its bytes are sent, in the
+    // order the ops were enqueued.
+    class write_queue : private noncopyable {
+    public:
+      static const int max_batch_buffers = 64;
+
+      write_queue() : in_flight_(0), writing_(false), closed_(false) {}
+
+      // Returns true if the caller must issue a batch, false if the op will
+      // go out with the batch following the one in flight.
+      inline bool enqueue(write_op_ptr op) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ops_.push_back(std::move(op));
+        if (writing_)
+          return false;
+        writing_ = true;
+        return true;
+      }
+
+      // Fills bufs with the queued writes that make up the next batch and
+      // returns how many were used. Returns 0, and gives up the right to
+      // issue batches, if the queue was closed in the meantime.
+      inline std::size_t prepare(socket_ops::buf* bufs) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+          writing_ = false;
+          return 0;
+        }
+
+        std::size_t count = 0;
+        while (count < ops_.size() && count < static_cast<std::size_t>(max_batch_buffers)) {
+          const const_buffer& b = ops_[count]->buffer_;
+          socket_ops::init_buf(bufs[count], b.data(), b.size());
+          ++count;
+        }
+        in_flight_ = count;
+        return count;
+      }
+
+      // Spreads the result of the in-flight batch over its ops. Finished ops
+      // are moved to completed in issue order. A short send leaves the
+      // partially written op at the front for the next batch. Returns true
+      // if the caller must issue another batch.
+      inline bool complete(const std::error_code& ec, std::size_t bytes_transferred,
+                           std::queue<operation_ptr>& completed) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < in_flight_; ++i) {
+          write_op_ptr& op = ops_.front();
+          if (ec) {
+            op->ec_ = ec;
+          } else {
+            std::size_t n = bytes_transferred < op->buffer_.size()
+                ? bytes_transferred : op->buffer_.size();
+            op->buffer_ += n;
+            op->bytes_transferred_ += n;
+            bytes_transferred -= n;
+            if (op->buffer_.size() != 0)
+              break;
+          }
+          completed.push(std::move(op));
+          ops_.pop_front();
+        }
+        in_flight_ = 0;
+
+        if (ops_.empty() || closed_) {
+          writing_ = false;
+          return false;
+        }
+        return true;
+      }
+
+      // Fails every write that is not part of the in-flight batch. The batch
+      // itself is failed by its own completion.
+      inline void close(const std::error_code& ec,
+                        std::queue<operation_ptr>& completed) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        for (std::size_t i = in_flight_; i < ops_.size(); ++i) {
+          ops_[i]->ec_ = ec;
+          completed.push(std::move(ops_[i]));
+        }
+        ops_.erase(ops_.begin() + in_flight_, ops_.end());
+      }
+
+      // Fails op if it is still waiting for a batch. An op already in flight
+      // cannot be pulled out of its gather send and completes normally.
+      inline bool cancel(const write_op* op, const std::error_code& ec,
+                         std::queue<operation_ptr>& completed) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = in_flight_; i < ops_.size(); ++i) {
+          if (ops_[i].get() == op) {
+            ops_[i]->ec_ = ec;
+            completed.push(std::move(ops_[i]));
+            ops_.erase(ops_.begin() + i);
+            return true;
+          }
+        }
+        return false;
+      }
+
+    private:
+      std::mutex mutex_;
+      std::deque<write_op_ptr> ops_;
+      std::size_t in_flight_;
+      bool writing_;
+      bool closed_;
+    };
+  }  // namespace base
+}  // namespace easio
+
+#endif
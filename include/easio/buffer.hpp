@@ -0,0 +1,98 @@
+#ifndef EASIO_BUFFER_HPP
+#define EASIO_BUFFER_HPP
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace easio {
+  class mutable_buffer {
+  public:
+    mutable_buffer() noexcept : data_(nullptr), size_(0) {}
+
+    mutable_buffer(void* data, std::size_t size) noexcept
+      : data_(data), size_(size) {}
+
+    void* data() const noexcept { return data_; }
+
+    std::size_t size() const noexcept { return size_; }
+
+    mutable_buffer& operator+=(std::size_t n) noexcept {
+      std::size_t offset = n < size_ ? n : size_;
+      data_ = static_cast<char*>(data_) + offset;
+      size_ -= offset;
+      return *this;
+    }
+
+  private:
+    void* data_;
+    std::size_t size_;
+  };
+
+  class const_buffer {
+  public:
+    const_buffer() noexcept : data_(nullptr), size_(0) {}
+
+    const_buffer(const void* data, std::size_t size) noexcept
+      : data_(data), size_(size) {}
+
+    const_buffer(const mutable_buffer& b) noexcept
+      : data_(b.data()), size_(b.size()) {}
+
+    const void* data() const noexcept { return data_; }
+
+    std::size_t size() const noexcept { return size_; }
+
+    const_buffer& operator+=(std::size_t n) noexcept {
+      std::size_t offset = n < size_ ? n : size_;
+      data_ = static_cast<const char*>(data_) + offset;
+      size_ -= offset;
+      return *this;
+    }
+
+  private:
+    const void* data_;
+    std::size_t size_;
+  };
+
+  inline mutable_buffer buffer(void* data, std::size_t size) noexcept {
+    return mutable_buffer(data, size);
+  }
+
+  inline const_buffer buffer(const void* data, std::size_t size) noexcept {
+    return const_buffer(data, size);
+  }
+
+  template <typename T, std::size_t N>
+  inline mutable_buffer buffer(std::array<T, N>& data) noexcept {
+    return mutable_buffer(data.data(), data.size() * sizeof(T));
+  }
+
+  template <typename T, std::size_t N>
+  inline const_buffer buffer(const std::array<T, N>& data) noexcept {
+    return const_buffer(data.data(), data.size() * sizeof(T));
+  }
+
+  template <typename T>
+  inline mutable_buffer buffer(std::vector<T>& data) noexcept {
+    return mutable_buffer(data.data(), data.size() * sizeof(T));
+  }
+
+  template <typename T>
+  inline const_buffer buffer(const std::vector<T>& data) noexcept {
+    return const_buffer(data.data(), data.size() * sizeof(T));
+  }
+
+  inline mutable_buffer buffer(std::string& data) noexcept {
+    return mutable_buffer(data.data(), data.size());
+  }
+
+  inline const_buffer buffer(std::string_view data) noexcept {
+    return const_buffer(data.data(), data.size());
+  }
+}  // namespace easio
+
+#endif
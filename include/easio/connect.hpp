@@ -0,0 +1,273 @@
+#ifndef EASIO_CONNECT_HPP
+#define EASIO_CONNECT_HPP
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/execution/execution.hpp"
+#include "base/noncopyable.hpp"
+#include "base/socket_ops.hpp"
+#include "steady_timer.hpp"
+
+namespace easio {
+  namespace base {
+
+    // Orders connection candidates as RFC 8305 section 4 asks: families
+    // alternate, starting with the family of the first (most preferred)
+    // endpoint, and order within a family is kept.
+    template <typename Endpoint>
+    std::vector<Endpoint> interleave_endpoints(const std::vector<Endpoint>& endpoints) {
+      std::vector<Endpoint> first, second, result;
+      if (endpoints.empty())
+        return result;
+
+      for (const Endpoint& e : endpoints) {
+        if (e.is_v4() == endpoints.front().is_v4())
+          first.push_back(e);
+        else
+          second.push_back(e);
+      }
+
+      result.reserve(endpoints.size());
+      for (std::size_t i = 0; i < first.size() || i < second.size(); ++i) {
+        if (i < first.size())
+          result.push_back(first[i]);
+        if (i < second.size())
+          result.push_back(second[i]);
+      }
+      return result;
+    }
+
+    // One RFC 8305 race. Attempt k+1 waits on its own timer, armed when
+    // attempt k starts. When any running attempt fails, the timer of the
+    // earliest attempt not yet started is cancelled, so that candidate
+    // starts at once. The first success stops every
+    // other wait and connect through a shared stop source. The handler runs
+    // once they have all finished, which is also when the state is freed.
+    template <typename Socket, typename Handler>
+    class happy_eyeballs_op : private noncopyable {
+    public:
+      using endpoint_type = typename Socket::endpoint_type;
+      using duration = steady_timer::duration;
+
+      happy_eyeballs_op(Socket& socket, std::vector<endpoint_type> endpoints,
+                        const duration& delay, Handler handler)
+        : socket_(socket), endpoints_(std::move(endpoints)), delay_(delay),
+          handler_(std::move(handler)), pending_(0), done_(false), winner_(0), next_pending_(0) {
+        attempts_.reserve(endpoints_.size());
+        for (std::size_t i = 0; i < endpoints_.size(); ++i)
+          attempts_.push_back(std::make_unique<attempt>(socket_.context()));
+      }
+
+      void start() {
+        if (endpoints_.empty()) {
+          last_ec_ = std::make_error_code(std::errc::host_unreachable);
+          pending_ = 1;
+          arrive();
+          return;
+        }
+        launch(0);
+      }
+
+    private:
+      struct connect_receiver {
+        happy_eyeballs_op* op_;
+        std::size_t index_;
+
+        void complete(const std::error_code& ec) noexcept {
+          op_->on_connect(index_, ec);
+        }
+
+        execution::in_place_stop_token token() const noexcept {
+          return op_->stop_source_.get_token();
+        }
+
+        friend void tag_invoke(execution::set_value_t, connect_receiver&& self) noexcept {
+          self.complete(std::error_code());
+        }
+
+        friend void tag_invoke(execution::set_error_t, connect_receiver&& self,
+                               const std::error_code& ec) noexcept {
+          self.complete(ec);
+        }
+
+        friend void tag_invoke(execution::set_error_t, connect_receiver&& self,
+                               std::exception_ptr) noexcept {
+          self.complete(std::make_error_code(std::errc::io_error));
+        }
+
+        friend void tag_invoke(execution::set_done_t, connect_receiver&& self) noexcept {
+          self.complete(socket_ops::operation_aborted());
+        }
+
+        friend execution::in_place_stop_token tag_invoke(execution::get_stop_token_t,
+                                                         const connect_receiver& self) noexcept {
+          return self.token();
+        }
+      };
+
+      // A wait cancelled early by the previous attempt's failure completes
+      // with an error and still starts its attempt; done means we stopped.
+      struct delay_receiver {
+        happy_eyeballs_op* op_;
+        std::size_t index_;
+
+        void complete(bool expired) noexcept {
+          op_->on_delay(index_, expired);
+        }
+
+        execution::in_place_stop_token token() const noexcept {
+          return op_->stop_source_.get_token();
+        }
+
+        friend void tag_invoke(execution::set_value_t, delay_receiver&& self) noexcept {
+          self.complete(true);
+        }
+
+        template <typename E>
+        friend void tag_invoke(execution::set_error_t, delay_receiver&& self, E&&) noexcept {
+          self.complete(true);
+        }
+
+        friend void tag_invoke(execution::set_done_t, delay_receiver&& self) noexcept {
+          self.complete(false);
+        }
+
+        friend execution::in_place_stop_token tag_invoke(execution::get_stop_token_t,
+                                                         const delay_receiver& self) noexcept {
+          return self.token();
+        }
+      };
+
+      using connect_sender_type =
+          decltype(std::declval<Socket&>().async_connect(std::declval<const endpoint_type&>()));
+      using delay_sender_type = decltype(std::declval<steady_timer&>().async_wait());
+
+      struct attempt {
+        explicit attempt(execution_context& ctx) : socket_(ctx), timer_(ctx) {}
+
+        Socket socket_;
+        steady_timer timer_;
+        std::optional<execution::connect_result_t<delay_sender_type, delay_receiver>> delay_op_;
+        std::optional<execution::connect_result_t<connect_sender_type, connect_receiver>> connect_op_;
+      };
+
+      // Arms the next attempt's timer before connecting, so a connect that
+      // fails at once can still cut the delay short.
+      void launch(std::size_t k) {
+        pending_.fetch_add(k + 1 < attempts_.size() ? 2 : 1, std::memory_order_relaxed);
+
+        if (k + 1 < attempts_.size()) {
+          attempt& next = *attempts_[k + 1];
+          next.timer_.expires_after(delay_);
+          next.delay_op_.emplace(execution::_adaptors::_conv{[&] {
+            return execution::connect(next.timer_.async_wait(), delay_receiver{this, k + 1});
+          }});
+          execution::start(*next.delay_op_);
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          next_pending_ = k + 1;
+        }
+
+        attempt& a = *attempts_[k];
+        a.connect_op_.emplace(execution::_adaptors::_conv{[&] {
+          return execution::connect(a.socket_.async_connect(endpoints_[k]), connect_receiver{this, k});
+        }});
+        execution::start(*a.connect_op_);
+      }
+
+      void on_delay(std::size_t k, bool expired) {
+        if (expired) {
+          std::unique_lock<std::mutex> lock(mutex_);
+          bool start = !done_;
+          lock.unlock();
+          if (start)
+            launch(k);
+        }
+        arrive();
+      }
+
+      void on_connect(std::size_t k, const std::error_code& ec) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!ec && !done_) {
+          done_ = true;
+          winner_ = k;
+          lock.unlock();
+          stop_source_.request_stop();
+        } else if (ec) {
+          if (!done_)
+            last_ec_ = ec;
+          std::size_t next = next_pending_;
+          bool cut_short = !done_ && next < attempts_.size();
+          lock.unlock();
+          if (cut_short)
+            attempts_[next]->timer_.cancel();
+        }
+        arrive();
+      }
+
+      void arrive() {
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+          return;
+
+        std::unique_ptr<happy_eyeballs_op> self(this);
+        std::error_code ec;
+        endpoint_type endpoint;
+        if (done_) {
+          socket_ = std::move(attempts_[winner_]->socket_);
+          endpoint = endpoints_[winner_];
+        } else {
+          ec = last_ec_;
+        }
+        Handler handler(std::move(handler_));
+        self.reset();
+        handler(ec, endpoint);
+      }
+
+      Socket& socket_;
+      std::vector<endpoint_type> endpoints_;
+      duration delay_;
+      Handler handler_;
+      std::vector<std::unique_ptr<attempt>> attempts_;
+      execution::in_place_stop_source stop_source_;
+      std::atomic<std::size_t> pending_;
+      std::mutex mutex_;
+      bool done_;
+      std::size_t winner_;
+      // The earliest attempt not started yet; its timer is the armed one.
+      std::size_t next_pending_;
+      std::error_code last_ec_;
+    };
+  }  // namespace base
+
+  // Connects socket to one of endpoints, typically a resolver's results,
+  // racing the candidates as RFC 8305 ("happy eyeballs") describes: IPv6
+  // and IPv4 are interleaved, a new attempt starts every delay or as soon
+  // as the previous one fails, and the first connection wins while the
+  // rest are cancelled. The handler is called as
+  //   handler(const std::error_code& ec, const endpoint_type& endpoint)
+  // with the winning endpoint, or with the last attempt's error.
+  template <typename Socket, typename Handler>
+  void async_connect_happy_eyeballs(
+      Socket& socket, const std::vector<typename Socket::endpoint_type>& endpoints,
+      Handler&& handler,
+      const steady_timer::duration& delay = std::chrono::milliseconds(250)) {
+    using op_type = base::happy_eyeballs_op<Socket, std::decay_t<Handler>>;
+    op_type* op = new op_type(socket, base::interleave_endpoints(endpoints), delay,
+                              std::forward<Handler>(handler));
+    op->start();
+  }
+}  // namespace easio
+
+#endif
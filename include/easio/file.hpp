@@ -0,0 +1,148 @@
+#ifndef EASIO_FILE_HPP
+#define EASIO_FILE_HPP
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "buffer.hpp"
+#include "base/execution_context.hpp"
+#include "base/file_senders.hpp"
+#include "base/noncopyable.hpp"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include "base/win_iocp_file_service.hpp"
+#endif
+
+namespace easio {
+  namespace base {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    using file_service_impl = win_iocp_file_service;
+#endif
+  }  // namespace base
+
+  // A regular file read and written at explicit offsets, with every
+  // operation completing on the context instead of blocking the thread
+  // that starts it. Several reads and writes may be in flight at once.
+  class random_access_file : private base::noncopyable {
+    using service_type = base::file_service_impl;
+
+  public:
+    using native_handle_type = HANDLE;
+
+    static const unsigned read_only = service_type::read_only;
+    static const unsigned write_only = service_type::write_only;
+    static const unsigned read_write = service_type::read_write;
+    static const unsigned create = service_type::create;
+    static const unsigned exclusive = service_type::exclusive;
+    static const unsigned truncate = service_type::truncate;
+
+    explicit random_access_file(base::execution_context& ctx)
+      : service_(base::use_service<service_type>(ctx)) {
+      service_.construct(impl_);
+    }
+
+    random_access_file(base::execution_context& ctx, const std::string& path, unsigned flags)
+      : service_(base::use_service<service_type>(ctx)) {
+      service_.construct(impl_);
+      open(path, flags);
+    }
+
+    // Both files must belong to the same context.
+    random_access_file(random_access_file&& other)
+      : service_(other.service_) {
+      service_.move_construct(impl_, other.impl_);
+    }
+
+    random_access_file& operator=(random_access_file&& other) {
+      std::error_code ec;
+      service_.close(impl_, ec);
+      service_.move_construct(impl_, other.impl_);
+      return *this;
+    }
+
+    ~random_access_file() {
+      std::error_code ec;
+      service_.close(impl_, ec);
+    }
+
+    base::execution_context& context() const {
+      return service_.context();
+    }
+
+    // flags combines one of read_only, write_only and read_write with any
+    // of create, exclusive and truncate.
+    void open(const std::string& path, unsigned flags, std::error_code& ec) {
+      service_.open(impl_, path, flags, ec);
+    }
+
+    void open(const std::string& path, unsigned flags) {
+      std::error_code ec;
+      open(path, flags, ec);
+      if (ec)
+        throw ec;
+    }
+
+    void assign(native_handle_type native, std::error_code& ec) {
+      service_.assign(impl_, native, ec);
+    }
+
+    bool is_open() const {
+      return service_.is_open(impl_);
+    }
+
+    void close(std::error_code& ec) {
+      service_.close(impl_, ec);
+    }
+
+    native_handle_type native_handle() const {
+      return service_.native_handle(impl_);
+    }
+
+    std::uint64_t size(std::error_code& ec) const {
+      return service_.size(impl_, ec);
+    }
+
+    // The handler is called as handler(ec, bytes_transferred), with 0
+    // bytes at or past the end of the file.
+    template <typename Handler>
+    void async_read_at(std::uint64_t offset, const mutable_buffer& buffer, Handler&& handler) {
+      service_.async_read_at(impl_, offset, buffer, std::forward<Handler>(handler));
+    }
+
+    template <typename Handler>
+    void async_write_at(std::uint64_t offset, const const_buffer& buffer, Handler&& handler) {
+      service_.async_write_at(impl_, offset, buffer, std::forward<Handler>(handler));
+    }
+
+    // Completes once everything written so far has reached the device.
+    // The handler is called as handler(ec, 0).
+    template <typename Handler>
+    void async_fsync(Handler&& handler) {
+      service_.async_fsync(impl_, std::forward<Handler>(handler));
+    }
+
+    auto async_read_at(std::uint64_t offset, const mutable_buffer& buffer) {
+      return base::file_sender<service_type>(service_, impl_, base::file_op::read,
+                                             buffer.data(), buffer.size(), offset);
+    }
+
+    auto async_write_at(std::uint64_t offset, const const_buffer& buffer) {
+      return base::file_sender<service_type>(service_, impl_, base::file_op::write,
+                                             const_cast<void*>(buffer.data()), buffer.size(), offset);
+    }
+
+    auto async_fsync() {
+      return base::file_sender<service_type>(service_, impl_, base::file_op::sync, nullptr, 0, 0);
+    }
+
+  private:
+    service_type& service_;
+    service_type::implementation_type impl_;
+  };
+}  // namespace easio
+
+#endif
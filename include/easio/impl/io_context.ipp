@@ -2,4 +2,61 @@
 #define EASIO_IMPL_IO_CONTEXT_IPP
 #pragma once
 
-#endif
\ No newline at end of file
+#include "io_context.hpp"
+
+namespace easio {
+
+  io_context::io_context()
+    : impl_(base::make_service<base::io_context_impl>(*this, -1, false)) {
+  }
+
+  io_context::io_context(int concurrency_hint)
+    : impl_(base::make_service<base::io_context_impl>(*this, concurrency_hint, false)) {
+  }
+
+  std::size_t io_context::run() {
+    std::error_code ec;
+    std::size_t n = impl_.run(ec);
+    if (ec)
+      throw ec;
+    return n;
+  }
+
+  std::size_t io_context::run(std::error_code& ec) {
+    return impl_.run(ec);
+  }
+
+  std::size_t io_context::run_one() {
+    std::error_code ec;
+    std::size_t n = impl_.run_one(ec);
+    if (ec)
+      throw ec;
+    return n;
+  }
+
+  std::size_t io_context::run_one(std::error_code& ec) {
+    return impl_.run_one(ec);
+  }
+
+  void io_context::stop() {
+    impl_.stop();
+  }
+
+  bool io_context::stopped() const {
+    return impl_.stopped();
+  }
+
+  void io_context::restart() {
+    impl_.restart();
+  }
+
+  std::size_t io_context::queue_depth(post_priority priority) const {
+    return impl_.queue_depth(priority);
+  }
+
+  context_metrics io_context::metrics() const {
+    return impl_.metrics();
+  }
+}  // namespace easio
+
+#endif
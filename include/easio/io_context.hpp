@@ -2,10 +2,68 @@
 #define EASIO_IO_CONTEXT_HPP
 #pragma once
 
+#include <cstddef>
+#include <system_error>
+
+#include "base/execution_context.hpp"
+#include "base/io_scheduler.hpp"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include "base/win_iocp_io_context.hpp"
+#endif
+
+namespace easio {
+  namespace base {
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
-  //using io_context_impl = win_iocp_io_context;
-  //class win_iocp_overlapped_ptr;
+    using io_context_impl = win_iocp_io_context;
 #else
-  using io_context_impl = scheduler;
+    using io_context_impl = scheduler;
+#endif
+  }  // namespace base
+
+  using base::context_metrics;
+  using base::handler_tracking;
+  using base::post_priority;
+
+  class io_context : public base::execution_context {
+  public:
+    // Models execution::scheduler; schedule() completes on a thread that is
+    // running this context.
+    using executor_type = base::io_scheduler<base::io_context_impl>;
+
+    inline io_context();
+
+    inline explicit io_context(int concurrency_hint);
+
+    executor_type get_executor() noexcept {
+      return executor_type(impl_);
+    }
+
+    inline std::size_t run();
+
+    inline std::size_t run(std::error_code& ec);
+
+    inline std::size_t run_one();
+
+    inline std::size_t run_one(std::error_code& ec);
+
+    inline void stop();
+
+    inline bool stopped() const;
+
+    inline void restart();
+
+    // Handlers waiting in a priority class's queue.
+    inline std::size_t queue_depth(post_priority priority) const;
+
+    // Counters for this context, summed over the threads running it.
+    inline context_metrics metrics() const;
+
+  private:
+    base::io_context_impl& impl_;
+  };
+}  // namespace easio
+
+#include "impl/io_context.ipp"
+
 #endif
-#endif
\ No newline at end of file
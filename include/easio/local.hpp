@@ -0,0 +1,57 @@
+#ifndef EASIO_LOCAL_HPP
+#define EASIO_LOCAL_HPP
+#pragma once
+
+#include <system_error>
+
+#include "base/local_endpoint.hpp"
+#include "socket.hpp"
+
+namespace easio {
+  namespace local {
+
+    // Unix domain stream sockets, for talking to processes on the same
+    // machine without going through the network stack.
+    class stream_protocol {
+    public:
+      using endpoint = base::local_endpoint<stream_protocol>;
+      using socket = basic_stream_socket<stream_protocol>;
+      using acceptor = basic_socket_acceptor<stream_protocol>;
+
+      int family() const noexcept {
+        return AF_UNIX;
+      }
+
+      int type() const noexcept {
+        return SOCK_STREAM;
+      }
+
+      int protocol() const noexcept {
+        return 0;
+      }
+    };
+
+    // What a process sends over a local socket to hand one of its sockets
+    // to the peer: the sender calls duplicate() with the peer's process id
+    // and writes these bytes, the receiver reads them and calls
+    // assign_duplicate() on a closed socket.
+    using socket_handoff = base::socket_ops::protocol_info;
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    // The id of the process at the other end of a connected socket.
+    inline unsigned long peer_process_id(const stream_protocol::socket& s, std::error_code& ec) {
+      ULONG pid = 0;
+      DWORD bytes = 0;
+      if (::WSAIoctl(s.native_handle(), SIO_AF_UNIX_GETPEERPID, 0, 0, &pid, sizeof(pid),
+                     &bytes, 0, 0) != 0) {
+        ec = base::socket_ops::last_error();
+        return 0;
+      }
+      ec = std::error_code();
+      return pid;
+    }
+#endif
+  }  // namespace local
+}  // namespace easio
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef EASIO_MEMORY_HPP
+#define EASIO_MEMORY_HPP
+#pragma once
+
+#include <cstddef>
+#include <system_error>
+#include <utility>
+
+#include "buffer.hpp"
+#include "base/execution_context.hpp"
+#include "base/noncopyable.hpp"
+#include "base/socket_senders.hpp"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include "base/memory_socket_service.hpp"
+#endif
+
+namespace easio {
+
+  // A stream socket whose peer is another memory_socket in the same
+  // process. Bytes go through a ring buffer per direction and every
+  // completion comes from the context, never from the kernel, so protocol
+  // code can be benchmarked and stress-tested without the network. With
+  // both ends on one single-threaded context the order of completions is
+  // deterministic.
+  class memory_socket : private base::noncopyable {
+  public:
+    explicit memory_socket(base::execution_context& ctx)
+      : service_(base::use_service<service_type>(ctx)) {
+      service_.construct(impl_);
+    }
+
+    // Both sockets must belong to the same context.
+    memory_socket(memory_socket&& other)
+      : service_(other.service_) {
+      service_.move_construct(impl_, other.impl_);
+    }
+
+    memory_socket& operator=(memory_socket&& other) {
+      std::error_code ec;
+      service_.close(impl_, ec);
+      service_.move_construct(impl_, other.impl_);
+      return *this;
+    }
+
+    ~memory_socket() {
+      std::error_code ec;
+      service_.close(impl_, ec);
+    }
+
+    base::execution_context& context() const {
+      return service_.context();
+    }
+
+    bool is_open() const {
+      return service_.is_open(impl_);
+    }
+
+    // Pending reads and writes fail with operation_aborted. The peer reads
+    // what was already written, then end of file.
+    void close(std::error_code& ec) {
+      service_.close(impl_, ec);
+    }
+
+    // The handler is called as handler(ec, bytes_transferred), with 0 bytes
+    // at end of file.
+    template <typename Handler>
+    void async_read_some(const mutable_buffer& buffer, Handler&& handler) {
+      service_.async_receive(impl_, buffer, std::forward<Handler>(handler));
+    }
+
+    // Completes once the whole buffer is in the peer's ring.
+    template <typename Handler>
+    void async_write(const const_buffer& buffer, Handler&& handler) {
+      service_.async_send(impl_, buffer, std::forward<Handler>(handler));
+    }
+
+    auto async_read_some(const mutable_buffer& buffer) {
+      return base::read_some_sender<service_type>(service_, impl_, buffer);
+    }
+
+    auto async_write(const const_buffer& buffer) {
+      return base::write_sender<service_type>(service_, impl_, buffer);
+    }
+
+  private:
+    friend class memory;
+    using service_type = base::memory_socket_service;
+
+    service_type& service_;
+    service_type::implementation_type impl_;
+  };
+
+  // The in-process transport, next to tcp and udp. There are no addresses;
+  // sockets are connected in pairs.
+  class memory {
+  public:
+    using socket = memory_socket;
+
+    static const std::size_t default_capacity = base::memory_socket_service::default_capacity;
+
+    // Connects two closed sockets, which may belong to different contexts.
+    // Each direction buffers up to capacity bytes before writes wait.
+    static void connect_pair(socket& a, socket& b, std::size_t capacity,
+                             std::error_code& ec) {
+      a.service_.connect_pair(a.impl_, b.service_, b.impl_, capacity, ec);
+    }
+
+    static void connect_pair(socket& a, socket& b, std::size_t capacity = default_capacity) {
+      std::error_code ec;
+      connect_pair(a, b, capacity, ec);
+      if (ec)
+        throw ec;
+    }
+  };
+}  // namespace easio
+
+#endif
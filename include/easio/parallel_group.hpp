@@ -0,0 +1,119 @@
+#ifndef EASIO_PARALLEL_GROUP_HPP
+#define EASIO_PARALLEL_GROUP_HPP
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "base/execution/execution.hpp"
+#include "base/thread_context.hpp"
+
+namespace easio {
+  namespace base {
+
+    template <typename Handler, typename... Ss>
+    struct parallel_group_state;
+
+    template <typename Handler, typename... Ss>
+    struct parallel_group_receiver {
+      parallel_group_state<Handler, Ss...>* state_;
+
+      // The values live in the operation state, so they are moved out
+      // before the state is freed.
+      template <typename... As>
+      friend void tag_invoke(execution::set_value_t, parallel_group_receiver&& self, As&&... as) noexcept {
+        std::tuple<std::decay_t<As>...> values(std::forward<As>(as)...);
+        std::size_t index = self.state_->op_.winner();
+        Handler handler(self.take_handler());
+        std::apply([&](auto&... vs) { handler(index, std::exception_ptr(), std::move(vs)...); }, values);
+      }
+
+      template <typename E>
+      friend void tag_invoke(execution::set_error_t, parallel_group_receiver&& self, E&& e) noexcept {
+        std::exception_ptr ex;
+        if constexpr (std::is_same_v<std::decay_t<E>, std::exception_ptr>)
+          ex = std::forward<E>(e);
+        else
+          ex = std::make_exception_ptr(std::forward<E>(e));
+        std::size_t index = self.state_->op_.winner();
+        Handler handler(self.take_handler());
+        handler(index, std::move(ex));
+      }
+
+      friend void tag_invoke(execution::set_done_t, parallel_group_receiver&& self) noexcept {
+        std::size_t index = self.state_->op_.winner();
+        Handler handler(self.take_handler());
+        handler(index, std::make_exception_ptr(std::make_error_code(std::errc::operation_canceled)));
+      }
+
+      Handler take_handler() {
+        std::unique_ptr<parallel_group_state<Handler, Ss...>> state(state_);
+        return std::move(state->handler_);
+      }
+    };
+
+    // The race's shared state: the handler and the when_any operation
+    // state, which holds every child's operation state. It is one block
+    // from the parallel_group_tag cache of the starting thread.
+    template <typename Handler, typename... Ss>
+    struct parallel_group_state {
+      template <typename... Ss2>
+      parallel_group_state(Handler handler, Ss2&&... ss)
+        : handler_(std::move(handler)),
+          op_(execution::connect(execution::when_any(std::forward<Ss2>(ss)...),
+                                 parallel_group_receiver<Handler, Ss...>{this})) {}
+
+      static void* operator new(std::size_t size) {
+        return thread_info::allocate(thread_info::parallel_group_tag(),
+                                     thread_context::top_of_thread_call_stack(), size);
+      }
+
+      static void operator delete(void* pointer, std::size_t size) {
+        thread_info::deallocate(thread_info::parallel_group_tag(),
+                                thread_context::top_of_thread_call_stack(), pointer, size);
+      }
+
+      Handler handler_;
+      execution::connect_result_t<decltype(execution::when_any(std::declval<Ss>()...)),
+                                  parallel_group_receiver<Handler, Ss...>> op_;
+    };
+  }  // namespace base
+
+  // Races a group of senders, e.g. a read against a timer wait. The first
+  // one to complete decides the result and the rest are stopped through
+  // their receivers' stop tokens. The handler is called once all of them
+  // have finished, as
+  //   handler(index, std::exception_ptr(), values...)  on success
+  //   handler(index, exception)                        on error or done
+  // where index is the position of the first sender to complete. Done is
+  // reported as an operation_canceled error code.
+  template <typename... Ss>
+  class parallel_group {
+  public:
+    explicit parallel_group(Ss... ss) : ss_(std::move(ss)...) {}
+
+    template <typename Handler>
+    void async_wait(Handler&& handler) && {
+      using state_type = base::parallel_group_state<std::decay_t<Handler>, Ss...>;
+      state_type* state = std::apply(
+          [&](Ss&... ss) { return new state_type(std::forward<Handler>(handler), std::move(ss)...); },
+          ss_);
+      base::execution::start(state->op_);
+    }
+
+  private:
+    std::tuple<Ss...> ss_;
+  };
+
+  template <typename... Ss>
+  parallel_group<std::decay_t<Ss>...> make_parallel_group(Ss&&... ss) {
+    return parallel_group<std::decay_t<Ss>...>(std::forward<Ss>(ss)...);
+  }
+}  // namespace easio
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef EASIO_SHM_HPP
+#define EASIO_SHM_HPP
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "buffer.hpp"
+#include "base/execution_context.hpp"
+#include "base/noncopyable.hpp"
+#include "base/socket_senders.hpp"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include "base/shm_channel_service.hpp"
+#endif
+
+namespace easio {
+
+  // A byte stream to another process on the same machine through shared
+  // memory. One process creates the channel under a name and one other
+  // process opens it; reads and writes then complete on each side's
+  // context like a socket's, without a system call while neither side
+  // has to wait for the other.
+  class shm_channel : private base::noncopyable {
+  public:
+    static const std::size_t default_capacity = base::shm_channel_service::default_capacity;
+
+    explicit shm_channel(base::execution_context& ctx)
+      : service_(base::use_service<service_type>(ctx)) {
+      service_.construct(impl_);
+    }
+
+    // Both channels must belong to the same context.
+    shm_channel(shm_channel&& other)
+      : service_(other.service_) {
+      service_.move_construct(impl_, other.impl_);
+    }
+
+    shm_channel& operator=(shm_channel&& other) {
+      std::error_code ec;
+      service_.close(impl_, ec);
+      service_.move_construct(impl_, other.impl_);
+      return *this;
+    }
+
+    ~shm_channel() {
+      std::error_code ec;
+      service_.close(impl_, ec);
+    }
+
+    base::execution_context& context() const {
+      return service_.context();
+    }
+
+    // Each direction buffers up to capacity bytes, rounded up to a power
+    // of two, before writes wait. Fails with address_in_use if the name is
+    // taken.
+    void create(const std::string& name, std::size_t capacity, std::error_code& ec) {
+      service_.create(impl_, name, capacity, ec);
+    }
+
+    void create(const std::string& name, std::size_t capacity = default_capacity) {
+      std::error_code ec;
+      create(name, capacity, ec);
+      if (ec)
+        throw ec;
+    }
+
+    void open(const std::string& name, std::error_code& ec) {
+      service_.open(impl_, name, ec);
+    }
+
+    void open(const std::string& name) {
+      std::error_code ec;
+      open(name, ec);
+      if (ec)
+        throw ec;
+    }
+
+    bool is_open() const {
+      return service_.is_open(impl_);
+    }
+
+    // Pending reads and writes fail with operation_aborted. The peer reads
+    // what was already written, then end of file.
+    void close(std::error_code& ec) {
+      service_.close(impl_, ec);
+    }
+
+    // The handler is called as handler(ec, bytes_transferred), with 0 bytes
+    // at end of file.
+    template <typename Handler>
+    void async_read_some(const mutable_buffer& buffer, Handler&& handler) {
+      service_.async_receive(impl_, buffer, std::forward<Handler>(handler));
+    }
+
+    // Completes once the whole buffer is in the ring.
+    template <typename Handler>
+    void async_write(const const_buffer& buffer, Handler&& handler) {
+      service_.async_send(impl_, buffer, std::forward<Handler>(handler));
+    }
+
+    auto async_read_some(const mutable_buffer& buffer) {
+      return base::read_some_sender<service_type>(service_, impl_, buffer);
+    }
+
+    auto async_write(const const_buffer& buffer) {
+      return base::write_sender<service_type>(service_, impl_, buffer);
+    }
+
+  private:
+    using service_type = base::shm_channel_service;
+
+    service_type& service_;
+    service_type::implementation_type impl_;
+  };
+}  // namespace easio
+
+#endif
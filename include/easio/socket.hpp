@@ -0,0 +1,337 @@
+#ifndef EASIO_SOCKET_HPP
+#define EASIO_SOCKET_HPP
+#pragma once
+
+#include <system_error>
+#include <utility>
+
+#include "buffer.hpp"
+#include "base/cancellation_signal.hpp"
+#include "base/execution_context.hpp"
+#include "base/noncopyable.hpp"
+#include "base/packet_timestamp.hpp"
+#include "base/socket_ops.hpp"
+#include "base/socket_senders.hpp"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include "base/win_iocp_socket_service.hpp"
+#endif
+
+namespace easio {
+  namespace base {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    using socket_service_impl = win_iocp_socket_service;
+#endif
+  }  // namespace base
+
+  using base::packet_timestamp;
+  using base::transmit_id;
+
+  template <typename Protocol>
+  class basic_socket_acceptor;
+
+  template <typename Protocol>
+  class basic_stream_socket : private noncopyable {
+  public:
+    using protocol_type = Protocol;
+    using endpoint_type = typename Protocol::endpoint;
+    using native_handle_type = base::socket_ops::socket_type;
+
+    explicit basic_stream_socket(base::execution_context& ctx)
+      : service_(base::use_service<service_type>(ctx)) {
+      service_.construct(impl_);
+    }
+
+    basic_stream_socket(base::execution_context& ctx, const protocol_type& protocol,
+                        native_handle_type native)
+      : service_(base::use_service<service_type>(ctx)) {
+      service_.construct(impl_);
+      std::error_code ec;
+      service_.assign(impl_, protocol.family(), native, ec);
+      if (ec)
+        throw ec;
+    }
+
+    // Both sockets must belong to the same context.
+    basic_stream_socket(basic_stream_socket&& other)
+      : service_(other.service_) {
+      service_.construct(impl_);
+      service_.move_construct(impl_, other.impl_);
+    }
+
+    basic_stream_socket& operator=(basic_stream_socket&& other) {
+      if (this != &other)
+        service_.move_assign(impl_, other.impl_);
+      return *this;
+    }
+
+    ~basic_stream_socket() {
+      std::error_code ec;
+      service_.close(impl_, ec);
+    }
+
+    base::execution_context& context() const {
+      return service_.context();
+    }
+
+    void open(const protocol_type& protocol, std::error_code& ec) {
+      service_.open(impl_, protocol.family(), protocol.type(), protocol.protocol(), ec);
+    }
+
+    void assign(const protocol_type& protocol, native_handle_type native, std::error_code& ec) {
+      service_.assign(impl_, protocol.family(), native, ec);
+    }
+
+    bool is_open() const {
+      return service_.is_open(impl_);
+    }
+
+    void close(std::error_code& ec) {
+      service_.close(impl_, ec);
+    }
+
+    native_handle_type native_handle() const {
+      return service_.native_handle(impl_);
+    }
+
+    // Fills info so that process_id can open the same connection with
+    // assign_duplicate. This socket stays open; the connection lasts until
+    // both are closed.
+    void duplicate(unsigned long process_id, base::socket_ops::protocol_info& info,
+                   std::error_code& ec) const {
+      service_.duplicate(impl_, process_id, info, ec);
+    }
+
+    void assign_duplicate(const base::socket_ops::protocol_info& info, std::error_code& ec) {
+      service_.open_duplicate(impl_, info, ec);
+    }
+
+    // Completes once the whole buffer has been sent. Writes started while an
+    // earlier one is still in flight are coalesced into a single gather send,
+    // and their handlers run in the order the writes were started.
+    template <typename Handler>
+    void async_write(const const_buffer& buffer, Handler&& handler) {
+      service_.async_send(impl_, buffer, std::forward<Handler>(handler));
+    }
+
+    // As above; emitting slot's signal fails the write with
+    // operation_aborted if it is still queued behind an in-flight send.
+    template <typename Handler>
+    void async_write(const const_buffer& buffer, Handler&& handler,
+                     base::cancellation_slot slot) {
+      service_.async_send(impl_, buffer, std::forward<Handler>(handler), slot);
+    }
+
+    // The handler is called as handler(ec, bytes_transferred).
+    template <typename Handler>
+    void async_read_some(const mutable_buffer& buffer, Handler&& handler) {
+      service_.async_receive(impl_, buffer, std::forward<Handler>(handler));
+    }
+
+    // As above; emitting slot's signal aborts the read, which completes
+    // with operation_aborted.
+    template <typename Handler>
+    void async_read_some(const mutable_buffer& buffer, Handler&& handler,
+                         base::cancellation_slot slot) {
+      service_.async_receive(impl_, buffer, std::forward<Handler>(handler), slot);
+    }
+
+    // Sender forms. Each connects to an operation state that embeds the
+    // backend op, so no allocation happens when it is started.
+    auto async_write(const const_buffer& buffer) {
+      return base::write_sender<service_type>(service_, impl_, buffer);
+    }
+
+    auto async_read_some(const mutable_buffer& buffer) {
+      return base::read_some_sender<service_type>(service_, impl_, buffer);
+    }
+
+    auto async_connect(const endpoint_type& endpoint) {
+      return base::connect_sender<service_type, endpoint_type>(service_, impl_, endpoint);
+    }
+
+  private:
+    friend class basic_socket_acceptor<Protocol>;
+    using service_type = base::socket_service_impl;
+
+    service_type& service_;
+    typename service_type::implementation_type impl_;
+  };
+
+  template <typename Protocol>
+  class basic_socket_acceptor : private noncopyable {
+  public:
+    using protocol_type = Protocol;
+    using endpoint_type = typename Protocol::endpoint;
+    using native_handle_type = base::socket_ops::socket_type;
+
+    explicit basic_socket_acceptor(base::execution_context& ctx)
+      : service_(base::use_service<service_type>(ctx)) {
+      service_.construct(impl_);
+    }
+
+    // Opens, binds and listens on the endpoint.
+    basic_socket_acceptor(base::execution_context& ctx, const endpoint_type& endpoint,
+                          int backlog = SOMAXCONN)
+      : service_(base::use_service<service_type>(ctx)) {
+      service_.construct(impl_);
+      std::error_code ec;
+      open(endpoint.protocol(), ec);
+      if (!ec)
+        bind(endpoint, ec);
+      if (!ec)
+        listen(backlog, ec);
+      if (ec) {
+        std::error_code ignored;
+        service_.close(impl_, ignored);
+        throw ec;
+      }
+    }
+
+    ~basic_socket_acceptor() {
+      std::error_code ec;
+      service_.close(impl_, ec);
+    }
+
+    void open(const protocol_type& protocol, std::error_code& ec) {
+      service_.open(impl_, protocol.family(), protocol.type(), protocol.protocol(), ec);
+    }
+
+    void bind(const endpoint_type& endpoint, std::error_code& ec) {
+      service_.bind(impl_, endpoint.data(), endpoint.size(), ec);
+    }
+
+    void listen(int backlog, std::error_code& ec) {
+      service_.listen(impl_, backlog, ec);
+    }
+
+    bool is_open() const {
+      return service_.is_open(impl_);
+    }
+
+    void close(std::error_code& ec) {
+      service_.close(impl_, ec);
+    }
+
+    native_handle_type native_handle() const {
+      return service_.native_handle(impl_);
+    }
+
+    // Completes once the new connection has been assigned to peer.
+    auto async_accept(basic_stream_socket<Protocol>& peer) {
+      return base::accept_sender<service_type>(service_, impl_, peer.impl_);
+    }
+
+  private:
+    using service_type = base::socket_service_impl;
+
+    service_type& service_;
+    typename service_type::implementation_type impl_;
+  };
+
+  template <typename Protocol>
+  class basic_datagram_socket : private noncopyable {
+  public:
+    using protocol_type = Protocol;
+    using endpoint_type = typename Protocol::endpoint;
+    using native_handle_type = base::socket_ops::socket_type;
+
+    explicit basic_datagram_socket(base::execution_context& ctx)
+      : service_(base::use_service<service_type>(ctx)) {
+      service_.construct(impl_);
+    }
+
+    // Opens the socket and binds it to the endpoint.
+    basic_datagram_socket(base::execution_context& ctx, const endpoint_type& endpoint)
+      : service_(base::use_service<service_type>(ctx)) {
+      service_.construct(impl_);
+      std::error_code ec;
+      open(endpoint.protocol(), ec);
+      if (!ec)
+        bind(endpoint, ec);
+      if (ec) {
+        std::error_code ignored;
+        service_.close(impl_, ignored);
+        throw ec;
+      }
+    }
+
+    ~basic_datagram_socket() {
+      std::error_code ec;
+      service_.close(impl_, ec);
+    }
+
+    base::execution_context& context() const {
+      return service_.context();
+    }
+
+    void open(const protocol_type& protocol, std::error_code& ec) {
+      service_.open(impl_, protocol.family(), protocol.type(), protocol.protocol(), ec);
+    }
+
+    void bind(const endpoint_type& endpoint, std::error_code& ec) {
+      service_.bind(impl_, endpoint.data(), endpoint.size(), ec);
+    }
+
+    bool is_open() const {
+      return service_.is_open(impl_);
+    }
+
+    void close(std::error_code& ec) {
+      service_.close(impl_, ec);
+    }
+
+    native_handle_type native_handle() const {
+      return service_.native_handle(impl_);
+    }
+
+    // Has the network stack timestamp datagrams as they arrive and leave.
+    // Receive handlers that take a third packet_timestamp argument then get
+    // them; sends are looked up with transmit_timestamp().
+    void enable_timestamps(std::error_code& ec) {
+      service_.enable_timestamps(impl_, ec);
+    }
+
+    // The handler is called as handler(ec, bytes_transferred), or as
+    // handler(ec, bytes_transferred, id) if it accepts a transmit_id, to
+    // pass to transmit_timestamp().
+    template <typename Handler>
+    void async_send_to(const const_buffer& buffer, const endpoint_type& destination,
+                       Handler&& handler) {
+      service_.async_send_to(impl_, buffer, destination.data(), destination.size(),
+                             std::forward<Handler>(handler));
+    }
+
+    // When the datagram sent as id left. The stack may stamp it after the
+    // send has completed; until then this fails with would_block.
+    packet_timestamp transmit_timestamp(const transmit_id& id, std::error_code& ec) {
+      return service_.transmit_timestamp(impl_, id, ec);
+    }
+
+    // The handler is called as handler(ec, bytes_transferred), or as
+    // handler(ec, bytes_transferred, timestamp) if it accepts one, with
+    // the time the datagram arrived, whose delay to the handler is also
+    // counted in the context's metrics. sender receives the datagram's
+    // source and must outlive the receive.
+    template <typename Handler>
+    void async_receive_from(const mutable_buffer& buffer, endpoint_type& sender,
+                            Handler&& handler) {
+      service_.async_receive_from(impl_, buffer, sender, std::forward<Handler>(handler));
+    }
+
+    // As above; emitting slot's signal aborts the receive.
+    template <typename Handler>
+    void async_receive_from(const mutable_buffer& buffer, endpoint_type& sender,
+                            Handler&& handler, base::cancellation_slot slot) {
+      service_.async_receive_from(impl_, buffer, sender, std::forward<Handler>(handler), slot);
+    }
+
+  private:
+    using service_type = base::socket_service_impl;
+
+    service_type& service_;
+    typename service_type::implementation_type impl_;
+  };
+}  // namespace easio
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef EASIO_STEADY_TIMER_HPP
+#define EASIO_STEADY_TIMER_HPP
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+#include "base/execution_context.hpp"
+#include "base/noncopyable.hpp"
+#include "base/timer_queue.hpp"
+#include "base/wait_sender.hpp"
+#include "io_context.hpp"
+
+namespace easio {
+
+  class steady_timer : private noncopyable {
+  public:
+    using clock_type = std::chrono::steady_clock;
+    using duration = clock_type::duration;
+    using time_point = clock_type::time_point;
+
+    explicit steady_timer(base::execution_context& ctx)
+      : impl_(base::use_service<base::io_context_impl>(ctx)), expiry_() {}
+
+    steady_timer(base::execution_context& ctx, const duration& expiry_time)
+      : impl_(base::use_service<base::io_context_impl>(ctx)),
+        expiry_(clock_type::now() + expiry_time) {}
+
+    ~steady_timer() {
+      cancel();
+    }
+
+    time_point expiry() const {
+      return expiry_;
+    }
+
+    // Setting the expiry cancels pending waits; returns how many.
+    std::size_t expires_at(const time_point& expiry_time) {
+      std::size_t n = cancel();
+      expiry_ = expiry_time;
+      return n;
+    }
+
+    std::size_t expires_after(const duration& expiry_time) {
+      return expires_at(clock_type::now() + expiry_time);
+    }
+
+    // Pending waits complete with an operation_aborted error.
+    std::size_t cancel() {
+      return impl_.cancel_timer(this);
+    }
+
+    auto async_wait() {
+      return base::wait_sender<base::io_context_impl>(impl_, this, expiry_);
+    }
+
+  private:
+    base::io_context_impl& impl_;
+    time_point expiry_;
+  };
+}  // namespace easio
+
+#endif
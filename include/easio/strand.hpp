@@ -0,0 +1,118 @@
+#ifndef EASIO_STRAND_HPP
+#define EASIO_STRAND_HPP
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "base/strand_impl.hpp"
+#include "base/thread_context.hpp"
+
+namespace easio {
+
+  // Serialises the function objects given to it: they run one at a time,
+  // in order, on whichever thread is running the inner executor, so the
+  // state of one connection needs no mutex. The state lives in a
+  // base::strand_impl the caller embeds, e.g. one per connection, and
+  // must outlive everything queued on it. strand itself is a cheap handle.
+  template <typename Executor>
+  class strand {
+  public:
+    using inner_executor_type = Executor;
+
+    strand(const Executor& ex, base::strand_impl& impl) noexcept
+      : ex_(ex), impl_(&impl) {}
+
+    const inner_executor_type& get_inner_executor() const noexcept {
+      return ex_;
+    }
+
+    // True if called from a function object running on this strand.
+    bool running_in_this_thread() const noexcept {
+      return impl_->running_in_this_thread();
+    }
+
+    // Queues f. Never runs it inside this call.
+    template <typename F>
+    void post(F&& f) const {
+      base::strand_node* n = base::strand_handler_node<std::decay_t<F>>::create(std::forward<F>(f));
+      if (impl_->enqueue(n))
+        ex_.post(invoker(ex_, impl_, n));
+    }
+
+    // Runs f inside this call if already on this strand and the dispatch
+    // depth allows it. Otherwise queues f; if that leaves the strand idle
+    // apart from f, the run is dispatched on the inner executor, so it may
+    // still happen inline.
+    template <typename F>
+    void dispatch(F&& f) const {
+      if (impl_->running_in_this_thread()) {
+        auto run_now = [&f] {
+          std::decay_t<F> tmp(std::forward<F>(f));
+          tmp();
+        };
+        if (base::thread_info::dispatch_inline(base::thread_context::top_of_thread_call_stack(), run_now))
+          return;
+      }
+
+      base::strand_node* n = base::strand_handler_node<std::decay_t<F>>::create(std::forward<F>(f));
+      if (impl_->enqueue(n))
+        ex_.dispatch(invoker(ex_, impl_, n));
+    }
+
+    friend bool operator==(const strand& a, const strand& b) noexcept {
+      return a.impl_ == b.impl_ && a.ex_ == b.ex_;
+    }
+
+    friend bool operator!=(const strand& a, const strand& b) noexcept {
+      return !(a == b);
+    }
+
+  private:
+    // Runs a batch of the strand's handlers on the inner executor and
+    // schedules the next batch if more remain. Destroying an invoker that
+    // never ran, e.g. at shutdown, destroys the queued handlers.
+    class invoker {
+    public:
+      invoker(const Executor& ex, base::strand_impl* impl, base::strand_node* head) noexcept
+        : ex_(ex), impl_(impl), head_(head) {}
+
+      invoker(invoker&& other) noexcept
+        : ex_(other.ex_), impl_(other.impl_), head_(std::exchange(other.head_, nullptr)) {}
+
+      ~invoker() {
+        if (head_)
+          impl_->abandon(head_);
+      }
+
+      void operator()() {
+        base::strand_node* head = std::exchange(head_, nullptr);
+        base::strand_node* rest;
+        try {
+          rest = impl_->run(head);
+        } catch (...) {
+          if (head)
+            ex_.post(invoker(ex_, impl_, head));
+          throw;
+        }
+        if (rest)
+          ex_.post(invoker(ex_, impl_, rest));
+      }
+
+    private:
+      Executor ex_;
+      base::strand_impl* impl_;
+      base::strand_node* head_;
+    };
+
+    Executor ex_;
+    base::strand_impl* impl_;
+  };
+
+  template <typename Executor>
+  strand<Executor> make_strand(const Executor& ex, base::strand_impl& impl) noexcept {
+    return strand<Executor>(ex, impl);
+  }
+}  // namespace easio
+
+#endif
@@ -3,11 +3,14 @@
 #pragma once
 
 #include "base/endpoint.hpp"
+#include "socket.hpp"
 
 namespace easio {
   class tcp {
 public:
     using endpoint = base::endpoint<tcp>;
+    using socket = basic_stream_socket<tcp>;
+    using acceptor = basic_socket_acceptor<tcp>;
 
     static tcp v4() noexcept {
       return tcp(AF_INET);
@@ -21,6 +24,14 @@ public:
       return family_;
     }
 
+    int type() const noexcept {
+      return SOCK_STREAM;
+    }
+
+    int protocol() const noexcept {
+      return IPPROTO_TCP;
+    }
+
 private:
     explicit tcp(int family) noexcept : family_(family) {}
     int family_;
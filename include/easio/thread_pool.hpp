@@ -0,0 +1,57 @@
+#ifndef EASIO_THREAD_POOL_HPP
+#define EASIO_THREAD_POOL_HPP
+#pragma once
+
+#include <cstddef>
+#include <thread>
+
+#include "base/execution_context.hpp"
+#include "base/thread_pool_impl.hpp"
+#include "base/thread_pool_scheduler.hpp"
+
+namespace easio {
+
+  // A fixed set of threads for CPU-heavy or blocking work, kept off the
+  // threads running an io_context. Hand the result back with transfer:
+  //
+  //   schedule(pool.get_executor())
+  //     | bulk(n, [&](std::size_t i) { ... })
+  //     | transfer(io.get_executor())
+  //
+  // bulk() on a sender completing on the pool spreads its calls over all
+  // of the pool's threads. Destroying the pool stops it and joins its
+  // threads; a schedule() not yet run completes with set_done.
+  class thread_pool : public base::execution_context {
+  public:
+    // Models execution::scheduler; schedule() completes on a pool thread.
+    using executor_type = base::thread_pool_scheduler;
+
+    explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency())
+      : impl_(base::make_service<base::thread_pool_impl>(*this, threads)) {}
+
+    executor_type get_executor() noexcept {
+      return executor_type(impl_);
+    }
+
+    std::size_t thread_count() const noexcept {
+      return impl_.thread_count();
+    }
+
+    // Threads leave after their current task; queued work is abandoned
+    // by join().
+    void stop() {
+      impl_.stop();
+    }
+
+    // Waits for the queue to drain and the threads to leave. Must not be
+    // called from a pool thread.
+    void join() {
+      impl_.join();
+    }
+
+  private:
+    base::thread_pool_impl& impl_;
+  };
+}  // namespace easio
+
+#endif
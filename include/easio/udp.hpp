@@ -3,11 +3,14 @@
 #pragma once
 
 #include "base/endpoint.hpp"
+#include "socket.hpp"
 
 namespace easio {
   class udp {
 public:
     typedef base::endpoint<udp> endpoint;
+    using socket = basic_datagram_socket<udp>;
+
     static udp v4() noexcept {
       return udp(AF_INET);
     }
@@ -16,6 +19,18 @@ public:
       return udp(AF_INET6);
     }
 
+    int family() const noexcept {
+      return family_;
+    }
+
+    int type() const noexcept {
+      return SOCK_DGRAM;
+    }
+
+    int protocol() const noexcept {
+      return IPPROTO_UDP;
+    }
+
 private:
     explicit udp(int family) noexcept : family_(family) {}
     int family_;
@@ -0,0 +1,198 @@
+#ifndef EASIO_WATCHDOG_HPP
+#define EASIO_WATCHDOG_HPP
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/loop_monitor.hpp"
+#include "base/noncopyable.hpp"
+#include "io_context.hpp"
+
+namespace easio {
+
+  // A handler that has kept one of a context's threads busy past the
+  // watchdog's threshold.
+  struct stall_report {
+    io_context* context;
+    // Which of the context's loop monitors saw the stall.
+    std::size_t loop;
+    unsigned long thread_id;
+    // The type name of the running op, e.g. "post" or "receive".
+    const char* op_type;
+    // A lower bound; the watchdog only notices between two samples.
+    std::chrono::milliseconds running_for;
+    // Program counters of the stalled thread, innermost first, when stack
+    // capture is on. Empty where the platform gives no way to walk them.
+    std::vector<void*> stack;
+  };
+
+  namespace base {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    // Suspends the thread just long enough to copy its call stack into a
+    // fixed buffer. Nothing here may allocate while it is suspended, since
+    // it could be holding the heap lock.
+    inline std::vector<void*> sample_thread_stack(unsigned long thread_id) {
+      const std::size_t max_frames = 64;
+      std::array<void*, max_frames> frames;
+      std::size_t n = 0;
+
+      HANDLE thread = ::OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT, FALSE, thread_id);
+      if (!thread)
+        return std::vector<void*>();
+
+      if (::SuspendThread(thread) != static_cast<DWORD>(-1)) {
+        CONTEXT c;
+        c.ContextFlags = CONTEXT_FULL;
+        if (::GetThreadContext(thread, &c)) {
+#if defined(_M_X64) || defined(_M_AMD64)
+          while (n < max_frames && c.Rip) {
+            frames[n++] = reinterpret_cast<void*>(c.Rip);
+            DWORD64 image_base = 0;
+            PRUNTIME_FUNCTION function = ::RtlLookupFunctionEntry(c.Rip, &image_base, nullptr);
+            if (!function) {
+              // A leaf function: the return address is on top of the stack.
+              c.Rip = *reinterpret_cast<DWORD64*>(c.Rsp);
+              c.Rsp += 8;
+            } else {
+              PVOID handler_data = nullptr;
+              DWORD64 establisher_frame = 0;
+              ::RtlVirtualUnwind(UNW_FLAG_NHANDLER, image_base, c.Rip, function, &c,
+                                 &handler_data, &establisher_frame, nullptr);
+            }
+          }
+#elif defined(_M_IX86)
+          frames[n++] = reinterpret_cast<void*>(c.Eip);
+#elif defined(_M_ARM64)
+          frames[n++] = reinterpret_cast<void*>(c.Pc);
+#endif
+        }
+        ::ResumeThread(thread);
+      }
+      ::CloseHandle(thread);
+
+      return std::vector<void*>(frames.begin(), frames.begin() + n);
+    }
+#else
+    inline std::vector<void*> sample_thread_stack(unsigned long) {
+      return std::vector<void*>();
+    }
+#endif
+  }  // namespace base
+
+  // Watches the threads running a set of contexts from a thread of its
+  // own. Each sample reads every loop's heartbeat; a loop whose heartbeat
+  // has not moved while a handler is running is reported once that has
+  // lasted threshold. Each stall is reported once, on the watchdog
+  // thread, and the handler must not throw.
+  class watchdog : private base::noncopyable {
+  public:
+    using clock = std::chrono::steady_clock;
+    using report_handler = std::function<void(const stall_report&)>;
+
+    watchdog(std::chrono::milliseconds threshold, report_handler handler,
+             bool capture_stack = false)
+      : threshold_(threshold), handler_(std::move(handler)),
+        capture_stack_(capture_stack), stopped_(false),
+        thread_([this] { run(); }) {}
+
+    ~watchdog() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+      }
+      cv_.notify_one();
+      thread_.join();
+    }
+
+    // Starts watching ctx, which must outlive the watchdog.
+    void watch(io_context& ctx) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      watched_.push_back(watched{&ctx, &base::use_service<base::io_context_impl>(ctx).loops(), {}});
+      watched_.back().state_.resize(watched_.back().loops_->size());
+    }
+
+  private:
+    struct loop_state {
+      std::uint64_t heartbeat_ = 0;
+      clock::time_point since_;
+      bool reported_ = false;
+    };
+
+    struct watched {
+      io_context* ctx_;
+      const base::loop_registry* loops_;
+      std::vector<loop_state> state_;
+    };
+
+    // Samples a few times per threshold, so a stall is seen at most a
+    // quarter threshold late.
+    clock::duration interval() const {
+      clock::duration d = threshold_ / 4;
+      return d < std::chrono::milliseconds(1) ? std::chrono::milliseconds(1) : d;
+    }
+
+    void run() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!cv_.wait_for(lock, interval(), [this] { return stopped_; })) {
+        std::vector<stall_report> reports;
+        clock::time_point now = clock::now();
+        for (watched& w : watched_)
+          sample(w, now, reports);
+
+        lock.unlock();
+        for (stall_report& r : reports) {
+          if (capture_stack_)
+            r.stack = base::sample_thread_stack(r.thread_id);
+          handler_(r);
+        }
+        lock.lock();
+      }
+    }
+
+    void sample(watched& w, clock::time_point now, std::vector<stall_report>& reports) {
+      for (std::size_t i = 0; i < w.loops_->size(); ++i) {
+        const base::loop_monitor& m = (*w.loops_)[i];
+        loop_state& s = w.state_[i];
+        if (!m.in_use()) {
+          s.reported_ = false;
+          continue;
+        }
+
+        std::uint64_t heartbeat = m.heartbeat();
+        const char* running = m.running();
+        if (!running || heartbeat != s.heartbeat_ || s.since_ == clock::time_point()) {
+          s.heartbeat_ = heartbeat;
+          s.since_ = now;
+          s.reported_ = false;
+          continue;
+        }
+
+        if (!s.reported_ && now - s.since_ >= threshold_) {
+          s.reported_ = true;
+          reports.push_back(stall_report{
+              w.ctx_, i, m.thread_id(), running,
+              std::chrono::duration_cast<std::chrono::milliseconds>(now - s.since_), {}});
+        }
+      }
+    }
+
+    std::chrono::milliseconds threshold_;
+    report_handler handler_;
+    bool capture_stack_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopped_;
+    std::vector<watched> watched_;
+    std::thread thread_;
+  };
+}  // namespace easio
+
+#endif
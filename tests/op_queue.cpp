@@ -0,0 +1,97 @@
+// op_queue: order, splicing and teardown of the intrusive op list that
+// batch posts go through.
+
+#include <cstddef>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+#include "base/op_queue.hpp"
+#include "test_common.hpp"
+
+using namespace easio::base;
+
+struct test_op : operation {
+  explicit test_op(int id)
+    : operation([](service_ptr, operation_ptr, const std::error_code&, std::size_t) {}),
+      id_(id) {}
+
+  int id_;
+};
+
+static std::vector<int> drain(op_queue& q) {
+  std::vector<int> ids;
+  while (!q.empty())
+    ids.push_back(static_cast<test_op*>(q.pop().get())->id_);
+  return ids;
+}
+
+static void ops_leave_in_order() {
+  op_queue q;
+  EASIO_CHECK(q.empty());
+  for (int i = 1; i <= 3; ++i)
+    q.push(std::make_shared<test_op>(i));
+  EASIO_CHECK(q.size() == 3);
+
+  std::vector<int> seen;
+  q.for_each([&](operation& op) { seen.push_back(static_cast<test_op&>(op).id_); });
+  EASIO_CHECK((seen == std::vector<int>{1, 2, 3}));
+  EASIO_CHECK((drain(q) == std::vector<int>{1, 2, 3}));
+  EASIO_CHECK(q.size() == 0);
+
+  // Emptied, the queue takes new ops from the front again.
+  q.push(std::make_shared<test_op>(4));
+  EASIO_CHECK((drain(q) == std::vector<int>{4}));
+}
+
+static void splicing_appends_and_empties_the_source() {
+  op_queue q, batch, none;
+  q.push(std::make_shared<test_op>(1));
+  batch.push(std::make_shared<test_op>(2));
+  batch.push(std::make_shared<test_op>(3));
+
+  q.push(batch);
+  EASIO_CHECK(batch.empty() && batch.size() == 0);
+  q.push(none);
+  EASIO_CHECK(q.size() == 3);
+
+  // The source works again after the splice.
+  batch.push(std::make_shared<test_op>(4));
+  q.push(batch);
+  EASIO_CHECK((drain(q) == std::vector<int>{1, 2, 3, 4}));
+
+  op_queue empty;
+  empty.push(q);
+  EASIO_CHECK(empty.empty());
+}
+
+static void popped_ops_are_released() {
+  op_queue q;
+  std::weak_ptr<test_op> first, second;
+  {
+    std::shared_ptr<test_op> a = std::make_shared<test_op>(1);
+    std::shared_ptr<test_op> b = std::make_shared<test_op>(2);
+    first = a;
+    second = b;
+    q.push(a);
+    q.push(b);
+  }
+  EASIO_CHECK(!first.expired() && !second.expired());
+
+  q.pop();
+  EASIO_CHECK(first.expired() && !second.expired());
+}
+
+static void a_long_queue_is_torn_down_iteratively() {
+  op_queue q;
+  for (int i = 0; i < 1000000; ++i)
+    q.push(std::make_shared<test_op>(i));
+}
+
+int main() {
+  ops_leave_in_order();
+  splicing_appends_and_empties_the_source();
+  popped_ops_are_released();
+  a_long_queue_is_torn_down_iteratively();
+  return 0;
+}
@@ -0,0 +1,164 @@
+// then, upon_error, let_value and when_all on senders that complete
+// inline, so every check runs on this thread.
+
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "test_common.hpp"
+
+using namespace easio_test;
+
+static void then_chains_values() {
+  outcome<int> out;
+  auto s = ex::just(20) | ex::then([](int x) { return x + 1; }) | ex::then([](int x) { return x * 2; });
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.value && out.completions == 1);
+  EASIO_CHECK(std::get<0>(*out.values) == 42);
+}
+
+static void then_forwards_a_throw_to_set_error() {
+  outcome<int> out;
+  auto s = ex::just(1) | ex::then([](int) -> int { throw std::runtime_error("then"); });
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.error && out.exception);
+}
+
+static void then_passes_errors_and_done_through() {
+  outcome<int> err;
+  bool called = false;
+  auto s1 = ex::just_error(std::make_error_code(std::errc::timed_out))
+      | ex::then([&] { called = true; return 0; });
+  auto op1 = ex::connect(std::move(s1), recorder<int>{&err});
+  ex::start(op1);
+  EASIO_CHECK(err.state == err.error && err.ec == std::errc::timed_out && !called);
+
+  outcome<int> done;
+  auto s2 = ex::just_done() | ex::then([&] { called = true; return 0; });
+  auto op2 = ex::connect(std::move(s2), recorder<int>{&done});
+  ex::start(op2);
+  EASIO_CHECK(done.state == done.done && !called);
+}
+
+static void upon_error_recovers() {
+  outcome<int> out;
+  auto s = ex::just_error(std::make_error_code(std::errc::timed_out))
+      | ex::upon_error([](std::error_code ec) { return ec == std::errc::timed_out ? 7 : 0; });
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.value && std::get<0>(*out.values) == 7);
+}
+
+static void upon_error_passes_values_through() {
+  outcome<int> out;
+  bool called = false;
+  auto s = ex::just(3) | ex::upon_error([&](std::exception_ptr) { called = true; return 0; });
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.value && std::get<0>(*out.values) == 3 && !called);
+}
+
+static void let_value_starts_the_returned_sender() {
+  outcome<int> out;
+  auto s = ex::just(2) | ex::let_value([](int x) { return ex::just(x * 10); });
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.value && std::get<0>(*out.values) == 20);
+}
+
+static void let_value_keeps_the_values_alive() {
+  // The returned sender refers to the string, which let_value holds until
+  // that sender completes.
+  outcome<std::size_t> out;
+  auto s = ex::just(std::string("hello"))
+      | ex::let_value([](std::string& str) { return ex::just() | ex::then([&str] { return str.size(); }); });
+  auto op = ex::connect(std::move(s), recorder<std::size_t>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.value && std::get<0>(*out.values) == 5);
+}
+
+static void let_value_forwards_a_throw_to_set_error() {
+  outcome<int> out;
+  auto s = ex::just(1) | ex::let_value([](int) -> decltype(ex::just(0)) { throw std::runtime_error("let"); });
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.error && out.exception);
+}
+
+static void when_all_joins_the_values() {
+  outcome<int, std::string, double> out;
+  auto s = ex::when_all(ex::just(1), ex::just(std::string("a")), ex::just(2.5));
+  auto op = ex::connect(std::move(s), recorder<int, std::string, double>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.value && out.completions == 1);
+  EASIO_CHECK(std::get<0>(*out.values) == 1);
+  EASIO_CHECK(std::get<1>(*out.values) == "a");
+  EASIO_CHECK(std::get<2>(*out.values) == 2.5);
+}
+
+static void when_all_reports_an_error() {
+  outcome<int, int> out;
+  auto s = ex::when_all(ex::just(1), ex::just(2) | ex::then([](int) -> int { throw 1; }));
+  auto op = ex::connect(std::move(s), recorder<int, int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.error && out.exception && out.completions == 1);
+}
+
+static void when_all_stops_the_others_on_error() {
+  outcome<int, int> out;
+  auto s = ex::when_all(stoppable_sender(), ex::just(2) | ex::then([](int) -> int { throw 1; }));
+  auto op = ex::connect(std::move(s), recorder<int, int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.error && out.exception && out.completions == 1);
+}
+
+// Declares an int but completes with done, as a stopped child would.
+struct done_sender {
+  template <template <typename...> typename Tuple, template <typename...> typename Variant>
+  using value_types = Variant<Tuple<int>>;
+
+  template <template <typename...> typename Variant>
+  using error_types = Variant<>;
+
+  static constexpr bool sends_done = true;
+
+  template <typename R>
+  struct operation {
+    R r_;
+
+    friend void tag_invoke(ex::start_t, operation& self) noexcept {
+      ex::set_done(std::move(self.r_));
+    }
+  };
+
+  template <typename R>
+  friend operation<std::remove_cvref_t<R>> tag_invoke(ex::connect_t, done_sender, R&& r) {
+    return {std::forward<R>(r)};
+  }
+};
+
+static void when_all_reports_done() {
+  outcome<int, int> out;
+  auto s = ex::when_all(ex::just(1), done_sender());
+  auto op = ex::connect(std::move(s), recorder<int, int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.done && out.completions == 1);
+}
+
+int main() {
+  then_chains_values();
+  then_forwards_a_throw_to_set_error();
+  then_passes_errors_and_done_through();
+  upon_error_recovers();
+  upon_error_passes_values_through();
+  let_value_starts_the_returned_sender();
+  let_value_keeps_the_values_alive();
+  let_value_forwards_a_throw_to_set_error();
+  when_all_joins_the_values();
+  when_all_reports_an_error();
+  when_all_stops_the_others_on_error();
+  when_all_reports_done();
+  return 0;
+}
@@ -0,0 +1,127 @@
+#ifndef EASIO_TESTS_TEST_COMMON_HPP
+#define EASIO_TESTS_TEST_COMMON_HPP
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "execution.hpp"
+
+// Checks cond in every build type; a failure prints where and exits.
+#define EASIO_CHECK(cond) \
+  ((cond) ? (void)0 : ::easio_test::fail(#cond, __FILE__, __LINE__))
+
+namespace easio_test {
+  namespace ex = easio::base::execution;
+
+  [[noreturn]] inline void fail(const char* expr, const char* file, int line) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+    std::abort();
+  }
+
+  // How a sender completed, as seen by a recorder. Values of another
+  // shape than Vs... only set the state.
+  template <typename... Vs>
+  struct outcome {
+    enum state_type { pending, value, error, done };
+
+    state_type state = pending;
+    int completions = 0;
+    std::optional<std::tuple<Vs...>> values;
+    std::exception_ptr exception;
+    std::error_code ec;
+
+    // Blocks until the receiver has been completed, for senders that
+    // complete on another thread.
+    void wait() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return state != pending; });
+    }
+
+    void finish(state_type s) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      state = s;
+      ++completions;
+      cv_.notify_all();
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+  };
+
+  // A receiver that writes whatever it is completed with into an outcome.
+  template <typename... Vs>
+  struct recorder {
+    outcome<Vs...>* out_;
+
+    template <typename... As>
+    friend void tag_invoke(ex::set_value_t, recorder&& r, As&&... as) noexcept {
+      if constexpr (std::is_constructible_v<std::tuple<Vs...>, As&&...>)
+        r.out_->values.emplace(std::forward<As>(as)...);
+      r.out_->finish(outcome<Vs...>::value);
+    }
+
+    template <typename E>
+    friend void tag_invoke(ex::set_error_t, recorder&& r, E&& e) noexcept {
+      if constexpr (std::is_same_v<std::decay_t<E>, std::exception_ptr>)
+        r.out_->exception = std::forward<E>(e);
+      else if constexpr (std::is_same_v<std::decay_t<E>, std::error_code>)
+        r.out_->ec = e;
+      r.out_->finish(outcome<Vs...>::error);
+    }
+
+    friend void tag_invoke(ex::set_done_t, recorder&& r) noexcept {
+      r.out_->finish(outcome<Vs...>::done);
+    }
+  };
+
+  // Never completes on its own: once its receiver's stop token is
+  // triggered it completes with done, like an I/O op losing a race. It
+  // declares an int, to sit next to just(int).
+  struct stoppable_sender {
+    template <template <typename...> typename Tuple, template <typename...> typename Variant>
+    using value_types = Variant<Tuple<int>>;
+
+    template <template <typename...> typename Variant>
+    using error_types = Variant<>;
+
+    static constexpr bool sends_done = true;
+
+    template <typename R>
+    struct operation {
+      struct on_stop {
+        operation* op_;
+
+        void operator()() noexcept {
+          ex::set_done(std::move(op_->r_));
+        }
+      };
+
+      explicit operation(R r) : r_(std::move(r)) {}
+      operation(operation&&) = delete;
+
+      friend void tag_invoke(ex::start_t, operation& self) noexcept {
+        self.on_stop_.emplace(ex::get_stop_token(self.r_), on_stop{&self});
+      }
+
+      R r_;
+      std::optional<ex::stop_callback_for_t<ex::stop_token_of_t<R>, on_stop>> on_stop_;
+    };
+
+    template <typename R>
+    friend operation<std::remove_cvref_t<R>> tag_invoke(ex::connect_t, stoppable_sender, R&& r) {
+      return operation<std::remove_cvref_t<R>>(std::forward<R>(r));
+    }
+  };
+}  // namespace easio_test
+
+#endif
@@ -0,0 +1,126 @@
+// thread_pool's scheduler and bulk(), both the pool's own bulk and the
+// generic one for senders that complete elsewhere.
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "test_common.hpp"
+#include "thread_pool.hpp"
+
+using namespace easio_test;
+
+static void schedule_runs_on_a_pool_thread() {
+  easio::thread_pool pool(2);
+  outcome<std::thread::id> out;
+  auto s = ex::schedule(pool.get_executor()) | ex::then([] { return std::this_thread::get_id(); });
+  auto op = ex::connect(std::move(s), recorder<std::thread::id>{&out});
+  ex::start(op);
+  out.wait();
+  EASIO_CHECK(out.state == out.value && out.completions == 1);
+  EASIO_CHECK(std::get<0>(*out.values) != std::this_thread::get_id());
+}
+
+static void schedule_after_stop_is_done() {
+  easio::thread_pool pool(1);
+  pool.stop();
+  outcome<> out;
+  auto op = ex::connect(ex::schedule(pool.get_executor()), recorder<>{&out});
+  ex::start(op);
+  out.wait();
+  EASIO_CHECK(out.state == out.done && out.completions == 1);
+}
+
+static void bulk_calls_every_index_once() {
+  const int n = 10000;
+  easio::thread_pool pool(4);
+  std::vector<std::atomic<int>> calls(n);
+  outcome<int> out;
+  auto s = ex::schedule(pool.get_executor())
+      | ex::then([] { return 3; })
+      | ex::bulk(n, [&](int i, int v) { calls[static_cast<std::size_t>(i)] += v; });
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  out.wait();
+  EASIO_CHECK(out.state == out.value && out.completions == 1);
+  EASIO_CHECK(std::get<0>(*out.values) == 3);
+  for (std::atomic<int>& c : calls)
+    EASIO_CHECK(c == 3);
+}
+
+static void bulk_of_nothing_sends_the_values_on() {
+  easio::thread_pool pool(2);
+  outcome<int> out;
+  bool called = false;
+  auto s = ex::schedule(pool.get_executor())
+      | ex::then([] { return 5; })
+      | ex::bulk(0, [&](int, int) { called = true; });
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  out.wait();
+  EASIO_CHECK(out.state == out.value && std::get<0>(*out.values) == 5 && !called);
+}
+
+static void bulk_forwards_a_throw_to_set_error() {
+  easio::thread_pool pool(4);
+  std::atomic<int> calls{0};
+  outcome<> out;
+  auto s = ex::schedule(pool.get_executor()) | ex::bulk(1000, [&](int i) {
+    ++calls;
+    if (i == 500)
+      throw std::runtime_error("bulk");
+  });
+  auto op = ex::connect(std::move(s), recorder<>{&out});
+  ex::start(op);
+  out.wait();
+  EASIO_CHECK(out.state == out.error && out.exception && out.completions == 1);
+}
+
+static void generic_bulk_runs_inline() {
+  std::vector<int> seen;
+  outcome<int> out;
+  auto s = ex::just(2) | ex::bulk(4, [&](int i, int v) { seen.push_back(i * v); });
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.value && std::get<0>(*out.values) == 2);
+  EASIO_CHECK((seen == std::vector<int>{0, 2, 4, 6}));
+}
+
+static void generic_bulk_forwards_a_throw_to_set_error() {
+  outcome<int> out;
+  auto s = ex::just(2) | ex::bulk(4, [](int i, int) {
+    if (i == 2)
+      throw std::runtime_error("bulk");
+  });
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.error && out.exception);
+}
+
+// A receiver whose set_value throws, which bulk has to turn into set_error.
+struct throwing_receiver : recorder<int> {
+  friend void tag_invoke(ex::set_value_t, throwing_receiver&&, int) {
+    throw std::runtime_error("set_value");
+  }
+};
+
+static void generic_bulk_forwards_a_throwing_set_value() {
+  outcome<int> out;
+  auto op = ex::connect(ex::just(2) | ex::bulk(4, [](int, int) {}), throwing_receiver{{&out}});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.error && out.exception && out.completions == 1);
+}
+
+int main() {
+  schedule_runs_on_a_pool_thread();
+  schedule_after_stop_is_done();
+  bulk_calls_every_index_once();
+  bulk_of_nothing_sends_the_values_on();
+  bulk_forwards_a_throw_to_set_error();
+  generic_bulk_runs_inline();
+  generic_bulk_forwards_a_throw_to_set_error();
+  generic_bulk_forwards_a_throwing_set_value();
+  return 0;
+}
@@ -0,0 +1,130 @@
+// timer_queue: expiry order, cancelling by timer and by wait, and the
+// earliest expiry the context sleeps until.
+
+#include <chrono>
+#include <memory>
+#include <queue>
+#include <system_error>
+#include <vector>
+
+#include "base/timer_queue.hpp"
+#include "test_common.hpp"
+
+using namespace easio::base;
+using std::chrono::hours;
+using std::chrono::seconds;
+
+struct test_wait : wait_op {
+  explicit test_wait(int id)
+    : wait_op([](service_ptr, operation_ptr, const std::error_code&, std::size_t) {}),
+      id_(id) {}
+
+  int id_;
+};
+
+static std::vector<int> drain(std::queue<operation_ptr>& ops) {
+  std::vector<int> ids;
+  while (!ops.empty()) {
+    ids.push_back(static_cast<test_wait*>(ops.front().get())->id_);
+    ops.pop();
+  }
+  return ids;
+}
+
+static void ready_waits_come_out_in_expiry_order() {
+  timer_queue q;
+  int timer;
+  timer_queue::time_point now = timer_queue::clock_type::now();
+
+  EASIO_CHECK(q.empty() && q.earliest() == timer_queue::time_point::max());
+  EASIO_CHECK(q.enqueue_timer(now - seconds(1), &timer, std::make_shared<test_wait>(2)));
+  EASIO_CHECK(q.enqueue_timer(now - seconds(3), &timer, std::make_shared<test_wait>(1)));
+  EASIO_CHECK(!q.enqueue_timer(now + hours(1), &timer, std::make_shared<test_wait>(3)));
+  EASIO_CHECK(q.earliest() == now - seconds(3));
+  EASIO_CHECK(q.wait_duration_msec(1000) == 0);
+
+  std::queue<operation_ptr> ready;
+  q.get_ready_timers(ready);
+  EASIO_CHECK((drain(ready) == std::vector<int>{1, 2}));
+  EASIO_CHECK(!q.empty() && q.earliest() == now + hours(1));
+  EASIO_CHECK(q.wait_duration_msec(1000) == 1000);
+}
+
+static void cancel_timer_takes_only_that_timers_waits() {
+  timer_queue q;
+  int a, b;
+  timer_queue::time_point now = timer_queue::clock_type::now();
+  for (int i = 0; i < 10; ++i)
+    q.enqueue_timer(now + hours(1 + i), i % 2 ? &a : &b, std::make_shared<test_wait>(i));
+
+  std::error_code aborted = std::make_error_code(std::errc::operation_canceled);
+  std::queue<operation_ptr> ops;
+  EASIO_CHECK(q.cancel_timer(&b, aborted, ops) == 5);
+  std::vector<int> ids = drain(ops);
+  EASIO_CHECK(ids.size() == 5);
+  for (int id : ids)
+    EASIO_CHECK(id % 2 == 0);
+  EASIO_CHECK(q.cancel_timer(&b, aborted, ops) == 0);
+  EASIO_CHECK(q.earliest() == now + hours(2));
+
+  EASIO_CHECK(q.cancel_timer(&a, aborted, ops) == 5 && q.empty());
+}
+
+static void cancel_timer_op_takes_a_single_wait() {
+  timer_queue q;
+  int a;
+  timer_queue::time_point now = timer_queue::clock_type::now();
+  std::vector<std::shared_ptr<test_wait>> waits;
+  for (int i = 0; i < 3; ++i) {
+    waits.push_back(std::make_shared<test_wait>(i));
+    q.enqueue_timer(now + hours(1 + i), &a, waits.back());
+  }
+
+  std::error_code aborted = std::make_error_code(std::errc::operation_canceled);
+  std::queue<operation_ptr> ops;
+  EASIO_CHECK(q.cancel_timer_op(*waits[0], aborted, ops));
+  EASIO_CHECK(!q.cancel_timer_op(*waits[0], aborted, ops));
+  EASIO_CHECK((drain(ops) == std::vector<int>{0}));
+  EASIO_CHECK(waits[0]->ec_ == aborted);
+  EASIO_CHECK(q.earliest() == now + hours(2));
+
+  // The timer's remaining waits are still linked together.
+  EASIO_CHECK(q.cancel_timer(&a, aborted, ops) == 2);
+  EASIO_CHECK(q.empty());
+}
+
+static void an_expired_wait_cannot_be_cancelled() {
+  timer_queue q;
+  int a;
+  std::shared_ptr<test_wait> w = std::make_shared<test_wait>(1);
+  q.enqueue_timer(timer_queue::clock_type::now() - seconds(1), &a, w);
+
+  std::queue<operation_ptr> ops;
+  q.get_ready_timers(ops);
+  EASIO_CHECK((drain(ops) == std::vector<int>{1}));
+  EASIO_CHECK(!q.cancel_timer_op(*w, std::make_error_code(std::errc::operation_canceled), ops));
+  EASIO_CHECK(q.cancel_timer(&a, std::error_code(), ops) == 0 && ops.empty());
+}
+
+static void get_all_timers_empties_the_queue() {
+  timer_queue q;
+  int a, b;
+  timer_queue::time_point now = timer_queue::clock_type::now();
+  q.enqueue_timer(now + hours(2), &a, std::make_shared<test_wait>(2));
+  q.enqueue_timer(now + hours(1), &b, std::make_shared<test_wait>(1));
+
+  std::queue<operation_ptr> ops;
+  q.get_all_timers(ops);
+  EASIO_CHECK((drain(ops) == std::vector<int>{1, 2}));
+  EASIO_CHECK(q.empty() && q.earliest() == timer_queue::time_point::max());
+  EASIO_CHECK(q.cancel_timer(&a, std::error_code(), ops) == 0);
+}
+
+int main() {
+  ready_waits_come_out_in_expiry_order();
+  cancel_timer_takes_only_that_timers_waits();
+  cancel_timer_op_takes_a_single_wait();
+  an_expired_wait_cannot_be_cancelled();
+  get_all_timers_empties_the_queue();
+  return 0;
+}
@@ -0,0 +1,72 @@
+// when_any: the first child to complete decides the result, and the rest
+// are stopped before the receiver is completed.
+
+#include <stdexcept>
+#include <system_error>
+
+#include "test_common.hpp"
+
+using namespace easio_test;
+
+static void first_value_wins_and_stops_the_rest() {
+  outcome<int> out;
+  auto s = ex::when_any(stoppable_sender(), ex::just(7), stoppable_sender());
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.value && out.completions == 1);
+  EASIO_CHECK(std::get<0>(*out.values) == 7);
+}
+
+static void only_the_first_completion_counts() {
+  outcome<int> out;
+  auto s = ex::when_any(ex::just(1), ex::just(2));
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.value && out.completions == 1);
+  EASIO_CHECK(std::get<0>(*out.values) == 1);
+}
+
+static void first_error_wins() {
+  outcome<int> out;
+  auto s = ex::when_any(stoppable_sender(), ex::just_error(std::make_error_code(std::errc::timed_out)));
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.error && out.ec == std::errc::timed_out && out.completions == 1);
+}
+
+static void a_throw_is_an_error() {
+  outcome<int> out;
+  auto s = ex::when_any(stoppable_sender(), ex::just(1) | ex::then([](int) -> int { throw std::runtime_error("any"); }));
+  auto op = ex::connect(std::move(s), recorder<int>{&out});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.error && out.exception && out.completions == 1);
+}
+
+// A receiver whose stop token can be triggered from the test.
+struct stoppable_recorder : recorder<int> {
+  ex::in_place_stop_source* source_;
+
+  friend ex::in_place_stop_token tag_invoke(ex::get_stop_token_t, const stoppable_recorder& self) noexcept {
+    return self.source_->get_token();
+  }
+};
+
+static void a_stop_request_reaches_every_child() {
+  outcome<int> out;
+  ex::in_place_stop_source source;
+  auto s = ex::when_any(stoppable_sender(), stoppable_sender());
+  auto op = ex::connect(std::move(s), stoppable_recorder{{&out}, &source});
+  ex::start(op);
+  EASIO_CHECK(out.state == out.pending);
+  source.request_stop();
+  EASIO_CHECK(out.state == out.done && out.completions == 1);
+}
+
+int main() {
+  first_value_wins_and_stops_the_rest();
+  only_the_first_completion_counts();
+  first_error_wins();
+  a_throw_is_an_error();
+  a_stop_request_reaches_every_child();
+  return 0;
+}
@@ -0,0 +1,180 @@
+// write_queue: batches, completion order, short sends, close and cancel.
+// No socket is involved; the tests play the part of the gather send.
+
+#include <cstddef>
+#include <memory>
+#include <queue>
+#include <system_error>
+#include <vector>
+
+#include "base/write_queue.hpp"
+#include "test_common.hpp"
+
+using easio::const_buffer;
+using namespace easio::base;
+
+struct test_write : write_op {
+  test_write(const void* data, std::size_t size, int id)
+    : write_op([](service_ptr, operation_ptr, const std::error_code&, std::size_t) {},
+               const_buffer(data, size)),
+      id_(id) {}
+
+  int id_;
+};
+
+static char data[1024];
+
+static std::shared_ptr<test_write> make_write(std::size_t size, int id) {
+  return std::make_shared<test_write>(data, size, id);
+}
+
+// The ids of the completed writes, in completion order.
+static std::vector<int> drain(std::queue<operation_ptr>& completed) {
+  std::vector<int> ids;
+  while (!completed.empty()) {
+    ids.push_back(static_cast<test_write*>(completed.front().get())->id_);
+    completed.pop();
+  }
+  return ids;
+}
+
+static void writes_complete_in_order() {
+  write_queue q;
+  socket_ops::buf bufs[write_queue::max_batch_buffers];
+  std::queue<operation_ptr> completed;
+
+  EASIO_CHECK(q.enqueue(make_write(10, 1)));
+  EASIO_CHECK(q.prepare(bufs) == 1);
+  EASIO_CHECK(!q.enqueue(make_write(20, 2)));
+  EASIO_CHECK(!q.enqueue(make_write(30, 3)));
+
+  EASIO_CHECK(q.complete(std::error_code(), 10, completed));
+  EASIO_CHECK(q.prepare(bufs) == 2);
+  EASIO_CHECK(!q.complete(std::error_code(), 50, completed));
+  EASIO_CHECK((drain(completed) == std::vector<int>{1, 2, 3}));
+
+  // The queue is idle again, so the next write starts a batch.
+  EASIO_CHECK(q.enqueue(make_write(1, 4)));
+}
+
+static void a_short_send_resumes_where_it_stopped() {
+  write_queue q;
+  socket_ops::buf bufs[write_queue::max_batch_buffers];
+  std::queue<operation_ptr> completed;
+  std::shared_ptr<test_write> a = make_write(10, 1);
+  std::shared_ptr<test_write> b = make_write(20, 2);
+  std::shared_ptr<test_write> c = make_write(5, 3);
+
+  q.enqueue(a);
+  q.enqueue(b);
+  q.enqueue(c);
+  EASIO_CHECK(q.prepare(bufs) == 3);
+
+  // All of a and half of b went out.
+  EASIO_CHECK(q.complete(std::error_code(), 20, completed));
+  EASIO_CHECK((drain(completed) == std::vector<int>{1}));
+  EASIO_CHECK(b->bytes_transferred_ == 10 && b->buffer_.size() == 10);
+  EASIO_CHECK(b->buffer_.data() == data + 10);
+
+  // The next batch starts with the rest of b.
+  EASIO_CHECK(q.prepare(bufs) == 2);
+  EASIO_CHECK(q.complete(std::error_code(), 12, completed));
+  EASIO_CHECK((drain(completed) == std::vector<int>{2}));
+  EASIO_CHECK(c->bytes_transferred_ == 2 && c->buffer_.size() == 3);
+
+  EASIO_CHECK(q.prepare(bufs) == 1);
+  EASIO_CHECK(!q.complete(std::error_code(), 3, completed));
+  EASIO_CHECK((drain(completed) == std::vector<int>{3}));
+  EASIO_CHECK(a->bytes_transferred_ == 10 && b->bytes_transferred_ == 20 && c->bytes_transferred_ == 5);
+}
+
+static void a_batch_is_capped() {
+  write_queue q;
+  socket_ops::buf bufs[write_queue::max_batch_buffers];
+  std::queue<operation_ptr> completed;
+  const int n = write_queue::max_batch_buffers + 6;
+  for (int i = 0; i < n; ++i)
+    q.enqueue(make_write(1, i));
+
+  EASIO_CHECK(q.prepare(bufs) == static_cast<std::size_t>(write_queue::max_batch_buffers));
+  EASIO_CHECK(q.complete(std::error_code(), write_queue::max_batch_buffers, completed));
+  EASIO_CHECK(q.prepare(bufs) == 6);
+  EASIO_CHECK(!q.complete(std::error_code(), 6, completed));
+
+  std::vector<int> ids = drain(completed);
+  EASIO_CHECK(ids.size() == static_cast<std::size_t>(n));
+  for (int i = 0; i < n; ++i)
+    EASIO_CHECK(ids[static_cast<std::size_t>(i)] == i);
+}
+
+static void an_error_fails_the_whole_batch() {
+  write_queue q;
+  socket_ops::buf bufs[write_queue::max_batch_buffers];
+  std::queue<operation_ptr> completed;
+  std::shared_ptr<test_write> a = make_write(10, 1);
+  std::shared_ptr<test_write> b = make_write(10, 2);
+  q.enqueue(a);
+  q.enqueue(b);
+  EASIO_CHECK(q.prepare(bufs) == 2);
+
+  std::error_code reset = std::make_error_code(std::errc::connection_reset);
+  EASIO_CHECK(!q.complete(reset, 0, completed));
+  EASIO_CHECK((drain(completed) == std::vector<int>{1, 2}));
+  EASIO_CHECK(a->ec_ == reset && b->ec_ == reset);
+}
+
+static void close_fails_the_waiting_writes_only() {
+  write_queue q;
+  socket_ops::buf bufs[write_queue::max_batch_buffers];
+  std::queue<operation_ptr> completed;
+  std::shared_ptr<test_write> a = make_write(10, 1);
+  std::shared_ptr<test_write> b = make_write(10, 2);
+  q.enqueue(a);
+  EASIO_CHECK(q.prepare(bufs) == 1);
+  q.enqueue(b);
+
+  std::error_code aborted = std::make_error_code(std::errc::operation_canceled);
+  q.close(aborted, completed);
+  EASIO_CHECK((drain(completed) == std::vector<int>{2}));
+  EASIO_CHECK(b->ec_ == aborted && !a->ec_);
+
+  // The batch in flight still completes, and no other is issued.
+  EASIO_CHECK(!q.complete(std::error_code(), 10, completed));
+  EASIO_CHECK((drain(completed) == std::vector<int>{1}));
+  EASIO_CHECK(q.prepare(bufs) == 0);
+}
+
+static void cancel_pulls_a_waiting_write_only() {
+  write_queue q;
+  socket_ops::buf bufs[write_queue::max_batch_buffers];
+  std::queue<operation_ptr> completed;
+  std::shared_ptr<test_write> a = make_write(10, 1);
+  std::shared_ptr<test_write> b = make_write(10, 2);
+  std::shared_ptr<test_write> c = make_write(10, 3);
+  q.enqueue(a);
+  EASIO_CHECK(q.prepare(bufs) == 1);
+  q.enqueue(b);
+  q.enqueue(c);
+
+  std::error_code aborted = std::make_error_code(std::errc::operation_canceled);
+  EASIO_CHECK(!q.cancel(a.get(), aborted, completed));
+  EASIO_CHECK(q.cancel(b.get(), aborted, completed));
+  EASIO_CHECK(!q.cancel(b.get(), aborted, completed));
+  EASIO_CHECK((drain(completed) == std::vector<int>{2}));
+  EASIO_CHECK(b->ec_ == aborted);
+
+  EASIO_CHECK(q.complete(std::error_code(), 10, completed));
+  EASIO_CHECK(q.prepare(bufs) == 1);
+  EASIO_CHECK(!q.complete(std::error_code(), 10, completed));
+  EASIO_CHECK((drain(completed) == std::vector<int>{1, 3}));
+}
+
+int main() {
+  writes_complete_in_order();
+  a_short_send_resumes_where_it_stopped();
+  a_batch_is_capped();
+  an_error_fails_the_whole_batch();
+  close_fails_the_waiting_writes_only();
+  cancel_pulls_a_waiting_write_only();
+  return 0;
+}